@@ -0,0 +1,392 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <iterator>
+
+#include "BytecodeCache.h"
+#include "ClassGenerationContext.h"
+
+#include "../vm/Universe.h"
+
+#include "../vmobjects/VMArray.h"
+#include "../vmobjects/VMClass.h"
+#include "../vmobjects/VMDouble.h"
+#include "../vmobjects/VMInteger.h"
+#include "../vmobjects/VMMethod.h"
+#include "../vmobjects/VMPrimitive.h"
+#include "../vmobjects/VMString.h"
+#include "../vmobjects/VMSymbol.h"
+
+#define SOMC_MAGIC   "SOMC"
+
+// to be incremented whenever the format changes
+#define SOMC_VERSION 3
+
+// identifies the compiler a cache was written by. The Makefile passes a
+// checksum of the compiler sources and bytecodes.h, other builds fall back
+// to the build time.
+#ifndef SOMC_BUILD_ID
+#define SOMC_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+enum CacheTag {
+    TAG_METHOD    = 'm',
+    TAG_PRIMITIVE = 'p',
+    TAG_NIL       = 'n',
+    TAG_SYMBOL    = 'y',
+    TAG_STRING    = 's',
+    TAG_INTEGER   = 'i',
+    TAG_DOUBLE    = 'd'
+};
+
+// FNV-1a
+static uint64_t hashSource(const StdString& source) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < source.size(); ++i) {
+        hash ^= (uint8_t) source[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//
+// writing
+//
+
+class BytecodeCache::Writer {
+public:
+    template<class T>
+    void Put(T value) {
+        buffer.append((const char*) &value, sizeof(T));
+    }
+
+    void PutString(const StdString& str) {
+        Put<uint32_t>(str.size());
+        buffer.append(str);
+    }
+
+    void PutSymbols(ExtendedList<VMSymbol*>& symbols) {
+        Put<uint32_t>(symbols.Size());
+        for (size_t i = 0; i < symbols.Size(); ++i)
+            PutString(symbols.Get(i)->GetStdString());
+    }
+
+    bool PutInvokables(ExtendedList<VMInvokable*>& invokables) {
+        Put<uint32_t>(invokables.Size());
+        for (size_t i = 0; i < invokables.Size(); ++i) {
+            VMInvokable* invokable = invokables.Get(i);
+            if (invokable->IsPrimitive()) {
+                Put<uint8_t>(TAG_PRIMITIVE);
+                PutString(invokable->GetSignature()->GetStdString());
+            } else if (!PutMethod(static_cast<VMMethod*>(invokable)))
+                return false;
+        }
+        return true;
+    }
+
+    const StdString& GetBuffer() const {
+        return buffer;
+    }
+
+private:
+    bool PutMethod(VMMethod* method);
+    bool PutLiteral(vm_oop_t literal);
+
+    StdString buffer;
+};
+
+bool BytecodeCache::Writer::PutMethod(VMMethod* method) {
+    Put<uint8_t>(TAG_METHOD);
+    PutString(method->GetSignature()->GetStdString());
+    Put<uint32_t>(method->GetNumberOfLocals());
+    Put<uint32_t>(method->GetMaximumNumberOfStackElements());
+    Put<uint32_t>(method->GetNumberOfInlineCaches());
+    Put<uint8_t>(method->GetTrivialKind());
+    Put<uint8_t>(method->GetTrivialIndex());
+
+    long numberOfBytecodes = method->GetNumberOfBytecodes();
+    Put<uint32_t>(numberOfBytecodes);
+    buffer.append((const char*) method->GetBytecodes(), numberOfBytecodes);
+
+    long numberOfLiterals = method->GetNumberOfIndexableFields();
+    Put<uint32_t>(numberOfLiterals);
+    for (long i = 0; i < numberOfLiterals; ++i) {
+        if (!PutLiteral(method->GetIndexableField(i)))
+            return false;
+    }
+    return true;
+}
+
+// the parser only produces the literals handled here
+bool BytecodeCache::Writer::PutLiteral(vm_oop_t literal) {
+    if (literal == load_ptr(nilObject)) {
+        Put<uint8_t>(TAG_NIL);
+        return true;
+    }
+    if (IS_TAGGED(literal) || dynamic_cast<VMInteger*>(AS_OBJ(literal))) {
+        Put<uint8_t>(TAG_INTEGER);
+        Put<int64_t>(INT_VAL(literal));
+        return true;
+    }
+
+    AbstractVMObject* obj = AS_OBJ(literal);
+    if (VMSymbol* symbol = dynamic_cast<VMSymbol*>(obj)) {
+        Put<uint8_t>(TAG_SYMBOL);
+        PutString(symbol->GetStdString());
+    } else if (VMString* str = dynamic_cast<VMString*>(obj)) {
+        Put<uint8_t>(TAG_STRING);
+        PutString(str->GetStdString());
+    } else if (dynamic_cast<VMDouble*>(obj)) {
+        Put<uint8_t>(TAG_DOUBLE);
+        Put<double>(DOUBLE_VAL(literal));
+    } else if (VMMethod* method = dynamic_cast<VMMethod*>(obj)) {
+        return PutMethod(method);
+    } else
+        return false;
+    return true;
+}
+
+void BytecodeCache::Write(const StdString& cacheFile, const StdString& source,
+        ClassGenerationContext* cgenc) {
+    Writer writer;
+    writer.Put<uint32_t>(SOMC_VERSION);
+    writer.PutString(SOMC_BUILD_ID);
+    writer.Put<uint64_t>(source.size());
+    writer.Put<uint64_t>(hashSource(source));
+
+    writer.PutString(cgenc->GetName()->GetStdString());
+    writer.PutString(cgenc->GetSuperName()->GetStdString());
+    writer.PutSymbols(cgenc->GetInstanceFields());
+    writer.PutSymbols(cgenc->GetClassFields());
+    if (!writer.PutInvokables(cgenc->GetInstanceMethods())
+            || !writer.PutInvokables(cgenc->GetClassMethods()))
+        return;
+
+    // not being able to write the cache is not an error, written to a
+    // temporary file first so that no other VM sees a partial one
+    StdString tempFile = cacheFile + ".tmp";
+    FILE* file = fopen(tempFile.c_str(), "wb");
+    if (file == nullptr)
+        return;
+
+    const StdString& buffer = writer.GetBuffer();
+    bool written = fwrite(SOMC_MAGIC, 1, strlen(SOMC_MAGIC), file) == strlen(SOMC_MAGIC)
+                && fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    if (fclose(file) != 0 || !written || rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+        remove(tempFile.c_str());
+}
+
+//
+// loading
+//
+
+// every read fails once the end of the data is reached
+class BytecodeCache::Reader {
+public:
+    Reader(const StdString& data, size_t position) :
+            data(data), position(position), failed(false) {}
+
+    template<class T>
+    T Get() {
+        T value = T();
+        if (Has(sizeof(T)))
+            memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    StdString GetString() {
+        uint32_t size = Get<uint32_t>();
+        if (!Has(size))
+            return StdString();
+        position += size;
+        return data.substr(position - size, size);
+    }
+
+    VMSymbol* GetSymbol() {
+        return GetUniverse()->SymbolFor(GetString());
+    }
+
+    bool Has(size_t bytes) {
+        if (failed || position + bytes > data.size())
+            failed = true;
+        return !failed;
+    }
+
+    bool Failed() const {
+        return failed;
+    }
+
+    bool AtEnd() const {
+        return !failed && position == data.size();
+    }
+
+    VMMethod* GetMethod();
+    vm_oop_t GetLiteral();
+    void GetSymbols(ExtendedList<VMSymbol*>& symbols);
+    bool GetInvokables(ExtendedList<VMInvokable*>& invokables, bool classSide);
+
+private:
+    const StdString& data;
+    size_t position;
+    bool failed;
+};
+
+VMMethod* BytecodeCache::Reader::GetMethod() {
+    VMSymbol* signature          = GetSymbol();
+    long numberOfLocals          = Get<uint32_t>();
+    long maximumStackDepth       = Get<uint32_t>();
+    long numberOfInlineCaches    = Get<uint32_t>();
+    uint8_t trivialKind          = Get<uint8_t>();
+    uint8_t trivialIndex         = Get<uint8_t>();
+    long numberOfBytecodes       = Get<uint32_t>();
+    if (!Has(numberOfBytecodes))
+        return nullptr;
+    const uint8_t* bytecodes = (const uint8_t*) data.data() + position;
+    position += numberOfBytecodes;
+    long numberOfLiterals = Get<uint32_t>();
+    if (failed)
+        return nullptr;
+
+    VMMethod* method = GetUniverse()->NewMethod(signature, numberOfBytecodes,
+            numberOfLiterals, numberOfInlineCaches);
+    method->SetNumberOfLocals(numberOfLocals);
+    method->SetMaximumNumberOfStackElements(maximumStackDepth);
+    for (long i = 0; i < numberOfLiterals; ++i) {
+        vm_oop_t literal = GetLiteral();
+        if (failed)
+            return nullptr;
+        method->SetIndexableField(i, literal);
+    }
+    for (long i = 0; i < numberOfBytecodes; ++i)
+        method->SetBytecode(i, bytecodes[i]);
+    method->InitializeInlineCaches();
+    method->SetTrivial((VMMethod::TrivialKind) trivialKind, trivialIndex);
+    return method;
+}
+
+vm_oop_t BytecodeCache::Reader::GetLiteral() {
+    switch (Get<uint8_t>()) {
+        case TAG_NIL:
+            return load_ptr(nilObject);
+        case TAG_SYMBOL:
+            return GetSymbol();
+        case TAG_STRING:
+            return GetUniverse()->NewString(GetString());
+        case TAG_INTEGER:
+            return NEW_INT(Get<int64_t>());
+        case TAG_DOUBLE:
+            return NEW_DOUBLE(Get<double>());
+        case TAG_METHOD:
+            return GetMethod();
+        default:
+            failed = true;
+            return nullptr;
+    }
+}
+
+bool BytecodeCache::Reader::GetInvokables(ExtendedList<VMInvokable*>& invokables,
+        bool classSide) {
+    for (uint32_t n = Get<uint32_t>(); n > 0 && !failed; --n) {
+        uint8_t tag = Get<uint8_t>();
+        if (tag == TAG_PRIMITIVE) {
+            VMSymbol* signature = GetSymbol();
+            invokables.Add(VMPrimitive::GetEmptyPrimitive(signature, classSide));
+        } else if (tag == TAG_METHOD) {
+            VMMethod* method = GetMethod();
+            if (method != nullptr)
+                invokables.Add(method);
+        } else
+            failed = true;
+    }
+    return !failed;
+}
+
+void BytecodeCache::Reader::GetSymbols(ExtendedList<VMSymbol*>& symbols) {
+    for (uint32_t n = Get<uint32_t>(); n > 0 && !failed; --n)
+        symbols.Add(GetSymbol());
+}
+
+// the fields of the super class have to come first, in the same order
+static bool startsWithFieldsOf(ExtendedList<VMSymbol*>& fields, VMArray* fieldsOfSuper) {
+    long numberOfFields = fieldsOfSuper->GetNumberOfIndexableFields();
+    if ((size_t) numberOfFields > fields.Size())
+        return false;
+    for (long i = 0; i < numberOfFields; ++i) {
+        if (fields.Get(i) != fieldsOfSuper->GetIndexableField(i))
+            return false;
+    }
+    return true;
+}
+
+VMClass* BytecodeCache::Load(const StdString& cacheFile, const StdString& source,
+        VMClass* systemClass) {
+    ifstream file(cacheFile.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!file.is_open())
+        return nullptr;
+    StdString data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    if (data.compare(0, strlen(SOMC_MAGIC), SOMC_MAGIC) != 0)
+        return nullptr;
+    Reader reader(data, strlen(SOMC_MAGIC));
+    if (reader.Get<uint32_t>() != SOMC_VERSION
+            || reader.GetString() != SOMC_BUILD_ID
+            || reader.Get<uint64_t>() != source.size()
+            || reader.Get<uint64_t>() != hashSource(source))
+        return nullptr;
+
+    ClassGenerationContext cgenc;
+    cgenc.SetName(reader.GetSymbol());
+    cgenc.SetSuperName(reader.GetSymbol());
+    reader.GetSymbols(cgenc.GetInstanceFields());
+    reader.GetSymbols(cgenc.GetClassFields());
+    if (reader.Failed())
+        return nullptr;
+
+    // like the parser, load the super class before the methods
+    if (cgenc.GetSuperName() != GetUniverse()->SymbolFor("nil")) {
+        VMClass* superClass = GetUniverse()->LoadClass(cgenc.GetSuperName());
+        if (!startsWithFieldsOf(cgenc.GetInstanceFields(), superClass->GetInstanceFields())
+                || !startsWithFieldsOf(cgenc.GetClassFields(),
+                        superClass->GetClass()->GetInstanceFields()))
+            return nullptr;
+    }
+
+    if (!reader.GetInvokables(cgenc.GetInstanceMethods(), false)
+            || !reader.GetInvokables(cgenc.GetClassMethods(), true)
+            || !reader.AtEnd())
+        return nullptr;
+
+    if (systemClass == nullptr)
+        return cgenc.Assemble();
+
+    cgenc.AssembleSystemClass(systemClass);
+    return systemClass;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+class ClassGenerationContext;
+
+/*
+ * Compiled classes are cached in a .somc file next to their source, so a
+ * class only has to be parsed again when its source changed.
+ *
+ * A cache file holds what the parser collects in the ClassGenerationContext:
+ * the class and super class names, the field names, and for every method its
+ * signature, bytecodes and literals, or just the signature for primitives.
+ * It is keyed by a hash of the source, by SOMC_VERSION and by the build of
+ * the compiler that wrote it, and it is ignored when the fields of the super
+ * class no longer match, since field indices are compiled into the bytecodes.
+ */
+class BytecodeCache {
+public:
+    // nullptr if there is no valid cache for the given source
+    static VMClass* Load(const StdString& cacheFile, const StdString& source,
+            VMClass* systemClass);
+    static void Write(const StdString& cacheFile, const StdString& source,
+            ClassGenerationContext* cgenc);
+
+private:
+    class Reader;
+    class Writer;
+};
@@ -136,3 +136,8 @@ size_t BytecodeGenerator::EmitJUMP_IF_TRUE(MethodGenerationContext* mgenc) {
 size_t BytecodeGenerator::EmitJUMP(MethodGenerationContext* mgenc) {
     return emitJump(mgenc, BC_JUMP);
 }
+
+void BytecodeGenerator::EmitJUMP_BACKWARD(MethodGenerationContext* mgenc, size_t target) {
+    size_t pos = emitJump(mgenc, BC_JUMP);
+    mgenc->SetJumpTarget(pos, target);
+}
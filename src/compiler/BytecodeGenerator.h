@@ -57,4 +57,5 @@ public:
     size_t EmitJUMP_IF_FALSE(MethodGenerationContext* mgenc);
     size_t EmitJUMP_IF_TRUE(MethodGenerationContext* mgenc);
     size_t EmitJUMP(MethodGenerationContext* mgenc);
+    void   EmitJUMP_BACKWARD(MethodGenerationContext* mgenc, size_t target);
 };
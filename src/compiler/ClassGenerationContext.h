@@ -50,6 +50,10 @@ public:
     VMSymbol* GetName(void) {return name;};
     VMSymbol* GetSuperName(void) {return superName;};
     bool IsClassSide(void) {return classSide;};
+    ExtendedList<VMSymbol*>&    GetInstanceFields() {return instanceFields;}
+    ExtendedList<VMSymbol*>&    GetClassFields() {return classFields;}
+    ExtendedList<VMInvokable*>& GetInstanceMethods() {return instanceMethods;}
+    ExtendedList<VMInvokable*>& GetClassMethods() {return classMethods;}
     
     int16_t GetFieldIndex(VMSymbol* field);
     
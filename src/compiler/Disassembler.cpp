@@ -77,7 +77,7 @@ void Disassembler::dispatch(vm_oop_t o) {
         if (c == load_ptr(stringClass)) {
             DebugPrint("\"%s\"", static_cast<VMString*>(o)->GetChars());
         } else if(c == load_ptr(doubleClass))
-            DebugPrint("%g", static_cast<VMDouble*>(o)->GetEmbeddedDouble());
+            DebugPrint("%g", DOUBLE_VAL(o));
         else if(c == load_ptr(integerClass))
             DebugPrint("%lld", INT_VAL(o));
         else if(c == load_ptr(symbolClass)) {
@@ -218,7 +218,14 @@ void Disassembler::DumpMethod(VMMethod* method, const char* indent) {
                 }
                 break;
             }
-            case BC_SEND: {
+            case BC_SEND:
+            case BC_SEND_INT_ADD:
+            case BC_SEND_INT_SUB:
+            case BC_SEND_INT_MUL:
+            case BC_SEND_INT_LT:
+            case BC_SEND_INT_EQ:
+            case BC_SEND_FIELD_GET:
+            case BC_SEND_BLOCK: {
                 VMSymbol* name = static_cast<VMSymbol*>(method->GetConstant(bc_idx));
 
                 DebugPrint("(index: %d) signature: %s\n", BC_1,
@@ -429,7 +436,14 @@ void Disassembler::DumpBytecode(VMFrame* frame, VMMethod* method, long bc_idx) {
             break;
         }
         case BC_SUPER_SEND:
-        case BC_SEND: {
+        case BC_SEND:
+        case BC_SEND_INT_ADD:
+        case BC_SEND_INT_SUB:
+        case BC_SEND_INT_MUL:
+        case BC_SEND_INT_LT:
+        case BC_SEND_INT_EQ:
+        case BC_SEND_FIELD_GET:
+        case BC_SEND_BLOCK: {
             VMSymbol* sel = static_cast<VMSymbol*>(method->GetConstant(bc_idx));
 
             DebugPrint("(index: %d) signature: %s (", BC_1,
@@ -34,6 +34,8 @@
 #include "../vmobjects/VMMethod.h"
 #include "../vmobjects/VMPrimitive.h"
 
+#include "../vm/Universe.h"
+
 MethodGenerationContext::MethodGenerationContext() {
     //signature = 0;
     holderGenc = 0;
@@ -51,8 +53,15 @@ VMMethod* MethodGenerationContext::Assemble() {
     // create a method instance with the given number of bytecodes and literals
     size_t numLiterals = literals.Size();
 
+    // every send site gets its own inline cache
+    size_t numSendSites = 0;
+    for (size_t i = 0; i < bytecode.size(); i += Bytecode::GetBytecodeLength(bytecode[i])) {
+        if (bytecode[i] == BC_SEND && numSendSites < NO_INLINE_CACHE)
+            numSendSites++;
+    }
+
     VMMethod* meth = GetUniverse()->NewMethod(signature, bytecode.size(),
-            numLiterals);
+            numLiterals, numSendSites);
 
     // populate the fields that are immediately available
     size_t numLocals = locals.Size();
@@ -70,10 +79,48 @@ VMMethod* MethodGenerationContext::Assemble() {
     for (size_t i = 0; i < bc_size; i++) {
         meth->SetBytecode(i, bytecode[i]);
     }
+    meth->InitializeInlineCaches();
+    if (!blockMethod)
+        classifyTrivial(meth);
     // return the method - the holder field is to be set later on!
     return meth;
 }
 
+/*
+ * Recognize the bytecode sequences the parser produces for accessors and
+ * methods returning a constant value, so that sends to them do not need to
+ * activate a frame:
+ *   ^field                     PUSH_FIELD f, RETURN_LOCAL
+ *   field := arg               PUSH_ARGUMENT 1 0, DUP, POP_FIELD f, POP,
+ *                              PUSH_ARGUMENT 0 0, RETURN_LOCAL
+ *   ^self                      PUSH_ARGUMENT 0 0, RETURN_LOCAL
+ *   ^literal                   PUSH_CONSTANT c, RETURN_LOCAL
+ *   ^arg                       PUSH_ARGUMENT a 0, RETURN_LOCAL
+ */
+void MethodGenerationContext::classifyTrivial(VMMethod* meth) {
+    const size_t size = bytecode.size();
+
+    if (size == 3 && bytecode[2] == BC_RETURN_LOCAL) {
+        if (bytecode[0] == BC_PUSH_FIELD)
+            meth->SetTrivial(VMMethod::TRIVIAL_GETTER, bytecode[1]);
+        else if (bytecode[0] == BC_PUSH_CONSTANT)
+            meth->SetTrivial(VMMethod::TRIVIAL_RETURN_LITERAL, bytecode[1]);
+    } else if (size == 4 && bytecode[0] == BC_PUSH_ARGUMENT &&
+               bytecode[2] == 0 && bytecode[3] == BC_RETURN_LOCAL) {
+        if (bytecode[1] == 0)
+            meth->SetTrivial(VMMethod::TRIVIAL_RETURN_SELF, 0);
+        else
+            meth->SetTrivial(VMMethod::TRIVIAL_RETURN_ARGUMENT, bytecode[1]);
+    } else if (size == 11 && arguments.Size() == 2 &&
+               bytecode[0] == BC_PUSH_ARGUMENT && bytecode[1] == 1 &&
+               bytecode[2] == 0 && bytecode[3] == BC_DUP &&
+               bytecode[4] == BC_POP_FIELD && bytecode[6] == BC_POP &&
+               bytecode[7] == BC_PUSH_ARGUMENT && bytecode[8] == 0 &&
+               bytecode[9] == 0 && bytecode[10] == BC_RETURN_LOCAL) {
+        meth->SetTrivial(VMMethod::TRIVIAL_SETTER, bytecode[5]);
+    }
+}
+
 VMPrimitive* MethodGenerationContext::AssemblePrimitive(bool classSide) {
     return VMPrimitive::GetEmptyPrimitive(signature, classSide);
 }
@@ -277,9 +324,250 @@ size_t MethodGenerationContext::AddBytecode(uint8_t bc) {
 }
 
 void MethodGenerationContext::PatchJumpTarget(size_t jumpPosition) {
-    size_t jump_target = bytecode.size();
+    SetJumpTarget(jumpPosition, bytecode.size());
+}
+
+void MethodGenerationContext::SetJumpTarget(size_t jumpPosition, size_t jump_target) {
     bytecode[jumpPosition]     = (uint8_t) jump_target;
     bytecode[jumpPosition + 1] = (uint8_t) (jump_target >> 8);
     bytecode[jumpPosition + 2] = (uint8_t) (jump_target >> 16);
     bytecode[jumpPosition + 3] = (uint8_t) (jump_target >> 24);
 }
+
+/*
+ * Returns the block method pushed by the bytecodes from start to end, if these
+ * are exactly one BC_PUSH_BLOCK, i.e., the code for a literal block.
+ */
+VMMethod* MethodGenerationContext::GetLiteralBlock(size_t start, size_t end) {
+    if (end != start + Bytecode::GetBytecodeLength(BC_PUSH_BLOCK)
+        || bytecode[start] != BC_PUSH_BLOCK)
+        return nullptr;
+    return static_cast<VMMethod*>(literals.Get(bytecode[start + 1]));
+}
+
+/*
+ * Checks whether the code from start to end pushes an Integer literal only.
+ */
+bool MethodGenerationContext::IsLiteralInteger(size_t start, size_t end) {
+    if (end != start + Bytecode::GetBytecodeLength(BC_PUSH_CONSTANT)
+        || bytecode[start] != BC_PUSH_CONSTANT)
+        return false;
+    return CLASS_OF(literals.Get(bytecode[start + 1])) == load_ptr(integerClass);
+}
+
+/*
+ * Removes the code from position on, which pushes literal blocks only. Their
+ * literals are removed as well, if nothing was added after them.
+ */
+void MethodGenerationContext::RemoveLiteralBlocksFrom(size_t position) {
+    size_t end = bytecode.size();
+    while (end > position) {
+        size_t start = end - Bytecode::GetBytecodeLength(BC_PUSH_BLOCK);
+        VMMethod* block = GetLiteralBlock(start, end);
+        assert(block != nullptr);
+        if (literals.Get(literals.Size() - 1) == block)
+            literals.PopBack();
+        end = start;
+    }
+    bytecode.resize(position);
+}
+
+/*
+ * Adds a local that cannot be named in the source, for values that inlined
+ * code needs to keep, and for the arguments and locals of inlined blocks.
+ */
+size_t MethodGenerationContext::AddInlinedLocal() {
+    size_t index = locals.Size();
+    assert(index < MAX_NUMBER_OF_LOCALS);
+    locals.PushBack("$inlined " + to_string(index));
+    return index;
+}
+
+/*
+ * Checks whether count more locals can be added. The index of a local is a
+ * single byte operand, so the parser sends a message instead of inlining it
+ * when its locals would not fit anymore.
+ */
+bool MethodGenerationContext::HasRoomForLocals(size_t count) {
+    return locals.Size() + count <= MAX_NUMBER_OF_LOCALS;
+}
+
+/*
+ * Checks whether block or the blocks nested in it access the variables of
+ * the block contextLevel levels up.
+ */
+static bool accessesContext(VMMethod* block, uint8_t contextLevel) {
+    long numberOfBytecodes = block->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(block->GetBytecode(i))) {
+        switch (block->GetBytecode(i)) {
+            case BC_PUSH_LOCAL:
+            case BC_POP_LOCAL:
+            case BC_PUSH_ARGUMENT:
+            case BC_POP_ARGUMENT:
+                if (block->GetBytecode(i + 2) == contextLevel)
+                    return true;
+                break;
+            case BC_PUSH_BLOCK:
+                if (accessesContext(static_cast<VMMethod*>(block->GetConstant(i)), contextLevel + 1))
+                    return true;
+                break;
+        }
+    }
+    return false;
+}
+
+/*
+ * Checks whether block, taking numberOfArguments arguments, can be inlined.
+ * Blocks that refer to themselves or return before their last bytecode
+ * without a non-local return are not. Neither are blocks with nested blocks
+ * that capture their arguments or locals, since inlining would share these
+ * variables between all evaluations of the block.
+ */
+bool MethodGenerationContext::CanInlineBlock(VMMethod* block, long numberOfArguments) {
+    // the first argument is the block itself
+    if (block->GetNumberOfArguments() != numberOfArguments + 1)
+        return false;
+
+    long numberOfBytecodes = block->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(block->GetBytecode(i))) {
+        switch (block->GetBytecode(i)) {
+            case BC_PUSH_ARGUMENT:
+            case BC_POP_ARGUMENT:
+                if (block->GetBytecode(i + 1) == 0 && block->GetBytecode(i + 2) == 0)
+                    return false;
+                break;
+            case BC_RETURN_LOCAL:
+                if (i + 1 != numberOfBytecodes)
+                    return false;
+                break;
+            case BC_PUSH_BLOCK:
+                if (accessesContext(static_cast<VMMethod*>(block->GetConstant(i)), 1))
+                    return false;
+                break;
+        }
+    }
+    return true;
+}
+
+/*
+ * Blocks nested in an inlined block lose one level of contexts, the variables
+ * of the inlined block are not accessed, see CanInlineBlock().
+ */
+static void adaptInlinedOuter(VMMethod* block, uint8_t contextLevel) {
+    long numberOfBytecodes = block->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(block->GetBytecode(i))) {
+        switch (block->GetBytecode(i)) {
+            case BC_PUSH_LOCAL:
+            case BC_POP_LOCAL:
+            case BC_PUSH_ARGUMENT:
+            case BC_POP_ARGUMENT: {
+                uint8_t ctx = block->GetBytecode(i + 2);
+                if (ctx > contextLevel)
+                    block->SetBytecode(i + 2, ctx - 1);
+                break;
+            }
+            case BC_PUSH_BLOCK:
+                adaptInlinedOuter(static_cast<VMMethod*>(block->GetConstant(i)), contextLevel + 1);
+                break;
+        }
+    }
+}
+
+/*
+ * Copies the bytecodes of block to the end of this method. The arguments and
+ * locals of the block become locals of this method, the given locals are used
+ * for the arguments. Blocks nested in block are adapted to no longer expect
+ * a context for block. The inlined code leaves the block's result on the
+ * stack, unless it ends with a non-local return.
+ */
+void MethodGenerationContext::InlineBlock(VMMethod* block, const std::vector<size_t>& argumentLocals) {
+    std::vector<size_t> argumentMap(1, 0);
+    for (long i = 1; i < block->GetNumberOfArguments(); i++) {
+        if (i <= (long) argumentLocals.size())
+            argumentMap.push_back(argumentLocals[i - 1]);
+        else
+            argumentMap.push_back(AddInlinedLocal());
+    }
+
+    // the locals of a block start out as nil in every evaluation
+    std::vector<size_t> localMap;
+    vm_oop_t nil = load_ptr(nilObject);
+    for (long i = 0; i < block->GetNumberOfLocals(); i++) {
+        localMap.push_back(AddInlinedLocal());
+        AddLiteralIfAbsent(nil);
+        AddBytecode(BC_PUSH_CONSTANT);
+        AddBytecode(FindLiteralIndex(nil));
+        AddBytecode(BC_POP_LOCAL);
+        AddBytecode(localMap.back());
+        AddBytecode(0);
+    }
+
+    size_t base = bytecode.size();
+    long numberOfBytecodes = block->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(block->GetBytecode(i))) {
+        uint8_t bc = block->GetBytecode(i);
+        switch (bc) {
+            case BC_PUSH_LOCAL:
+            case BC_POP_LOCAL:
+            case BC_PUSH_ARGUMENT:
+            case BC_POP_ARGUMENT: {
+                uint8_t idx = block->GetBytecode(i + 1);
+                uint8_t ctx = block->GetBytecode(i + 2);
+                if (ctx == 0) {
+                    bool isPush = bc == BC_PUSH_LOCAL || bc == BC_PUSH_ARGUMENT;
+                    bool isArgument = bc == BC_PUSH_ARGUMENT || bc == BC_POP_ARGUMENT;
+                    AddBytecode(isPush ? BC_PUSH_LOCAL : BC_POP_LOCAL);
+                    AddBytecode(isArgument ? argumentMap[idx] : localMap[idx]);
+                    AddBytecode(0);
+                } else {
+                    AddBytecode(bc);
+                    AddBytecode(idx);
+                    AddBytecode(ctx - 1);
+                }
+                break;
+            }
+            case BC_PUSH_BLOCK: {
+                VMMethod* nested = static_cast<VMMethod*>(block->GetConstant(i));
+                adaptInlinedOuter(nested, 1);
+                AddLiteral(nested);
+                AddBytecode(BC_PUSH_BLOCK);
+                AddBytecode(FindLiteralIndex(nested));
+                break;
+            }
+            case BC_PUSH_CONSTANT:
+            case BC_PUSH_GLOBAL:
+            case BC_SEND:
+            case BC_SUPER_SEND: {
+                vm_oop_t literal = block->GetConstant(i);
+                AddLiteralIfAbsent(literal);
+                AddBytecode(bc);
+                AddBytecode(FindLiteralIndex(literal));
+                break;
+            }
+            case BC_RETURN_LOCAL:
+                // the end of the block, its result is left on the stack
+                break;
+            case BC_RETURN_NON_LOCAL:
+                AddBytecode(IsBlockMethod() ? BC_RETURN_NON_LOCAL : BC_RETURN_LOCAL);
+                break;
+            case BC_JUMP_IF_FALSE:
+            case BC_JUMP_IF_TRUE:
+            case BC_JUMP: {
+                size_t target = block->GetBytecode(i + 1)
+                        | block->GetBytecode(i + 2) << 8
+                        | block->GetBytecode(i + 3) << 16
+                        | block->GetBytecode(i + 4) << 24;
+                size_t jumpPosition = AddBytecode(bc);
+                for (int j = 0; j < 4; j++)
+                    AddBytecode(0);
+                SetJumpTarget(jumpPosition, base + target);
+                break;
+            }
+            default:
+                // no other bytecode has operands that depend on the method
+                for (long j = 0; j < Bytecode::GetBytecodeLength(bc); j++)
+                    AddBytecode(block->GetBytecode(i + j));
+                break;
+        }
+    }
+}
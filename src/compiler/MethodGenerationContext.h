@@ -35,6 +35,8 @@
 
 #include <vmobjects/ObjectFormats.h>
 
+// locals are addressed by a single byte operand of the bytecodes
+#define MAX_NUMBER_OF_LOCALS 256
 
 class MethodGenerationContext {
 public:
@@ -74,10 +76,22 @@ public:
     bool IsFinished();
     void RemoveLastBytecode() {bytecode.pop_back();};
     size_t GetNumberOfArguments();
+    size_t GetNumberOfBytecodes() {return bytecode.size();};
     size_t AddBytecode(uint8_t bc);
     void PatchJumpTarget(size_t jump_position);
+    void SetJumpTarget(size_t jump_position, size_t jump_target);
+
+    VMMethod* GetLiteralBlock(size_t start, size_t end);
+    bool IsLiteralInteger(size_t start, size_t end);
+    void RemoveLiteralBlocksFrom(size_t position);
+    size_t AddInlinedLocal();
+    bool HasRoomForLocals(size_t count);
+    bool CanInlineBlock(VMMethod* block, long numberOfArguments);
+    void InlineBlock(VMMethod* block, const std::vector<size_t>& argumentLocals);
 
 private:
+    void classifyTrivial(VMMethod* meth);
+
     ClassGenerationContext* holderGenc;
     MethodGenerationContext* outerGenc;
     bool blockMethod;
@@ -488,10 +488,11 @@ StdString Parser::assignment(MethodGenerationContext* mgenc) {
 
 void Parser::evaluation(MethodGenerationContext* mgenc) {
     bool super;
+    size_t receiverStart = mgenc->GetNumberOfBytecodes();
     primary(mgenc, &super);
     if (symIsIdentifier() || sym == Keyword || sym == OperatorSequence
             || symIn(binaryOpSyms)) {
-        messages(mgenc, super);
+        messages(mgenc, super, receiverStart);
     }
 }
 
@@ -537,7 +538,7 @@ StdString Parser::variable(void) {
     return identifier();
 }
 
-void Parser::messages(MethodGenerationContext* mgenc, bool super) {
+void Parser::messages(MethodGenerationContext* mgenc, bool super, size_t receiverStart) {
     if (symIsIdentifier()) {
         do {
             // only the first message in a sequence can be a super send
@@ -550,7 +551,7 @@ void Parser::messages(MethodGenerationContext* mgenc, bool super) {
         }
 
         if (sym == Keyword) {
-            keywordMessage(mgenc, false);
+            keywordMessage(mgenc, false, receiverStart);
         }
     } else if (sym == OperatorSequence || symIn(binaryOpSyms)) {
         do {
@@ -560,10 +561,10 @@ void Parser::messages(MethodGenerationContext* mgenc, bool super) {
         } while (sym == OperatorSequence || symIn(binaryOpSyms));
 
         if (sym == Keyword) {
-            keywordMessage(mgenc, false);
+            keywordMessage(mgenc, false, receiverStart);
         }
     } else
-        keywordMessage(mgenc, super);
+        keywordMessage(mgenc, super, receiverStart);
 }
 
 void Parser::unaryMessage(MethodGenerationContext* mgenc, bool super) {
@@ -680,7 +681,7 @@ void Parser::inlinedBlock(MethodGenerationContext* mgenc) {
     expect(EndBlock);
 }
 
-void Parser::keywordMessage(MethodGenerationContext* mgenc, bool super) {
+void Parser::keywordMessage(MethodGenerationContext* mgenc, bool super, size_t receiverStart) {
     StdString kw = keyword();
     
     // special compilation for ifTrue and ifFalse
@@ -691,12 +692,22 @@ void Parser::keywordMessage(MethodGenerationContext* mgenc, bool super) {
         ifFalseMessage(mgenc);
         return;
     }
+
+    // remember where the receiver and each argument start, to recognize
+    // literal blocks
+    vector<size_t> argumentStarts;
+    argumentStarts.push_back(mgenc->GetNumberOfBytecodes());
     formula(mgenc);
     while (sym == Keyword) {
         kw.append(keyword());
+        argumentStarts.push_back(mgenc->GetNumberOfBytecodes());
         formula(mgenc);
     }
 
+    // special compilation for loops and boolean operations
+    if (!super && inlinedMessage(mgenc, kw, receiverStart, argumentStarts))
+        return;
+
     VMSymbol* msg = GetUniverse()->SymbolFor(kw);
 
     mgenc->AddLiteralIfAbsent(msg);
@@ -708,6 +719,159 @@ void Parser::keywordMessage(MethodGenerationContext* mgenc, bool super) {
 
 }
 
+/*
+ * Compiles whileTrue:, whileFalse:, to:do:, to:by:do:, timesRepeat:, and:, and
+ * or: to jumps, if the blocks involved are literal blocks. The receiver and
+ * arguments have been compiled already, the code for the literal blocks is
+ * removed again. Returns false if the message has to be sent instead.
+ *
+ * The counting loops are only inlined for Integer literals as receivers. Any
+ * other receiver may implement them differently, or not at all, and there is
+ * no check at run time. Counting loops keep counter, limit, and step in three
+ * extra locals, and the locals of inlined blocks become locals of the method,
+ * so messages are sent once the method has no room left for them.
+ */
+bool Parser::inlinedMessage(MethodGenerationContext* mgenc, const StdString& kw,
+                            size_t receiverStart, const vector<size_t>& argumentStarts) {
+    size_t lastStart = argumentStarts.back();
+    VMMethod* lastBlock = mgenc->GetLiteralBlock(lastStart, mgenc->GetNumberOfBytecodes());
+    if (lastBlock == nullptr)
+        return false;
+
+    if (kw == "whileTrue:" || kw == "whileFalse:") {
+        VMMethod* condition = mgenc->GetLiteralBlock(receiverStart, lastStart);
+        if (condition == nullptr || !mgenc->CanInlineBlock(condition, 0)
+                || !mgenc->CanInlineBlock(lastBlock, 0)
+                || !mgenc->HasRoomForLocals(condition->GetNumberOfLocals()
+                                            + lastBlock->GetNumberOfLocals()))
+            return false;
+        mgenc->RemoveLiteralBlocksFrom(receiverStart);
+        whileMessage(mgenc, condition, lastBlock, kw == "whileTrue:");
+    } else if (kw == "to:do:" || kw == "to:by:do:") {
+        if (!mgenc->IsLiteralInteger(receiverStart, argumentStarts[0])
+                || !mgenc->CanInlineBlock(lastBlock, 1)
+                || !mgenc->HasRoomForLocals(3 + lastBlock->GetNumberOfLocals()))
+            return false;
+        mgenc->RemoveLiteralBlocksFrom(lastStart);
+        toDoMessage(mgenc, lastBlock, kw == "to:by:do:");
+    } else if (kw == "timesRepeat:") {
+        if (!mgenc->IsLiteralInteger(receiverStart, argumentStarts[0])
+                || !mgenc->CanInlineBlock(lastBlock, 0)
+                || !mgenc->HasRoomForLocals(3 + lastBlock->GetNumberOfLocals()))
+            return false;
+        mgenc->RemoveLiteralBlocksFrom(lastStart);
+        timesRepeatMessage(mgenc, lastBlock);
+    } else if (kw == "and:" || kw == "or:") {
+        if (!mgenc->CanInlineBlock(lastBlock, 0)
+                || !mgenc->HasRoomForLocals(lastBlock->GetNumberOfLocals()))
+            return false;
+        mgenc->RemoveLiteralBlocksFrom(lastStart);
+        andOrMessage(mgenc, lastBlock, kw == "and:");
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Parser::whileMessage(MethodGenerationContext* mgenc, VMMethod* condition,
+                          VMMethod* body, bool whileTrue) {
+    size_t loop_start = mgenc->GetNumberOfBytecodes();
+    mgenc->InlineBlock(condition, vector<size_t>());
+
+    size_t exit_pos = whileTrue ? bcGen->EmitJUMP_IF_FALSE(mgenc)
+                                : bcGen->EmitJUMP_IF_TRUE(mgenc);
+    mgenc->InlineBlock(body, vector<size_t>());
+    bcGen->EmitPOP(mgenc);
+    bcGen->EmitJUMP_BACKWARD(mgenc, loop_start);
+    mgenc->PatchJumpTarget(exit_pos);
+
+    // whileTrue: and whileFalse: evaluate to nil
+    vm_oop_t nil = load_ptr(nilObject);
+    mgenc->AddLiteralIfAbsent(nil);
+    bcGen->EmitPUSHCONSTANT(mgenc, nil);
+}
+
+void Parser::toDoMessage(MethodGenerationContext* mgenc, VMMethod* body, bool hasStep) {
+    size_t counter = mgenc->AddInlinedLocal();
+    size_t limit   = mgenc->AddInlinedLocal();
+    size_t step    = mgenc->AddInlinedLocal();
+
+    // the receiver, limit, and step are on the stack, the receiver is the
+    // result of the loop
+    if (hasStep) {
+        bcGen->EmitPOPLOCAL(mgenc, step, 0);
+    } else {
+        vm_oop_t one = NEW_INT(1);
+        mgenc->AddLiteralIfAbsent(one);
+        bcGen->EmitPUSHCONSTANT(mgenc, one);
+        bcGen->EmitPOPLOCAL(mgenc, step, 0);
+    }
+    bcGen->EmitPOPLOCAL(mgenc, limit, 0);
+    bcGen->EmitDUP(mgenc);
+    bcGen->EmitPOPLOCAL(mgenc, counter, 0);
+
+    countingLoop(mgenc, body, counter, limit, step);
+}
+
+void Parser::timesRepeatMessage(MethodGenerationContext* mgenc, VMMethod* body) {
+    size_t counter = mgenc->AddInlinedLocal();
+    size_t limit   = mgenc->AddInlinedLocal();
+    size_t step    = mgenc->AddInlinedLocal();
+
+    // the receiver is the limit, and the result of the loop
+    vm_oop_t one = NEW_INT(1);
+    mgenc->AddLiteralIfAbsent(one);
+    bcGen->EmitDUP(mgenc);
+    bcGen->EmitPOPLOCAL(mgenc, limit, 0);
+    bcGen->EmitPUSHCONSTANT(mgenc, one);
+    bcGen->EmitDUP(mgenc);
+    bcGen->EmitPOPLOCAL(mgenc, counter, 0);
+    bcGen->EmitPOPLOCAL(mgenc, step, 0);
+
+    countingLoop(mgenc, body, counter, limit, step);
+}
+
+/*
+ * Loops while counter <= limit, evaluating body with counter as its argument
+ * and adding step afterwards. The test is done as limit < counter, since < is
+ * a primitive of numbers and <= is not.
+ */
+void Parser::countingLoop(MethodGenerationContext* mgenc, VMMethod* body,
+                          size_t counter, size_t limit, size_t step) {
+    VMSymbol* lessThan = GetUniverse()->SymbolFor("<");
+    VMSymbol* plus     = GetUniverse()->SymbolFor("+");
+    mgenc->AddLiteralIfAbsent(lessThan);
+    mgenc->AddLiteralIfAbsent(plus);
+
+    size_t loop_start = mgenc->GetNumberOfBytecodes();
+    bcGen->EmitPUSHLOCAL(mgenc, limit, 0);
+    bcGen->EmitPUSHLOCAL(mgenc, counter, 0);
+    bcGen->EmitSEND(mgenc, lessThan);
+    size_t exit_pos = bcGen->EmitJUMP_IF_TRUE(mgenc);
+
+    mgenc->InlineBlock(body, vector<size_t>(1, counter));
+    bcGen->EmitPOP(mgenc);
+
+    bcGen->EmitPUSHLOCAL(mgenc, counter, 0);
+    bcGen->EmitPUSHLOCAL(mgenc, step, 0);
+    bcGen->EmitSEND(mgenc, plus);
+    bcGen->EmitPOPLOCAL(mgenc, counter, 0);
+    bcGen->EmitJUMP_BACKWARD(mgenc, loop_start);
+    mgenc->PatchJumpTarget(exit_pos);
+}
+
+void Parser::andOrMessage(MethodGenerationContext* mgenc, VMMethod* argument, bool isAnd) {
+    // when the receiver decides the result on its own, it is the result.
+    // Pushing true or false as constants does not work for the core classes,
+    // they are compiled before these objects exist.
+    bcGen->EmitDUP(mgenc);
+    size_t short_cut_pos = isAnd ? bcGen->EmitJUMP_IF_FALSE(mgenc)
+                                 : bcGen->EmitJUMP_IF_TRUE(mgenc);
+    bcGen->EmitPOP(mgenc);
+    mgenc->InlineBlock(argument, vector<size_t>());
+    mgenc->PatchJumpTarget(short_cut_pos);
+}
+
 void Parser::formula(MethodGenerationContext* mgenc) {
     bool super;
     binaryOperand(mgenc, &super);
@@ -782,7 +946,7 @@ vm_oop_t Parser::literalDouble(bool negateValue) {
         d = 0 - d;
     }
     expect(Double);
-    return GetUniverse()->NewDouble(d);
+    return NEW_DOUBLE(d);
 }
 
 void Parser::literalSymbol(MethodGenerationContext* mgenc) {
@@ -81,14 +81,23 @@ private:
     void evaluation(MethodGenerationContext* mgenc);
     void primary(MethodGenerationContext* mgenc, bool* super);
     StdString variable(void);
-    void messages(MethodGenerationContext* mgenc, bool super);
+    void messages(MethodGenerationContext* mgenc, bool super, size_t receiverStart);
     void unaryMessage(MethodGenerationContext* mgenc, bool super);
     void binaryMessage(MethodGenerationContext* mgenc, bool super);
     void binaryOperand(MethodGenerationContext* mgenc, bool* super);
-    void keywordMessage(MethodGenerationContext* mgenc, bool super);
+    void keywordMessage(MethodGenerationContext* mgenc, bool super, size_t receiverStart);
     
     void ifTrueMessage(MethodGenerationContext* mgenc);
     void ifFalseMessage(MethodGenerationContext* mgenc);
+    bool inlinedMessage(MethodGenerationContext* mgenc, const StdString& kw,
+                        size_t receiverStart, const vector<size_t>& argumentStarts);
+    void whileMessage(MethodGenerationContext* mgenc, VMMethod* condition,
+                      VMMethod* body, bool whileTrue);
+    void toDoMessage(MethodGenerationContext* mgenc, VMMethod* body, bool hasStep);
+    void timesRepeatMessage(MethodGenerationContext* mgenc, VMMethod* body);
+    void andOrMessage(MethodGenerationContext* mgenc, VMMethod* argument, bool isAnd);
+    void countingLoop(MethodGenerationContext* mgenc, VMMethod* body,
+                      size_t counter, size_t limit, size_t step);
     
     void formula(MethodGenerationContext* mgenc);
     void nestedTerm(MethodGenerationContext* mgenc);
@@ -26,8 +26,10 @@
 
 #include <sstream>
 #include <fstream>
+#include <iterator>
 
 #include "SourcecodeCompiler.h"
+#include "BytecodeCache.h"
 #include "ClassGenerationContext.h"
 #include "Parser.h"
 
@@ -53,12 +55,24 @@ VMClass* SourcecodeCompiler::CompileClass( const StdString& path,
     ifstream* fp = new ifstream();
     fp->open(fname.c_str(), std::ios_base::in);
     if (!fp->is_open()) {
+        delete(fp);
         return nullptr;
     }
+    StdString source((istreambuf_iterator<char>(*fp)), istreambuf_iterator<char>());
+    delete(fp);
 
-    if (parser != nullptr) delete(parser);
-    parser = new Parser(*fp);
-    result = compile(systemClass);
+    StdString cacheFile = path + fileSeparator + file + ".somc";
+    result = BytecodeCache::Load(cacheFile, source, systemClass);
+
+    if (result == nullptr) {
+        istringstream* ss = new istringstream(source);
+        if (parser != nullptr) delete(parser);
+        parser = new Parser(*ss);
+        result = compile(systemClass, &cacheFile, &source);
+        delete(parser);
+        parser = nullptr;
+        delete(ss);
+    }
 
     VMSymbol* cname = result->GetName();
     StdString cnameC = cname->GetStdString();
@@ -71,9 +85,6 @@ VMClass* SourcecodeCompiler::CompileClass( const StdString& path,
         showCompilationError(file, Str.str().c_str());
         return nullptr;
     }
-    delete(parser);
-    parser = nullptr;
-    delete(fp);
 #ifdef COMPILER_DEBUG
     std::cout << "Compilation finished" << endl;
 #endif
@@ -100,7 +111,8 @@ void SourcecodeCompiler::showCompilationError(const StdString& filename,
     cout << message << endl;
 }
 
-VMClass* SourcecodeCompiler::compile(VMClass* systemClass) {
+VMClass* SourcecodeCompiler::compile(VMClass* systemClass,
+        const StdString* cacheFile, const StdString* source) {
     if (parser == nullptr) {
         cout << "Parser not initiated" << endl;
         GetUniverse()->ErrorExit("Compiler error");
@@ -112,6 +124,9 @@ VMClass* SourcecodeCompiler::compile(VMClass* systemClass) {
 
     parser->Classdef(&cgc);
 
+    if (cacheFile != nullptr)
+        BytecodeCache::Write(*cacheFile, *source, &cgc);
+
     if (systemClass == nullptr)
         result = cgc.Assemble();
     else
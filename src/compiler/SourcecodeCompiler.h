@@ -41,6 +41,7 @@ public:
     VMClass* CompileClassString(const StdString& stream, VMClass* systemClass);
 private:
     void showCompilationError(const StdString& filename, const char* message);
-    VMClass* compile(VMClass* systemClass);
+    VMClass* compile(VMClass* systemClass, const StdString* cacheFile = nullptr,
+            const StdString* source = nullptr);
     Parser* parser;
 };
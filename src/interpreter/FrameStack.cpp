@@ -0,0 +1,79 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "FrameStack.h"
+
+#include <vmobjects/VMFrame.h>
+#include <vmobjects/VMMethod.h>
+
+FrameStack::FrameStack(size_t size) {
+    start = (char*) malloc(size);
+    top   = start;
+    end   = start + size;
+}
+
+FrameStack::~FrameStack() {
+    free(start);
+}
+
+/*
+ * Returns a new frame on the stack, or nullptr if the stack is exhausted.
+ */
+VMFrame* FrameStack::NewFrame(VMFrame* previousFrame, VMMethod* method) {
+    long length = method->GetNumberOfArguments() +
+    method->GetNumberOfLocals() +
+    method->GetMaximumNumberOfStackElements();
+
+    long additionalBytes = length * sizeof(VMObject*);
+    if (unlikely(top + sizeof(VMFrame) + PADDED_SIZE(additionalBytes) > end))
+        return nullptr;
+
+    VMFrame* result = new (this, additionalBytes) VMFrame(length);
+
+    result->SetMethod(method);
+    result->SetPreviousFrame(previousFrame);
+    result->ResetStackPointer();
+    return result;
+}
+
+/*
+ * Everything above a popped frame is dead, since frames are activated in LIFO
+ * order. Frames that have been copied to the heap keep their space until a
+ * frame below them is popped or active again.
+ */
+void FrameStack::FramePopped(VMFrame* popped, VMFrame* current) {
+    if (Contains(popped))
+        top = (char*) popped;
+    else if (Contains(current))
+        top = (char*) current + current->GetObjectSize();
+}
+
+void FrameStack::WalkFrames(walk_heap_fn walk) {
+    for (char* frame = start; frame < top;
+         frame += ((VMFrame*) frame)->GetObjectSize()) {
+        ((VMFrame*) frame)->WalkObjects(walk);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <misc/defs.h>
+#include <vmobjects/ObjectFormats.h>
+
+/*
+ * Size of the native region that holds activation frames, frames that do not
+ * fit anymore are allocated on the heap instead.
+ */
+#define FRAME_STACK_SIZE (1024 * 1024)
+
+/*
+ * Contiguous region of activation frames outside of the GC heap.
+ *
+ * Frames are allocated and released in LIFO order by the interpreter. Since
+ * they are not heap objects, no other object may refer to them, with the
+ * exception of the previousFrame of another frame. Whenever a frame needs to
+ * outlive its activation, i.e., when it becomes the context of a block, the
+ * interpreter copies it to the heap and continues execution on the copy.
+ *
+ * The GC does not see these frames through pointers, they are scanned as a
+ * root region instead.
+ */
+class FrameStack {
+public:
+    FrameStack(size_t size);
+    ~FrameStack();
+
+    VMFrame* NewFrame(VMFrame* previousFrame, VMMethod* method);
+    void     FramePopped(VMFrame* popped, VMFrame* current);
+    void     WalkFrames(walk_heap_fn);
+
+    inline void* AllocateFrame(size_t size);
+    inline bool  Contains(const VMFrame* frame) const;
+
+private:
+    char* start;
+    char* top;
+    char* end;
+};
+
+void* FrameStack::AllocateFrame(size_t size) {
+    void* result = top;
+    top += size;
+    return result;
+}
+
+bool FrameStack::Contains(const VMFrame* frame) const {
+    return (char*) frame >= start && (char*) frame < end;
+}
@@ -24,7 +24,11 @@
  THE SOFTWARE.
  */
 
+#include <cstring>
+#include <iomanip>
+
 #include "Interpreter.h"
+#include "TemplateJIT.h"
 #include "bytecodes.h"
 
 #include <vmobjects/VMMethod.h>
@@ -37,42 +41,263 @@
 #include <vmobjects/VMInvokable.h>
 #include <vmobjects/Signature.h>
 #include <vmobjects/VMBlock.h>
+#include <vmobjects/VMPrimitive.h>
+#include <vmobjects/PrimitiveRoutine.h>
+#include <vmobjects/VMEvaluationPrimitive.h>
+#include <vmobjects/VMInteger.h>
 #include <vmobjects/IntegerBox.h>
+#include <vmobjects/InlineCache.h>
 
 #include <compiler/Disassembler.h>
 
 
 Interpreter::Interpreter() : unknownGlobal("unknownGlobal:"),
   doesNotUnderstand("doesNotUnderstand:arguments:"),
-  escapedBlock("escapedBlock:"), frame(nullptr) {}
+  escapedBlock("escapedBlock:"), frame(nullptr),
+  frameStack(FRAME_STACK_SIZE), jit(nullptr) {
+    memset(bytecodeCounts, 0, sizeof(bytecodeCounts));
+}
+
+Interpreter::~Interpreter() {
+    delete jit;
+}
+
+/*
+ * The dispatch loop executes the threaded code of a method, see thread(). It
+ * keeps the frame, its stack pointer, the position in the threaded code and
+ * the literals of the current method in locals (fp, sp, ip, literals). They
+ * are written back to the frame and to bytecodeIndexGlobal only before
+ * anything that may inspect or switch frames, i.e., sends, returns,
+ * collections and the less frequent bytecodes, and reloaded after.
+ */
+#define SAVE_STATE() {\
+  bytecodeIndexGlobal = ip - code;\
+  fp->stack_ptr = sp;\
+}
 
-Interpreter::~Interpreter() {}
+#define LOAD_STATE() {\
+  fp = frame;\
+  sp = fp->stack_ptr;\
+  if (unlikely(method->threadedTargets != loopTargets))\
+    thread(method, loopTargets);\
+  code = method->threadedCode;\
+  ip = code + bytecodeIndexGlobal;\
+  literals = method->indexableFields;\
+}
+
+#define OUT_OF_LINE(call) {\
+  SAVE_STATE();\
+  call;\
+  LOAD_STATE();\
+}
 
 #define PROLOGUE(bc_count) {\
-  if (dumpBytecodes > 1) Disassembler::DumpBytecode(GetFrame(), GetFrame()->GetMethod(), bytecodeIndexGlobal);\
-  bytecodeIndexGlobal += bc_count;\
+  if (TRACE) { SAVE_STATE(); traceBytecode(); }\
+  ip += bc_count;\
 }
 
+// stores into the frame go through the barrier of HEAP_T, which is empty
+// for all but the generational heap, instead of testing gcType
+#define PUSH(value) do {\
+  vm_oop_t pushed = (value);\
+  *++sp = _store_ptr(pushed);\
+  GetHeap<HEAP_T>()->writeBarrier(fp, pushed);\
+} while (0)
+
+#define SET_TOP(value) do {\
+  vm_oop_t top = (value);\
+  *sp = _store_ptr(top);\
+  GetHeap<HEAP_T>()->writeBarrier(fp, top);\
+} while (0)
+
+#define SET_LOCAL(index, value) do {\
+  vm_oop_t stored = (value);\
+  fp->locals[index] = _store_ptr(stored);\
+  GetHeap<HEAP_T>()->writeBarrier(fp, stored);\
+} while (0)
+
+// the operands of the current bytecode, after PROLOGUE(bc_count)
+#define OPERAND(bc_count)       (ip[-(bc_count)].operand)
+#define CONTEXT_LEVEL(bc_count) (ip[-(bc_count)].contextLevel)
+
 #define DISPATCH_NOGC() {\
-  goto *loopTargets[currentBytecodes[bytecodeIndexGlobal]]; \
+  goto *ip->handler; \
 }
 
-#define DISPATCH_GC() {\
-  if (GetHeap<HEAP_CLS>()->isCollectionTriggered()) {\
-    GetFrame()->SetBytecodeIndex(bytecodeIndexGlobal);\
-    GetHeap<HEAP_CLS>()->FullGC();\
+#define COLLECT_IF_TRIGGERED() {\
+  if (GetHeap<HEAP_T>()->isCollectionTriggered()) {\
+    SAVE_STATE();\
+    fp->SetBytecodeIndex(bytecodeIndexGlobal);\
+    GetHeap<HEAP_T>()->FullGC();\
     method = GetFrame()->GetMethod(); \
     currentBytecodes = method->GetBytecodes(); \
+    LOAD_STATE();\
+  }\
+}
+
+/*
+ * With -jit, activations and back edges count towards compiling a method,
+ * and execution continues in compiled code where there is some. Compiled
+ * code is entered after sends and returns, and on back edges, since it
+ * leaves to the interpreter for these.
+ */
+#define ENTER_COMPILED() {\
+  if (method->compiledCode != nullptr && TemplateJIT::CanRunOn(fp))\
+    goto LABEL_RUN_COMPILED;\
+}
+
+#define COUNT_AND_ENTER_COMPILED() {\
+  if (unlikely(method->compiledCode == nullptr) && ++method->hotness == JIT_THRESHOLD)\
+    method->compiledCode = (void*) jit->Compile(method);\
+  ENTER_COMPILED();\
+}
+
+#define DISPATCH_GC() {\
+  COLLECT_IF_TRIGGERED();\
+  if (JIT) {\
+    if (ip == code)\
+      COUNT_AND_ENTER_COMPILED()\
+    else\
+      ENTER_COMPILED();\
   }\
-  goto *loopTargets[currentBytecodes[bytecodeIndexGlobal]];\
+  goto *ip->handler;\
 }
 
 void Interpreter::Start() {
+    if (unlikely(dumpBytecodes > 1 || profileBytecodes))
+        start<true, false>();
+    else if (useJIT)
+        start<false, true>();
+    else
+        start<false, false>();
+}
+
+template<bool TRACE, bool JIT>
+void Interpreter::start() {
+    switch (gcType) {
+        case GENERATIONAL: interpret<GenerationalHeap, TRACE, JIT>(); break;
+        case COPYING:      interpret<CopyingHeap, TRACE, JIT>();      break;
+        default:           interpret<MarkSweepHeap, TRACE, JIT>();    break;
+    }
+}
+
+/*
+ * Build the threaded code of meth for the loop with the given handlers. Its
+ * entries are at the same indices as the bytecodes, so that frames keep
+ * their bytecode index. Quickening updates the handlers in place.
+ */
+void Interpreter::thread(VMMethod* meth, void* const* targets) {
+    long numberOfBytecodes = meth->GetNumberOfBytecodes();
+    uint8_t* bytecodes = meth->GetBytecodes();
+
+    if (meth->threadedCode == nullptr) {
+        meth->threadedCode = new ThreadedOp[numberOfBytecodes]();
+        threadedMethods.push_back(meth);
+    }
+    ThreadedOp* code = meth->threadedCode;
+
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(bytecodes[i])) {
+        uint8_t bc = bytecodes[i];
+        code[i].handler = targets[bc];
+        switch (bc) {
+            case BC_PUSH_LOCAL:
+            case BC_PUSH_ARGUMENT:
+            case BC_POP_LOCAL:
+            case BC_POP_ARGUMENT:
+                code[i].operand      = bytecodes[i + 1];
+                code[i].contextLevel = bytecodes[i + 2];
+                break;
+            case BC_JUMP_IF_FALSE:
+            case BC_JUMP_IF_TRUE:
+            case BC_JUMP:
+                code[i].operand = bytecodes[i + 1]
+                               | (bytecodes[i + 2] << 8)
+                               | (bytecodes[i + 3] << 16)
+                               | (bytecodes[i + 4] << 24);
+                break;
+            default:
+                if (Bytecode::GetBytecodeLength(bc) > 1)
+                    code[i].operand = bytecodes[i + 1];
+                break;
+        }
+    }
+    meth->threadedTargets = targets;
+}
+
+/*
+ * Free the threaded code of all methods, it is built again when they are
+ * executed next. Collectors call this before they move or free any object,
+ * so that the methods threaded since the last collection are still where
+ * they were threaded.
+ */
+void Interpreter::ReleaseThreadedCode() {
+    for (VMMethod* meth : threadedMethods) {
+        delete[] meth->threadedCode;
+        meth->threadedCode    = nullptr;
+        meth->threadedTargets = nullptr;
+    }
+    threadedMethods.clear();
+}
+
+void Interpreter::traceBytecode() {
+    bytecodeCounts[currentBytecodes[bytecodeIndexGlobal]]++;
+    if (dumpBytecodes > 1)
+        Disassembler::DumpBytecode(GetFrame(), GetFrame()->GetMethod(), bytecodeIndexGlobal);
+}
+
+void Interpreter::PrintBytecodeCounts() const {
+    long total = 0;
+    for (long bc = 0; bc < NUMBER_OF_BYTECODES; ++bc)
+        total += bytecodeCounts[bc];
+
+    cout << "Bytecodes executed: " << total << endl;
+    for (long bc = 0; bc < NUMBER_OF_BYTECODES; ++bc) {
+        if (bytecodeCounts[bc] == 0)
+            continue;
+        cout << "  " << Bytecode::GetBytecodeName(bc)
+             << setw(14) << bytecodeCounts[bc] << "  "
+             << fixed << setprecision(2)
+             << 100.0 * bytecodeCounts[bc] / total << "%" << endl;
+    }
+}
+
+template<class HEAP_T>
+static inline void* allocate(size_t size) {
+    return GetHeap<HEAP_T>()->AllocateObject(size);
+}
+
+template<>
+inline void* allocate<GenerationalHeap>(size_t size) {
+    return GetHeap<GenerationalHeap>()->AllocateNurseryObject(size);
+}
+
+/*
+ * Box the result of a quickened integer send in the heap the loop is
+ * instantiated for, without going through SelectedHeap. Whatever the
+ * factory does apart from allocating, i.e., tagging, the integer cache and
+ * the statistics, is left to it.
+ */
+template<class HEAP_T>
+static inline vm_oop_t newInteger(int64_t value) {
+#if USE_TAGGING || CACHE_INTEGER || defined(GENERATE_INTEGER_HISTOGRAM) || defined(GENERATE_ALLOCATION_STATISTICS)
+    return NEW_INT(value);
+#else
+    return ::new (allocate<HEAP_T>(sizeof(VMInteger))) VMInteger(value);
+#endif
+}
+
+template<class HEAP_T, bool TRACE, bool JIT>
+void Interpreter::interpret() {
     // initialization
     method = GetFrame()->GetMethod();
     currentBytecodes = method->GetBytecodes();
 
-    void* loopTargets[] = {
+    if (JIT && jit == nullptr)
+        jit = new TemplateJIT(GetHeap<HEAP_T>()->GetCollectionTrigger());
+
+    // static, so that it identifies the instance of the loop threaded code
+    // has been built for
+    static void* const loopTargets[] = {
         &&LABEL_BC_HALT,
         &&LABEL_BC_DUP,
         &&LABEL_BC_PUSH_LOCAL,
@@ -91,111 +316,247 @@ void Interpreter::Start() {
         &&LABEL_BC_RETURN_NON_LOCAL,
         &&LABEL_BC_JUMP_IF_FALSE,
         &&LABEL_BC_JUMP_IF_TRUE,
-        &&LABEL_BC_JUMP
+        &&LABEL_BC_JUMP,
+        &&LABEL_BC_SEND_INT_ADD,
+        &&LABEL_BC_SEND_INT_SUB,
+        &&LABEL_BC_SEND_INT_MUL,
+        &&LABEL_BC_SEND_INT_LT,
+        &&LABEL_BC_SEND_INT_EQ,
+        &&LABEL_BC_SEND_FIELD_GET,
+        &&LABEL_BC_SEND_BLOCK
     };
 
-    goto *loopTargets[currentBytecodes[bytecodeIndexGlobal]];
+    VMFrame*    fp;
+    gc_oop_t*   sp;
+    ThreadedOp* code;
+    ThreadedOp* ip;
+    gc_oop_t*   literals;
+    LOAD_STATE();
+
+    goto *ip->handler;
 
     //
     // THIS IS THE former interpretation loop
     LABEL_BC_HALT:
       PROLOGUE(1);
+      SAVE_STATE();
       return; // handle the halt bytecode
 
     LABEL_BC_DUP:
       PROLOGUE(1);
-      doDup();
+      PUSH(load_ptr(*sp));
       DISPATCH_NOGC();
 
-    LABEL_BC_PUSH_LOCAL:       
+    LABEL_BC_PUSH_LOCAL:
       PROLOGUE(3);
-      doPushLocal(bytecodeIndexGlobal - 3);
+      if (likely(CONTEXT_LEVEL(3) == 0))
+          PUSH(load_ptr(fp->locals[OPERAND(3)]));
+      else
+          PUSH(fp->GetLocal(OPERAND(3), CONTEXT_LEVEL(3)));
       DISPATCH_NOGC();
 
     LABEL_BC_PUSH_ARGUMENT:
       PROLOGUE(3);
-      doPushArgument(bytecodeIndexGlobal - 3);
+      if (likely(CONTEXT_LEVEL(3) == 0))
+          PUSH(load_ptr(fp->arguments[OPERAND(3)]));
+      else
+          PUSH(fp->GetArgument(OPERAND(3), CONTEXT_LEVEL(3)));
       DISPATCH_NOGC();
 
     LABEL_BC_PUSH_FIELD:
       PROLOGUE(2);
-      doPushField(bytecodeIndexGlobal - 2);
+      {
+          vm_oop_t self = load_ptr(fp->GetOuterContext()->arguments[0]);
+          if (unlikely(IS_IMMEDIATE(self)))
+              GetUniverse()->ErrorExit("Integers and doubles do not have fields!");
+          PUSH(static_cast<VMObject*>(self)->GetField(OPERAND(2)));
+      }
       DISPATCH_NOGC();
 
     LABEL_BC_PUSH_BLOCK:
       PROLOGUE(2);
-      doPushBlock(bytecodeIndexGlobal - 2);
+      OUT_OF_LINE(doPushBlock(bytecodeIndexGlobal - 2));
       DISPATCH_GC();
 
     LABEL_BC_PUSH_CONSTANT:
       PROLOGUE(2);
-      doPushConstant(bytecodeIndexGlobal - 2);
+      PUSH(load_ptr(literals[OPERAND(2)]));
       DISPATCH_NOGC();
 
     LABEL_BC_PUSH_GLOBAL:
       PROLOGUE(2);
-      doPushGlobal(bytecodeIndexGlobal - 2);
+      {
+          GlobalCell* cell = static_cast<VMSymbol*>(load_ptr(literals[OPERAND(2)]))->GetGlobalCell();
+          if (likely(cell != nullptr)) {
+              PUSH(load_ptr(cell->value));
+              DISPATCH_NOGC();
+          }
+      }
+      OUT_OF_LINE(doPushGlobal(bytecodeIndexGlobal - 2));
       DISPATCH_GC();
 
     LABEL_BC_POP:
       PROLOGUE(1);
-      doPop();
+      sp--;
       DISPATCH_NOGC();
 
     LABEL_BC_POP_LOCAL:
       PROLOGUE(3);
-      doPopLocal(bytecodeIndexGlobal - 3);
+      if (likely(CONTEXT_LEVEL(3) == 0))
+          SET_LOCAL(OPERAND(3), load_ptr(*sp));
+      else
+          fp->SetLocal(OPERAND(3), CONTEXT_LEVEL(3), load_ptr(*sp));
+      sp--;
       DISPATCH_NOGC();
 
     LABEL_BC_POP_ARGUMENT:
       PROLOGUE(3);
-      doPopArgument(bytecodeIndexGlobal - 3);
+      fp->SetArgument(OPERAND(3), CONTEXT_LEVEL(3), load_ptr(*sp));
+      sp--;
       DISPATCH_NOGC();
 
     LABEL_BC_POP_FIELD:
       PROLOGUE(2);
-      doPopField(bytecodeIndexGlobal - 2);
+      {
+          vm_oop_t self = load_ptr(fp->GetOuterContext()->arguments[0]);
+          if (unlikely(IS_IMMEDIATE(self)))
+              GetUniverse()->ErrorExit("Integers and doubles do not have fields that can be set");
+          static_cast<VMObject*>(self)->SetField(OPERAND(2), load_ptr(*sp));
+      }
+      sp--;
       DISPATCH_NOGC();
 
     LABEL_BC_SEND:
       PROLOGUE(2);
-      doSend(bytecodeIndexGlobal - 2);
+      OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
       DISPATCH_GC();
 
     LABEL_BC_SUPER_SEND:
       PROLOGUE(2);
-      doSuperSend(bytecodeIndexGlobal - 2);
+      OUT_OF_LINE(doSuperSend(bytecodeIndexGlobal - 2));
       DISPATCH_GC();
 
     LABEL_BC_RETURN_LOCAL:
       PROLOGUE(1);
-      doReturnLocal();
+      OUT_OF_LINE(doReturnLocal());
+      if (JIT)
+          ENTER_COMPILED();
       DISPATCH_NOGC();
 
     LABEL_BC_RETURN_NON_LOCAL:
       PROLOGUE(1);
-      doReturnNonLocal();
+      OUT_OF_LINE(doReturnNonLocal());
+      if (JIT)
+          ENTER_COMPILED();
       DISPATCH_NOGC();
 
     LABEL_BC_JUMP_IF_FALSE:
       PROLOGUE(5);
-      doJumpIfFalse(bytecodeIndexGlobal - 5);
+      if (load_ptr(*sp--) == load_ptr(falseObject))
+          ip = code + OPERAND(5);
       DISPATCH_NOGC();
 
     LABEL_BC_JUMP_IF_TRUE:
       PROLOGUE(5);
-      doJumpIfTrue(bytecodeIndexGlobal - 5);
+      if (load_ptr(*sp--) == load_ptr(trueObject))
+          ip = code + OPERAND(5);
       DISPATCH_NOGC();
 
     LABEL_BC_JUMP:
       PROLOGUE(5);
-      doJump(bytecodeIndexGlobal - 5);
+      if (JIT && code + OPERAND(5) < ip) {
+          ip = code + OPERAND(5);
+          COUNT_AND_ENTER_COMPILED();
+      } else
+          ip = code + OPERAND(5);
+      DISPATCH_NOGC();
+
+    LABEL_BC_SEND_INT_ADD:
+      PROLOGUE(2);
+      if (likely(hasIntegerOperands(ip - code - 2, load_ptr(sp[-1]), load_ptr(sp[0])))) {
+          vm_oop_t right = load_ptr(*sp--);
+          SET_TOP(newInteger<HEAP_T>((int64_t)INT_VAL(load_ptr(*sp)) + (int64_t)INT_VAL(right)));
+      } else
+          OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    LABEL_BC_SEND_INT_SUB:
+      PROLOGUE(2);
+      if (likely(hasIntegerOperands(ip - code - 2, load_ptr(sp[-1]), load_ptr(sp[0])))) {
+          vm_oop_t right = load_ptr(*sp--);
+          SET_TOP(newInteger<HEAP_T>((int64_t)INT_VAL(load_ptr(*sp)) - (int64_t)INT_VAL(right)));
+      } else
+          OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    LABEL_BC_SEND_INT_MUL:
+      PROLOGUE(2);
+      if (likely(hasIntegerOperands(ip - code - 2, load_ptr(sp[-1]), load_ptr(sp[0])))) {
+          vm_oop_t right = load_ptr(*sp--);
+          SET_TOP(newInteger<HEAP_T>((int64_t)INT_VAL(load_ptr(*sp)) * (int64_t)INT_VAL(right)));
+      } else
+          OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    LABEL_BC_SEND_INT_LT:
+      PROLOGUE(2);
+      if (likely(hasIntegerOperands(ip - code - 2, load_ptr(sp[-1]), load_ptr(sp[0])))) {
+          vm_oop_t right = load_ptr(*sp--);
+          SET_TOP(INT_VAL(load_ptr(*sp)) < INT_VAL(right) ? load_ptr(trueObject)
+                                                          : load_ptr(falseObject));
+      } else
+          OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    LABEL_BC_SEND_INT_EQ:
+      PROLOGUE(2);
+      if (likely(hasIntegerOperands(ip - code - 2, load_ptr(sp[-1]), load_ptr(sp[0])))) {
+          vm_oop_t right = load_ptr(*sp--);
+          SET_TOP(INT_VAL(load_ptr(*sp)) == INT_VAL(right) ? load_ptr(trueObject)
+                                                           : load_ptr(falseObject));
+      } else
+          OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    LABEL_BC_SEND_FIELD_GET:
+      PROLOGUE(2);
+      {
+          vm_oop_t receiver = load_ptr(*sp);
+          VMInvokable* getter = nullptr;
+          if (!IS_IMMEDIATE(receiver))
+              getter = method->GetInlineCache(ip - code - 2)->Lookup(CLASS_OF(receiver));
+
+          if (likely(getter != nullptr)) {
+              long fieldIndex = static_cast<VMMethod*>(getter)->GetTrivialIndex();
+              SET_TOP(static_cast<VMObject*>(receiver)->GetField(fieldIndex));
+              DISPATCH_NOGC();
+          }
+      }
+      OUT_OF_LINE(doSend(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    LABEL_BC_SEND_BLOCK:
+      PROLOGUE(2);
+      OUT_OF_LINE(doSendBlock(bytecodeIndexGlobal - 2));
+      DISPATCH_GC();
+
+    // runs compiled code up to the first bytecode it leaves to the
+    // interpreter, which is executed before compiled code is entered again
+    LABEL_RUN_COMPILED:
+      SAVE_STATE();
+      bytecodeIndexGlobal = reinterpret_cast<CompiledMethod>(method->compiledCode)(
+              fp, literals, bytecodeIndexGlobal);
+      LOAD_STATE();
+      COLLECT_IF_TRIGGERED();
       DISPATCH_NOGC();
 }
 
 VMFrame* Interpreter::PushNewFrame(VMMethod* method) {
-    SetFrame(GetUniverse()->NewFrame(GetFrame(), method));
-    return GetFrame();
+    VMFrame* newFrame = frameStack.NewFrame(GetFrame(), method);
+    if (unlikely(newFrame == nullptr))
+        newFrame = GetUniverse()->NewFrame(GetFrame(), method);
+    SetFrame(newFrame);
+    return newFrame;
 }
 
 void Interpreter::SetFrame(VMFrame* frame) {
@@ -220,10 +581,12 @@ VMFrame* Interpreter::popFrame() {
     SetFrame(GetFrame()->GetPreviousFrame());
 
     result->ClearPreviousFrame();
+    frameStack.FramePopped(result, GetFrame());
 
 #ifdef UNSAFE_FRAME_OPTIMIZATION
     //remember this frame as free frame
-    result->GetMethod()->SetCachedFrame(result);
+    if (!frameStack.Contains(result))
+        result->GetMethod()->SetCachedFrame(result);
 #endif
     return result;
 }
@@ -239,8 +602,7 @@ void Interpreter::popFrameAndPushResult(vm_oop_t result) {
     GetFrame()->Push(result);
 }
 
-void Interpreter::send(VMSymbol* signature, VMClass* receiverClass) {
-    VMInvokable* invokable = receiverClass->LookupInvokable(signature);
+void Interpreter::send(VMSymbol* signature, VMClass* receiverClass, VMInvokable* invokable) {
 
     if (invokable != nullptr) {
 #ifdef LOG_RECEIVER_TYPES
@@ -251,6 +613,17 @@ void Interpreter::send(VMSymbol* signature, VMClass* receiverClass) {
         if (invokable->IsPrimitive())
         GetUniverse()->callStats[name].noPrimitiveCalls++;
 #endif
+        if (invokable->IsPrimitive()) {
+            if (invokeDirect(static_cast<VMPrimitive*>(invokable)))
+                return;
+        } else {
+            VMMethod* meth = static_cast<VMMethod*>(invokable);
+            if (meth->GetTrivialKind() != VMMethod::NOT_TRIVIAL) {
+                invokeTrivial(meth);
+                return;
+            }
+        }
+
         // since an invokable is able to change/use the frame, we have to write
         // cached values before, and read cached values after calling
         GetFrame()->SetBytecodeIndex(bytecodeIndexGlobal);
@@ -288,43 +661,62 @@ void Interpreter::send(VMSymbol* signature, VMClass* receiverClass) {
     }
 }
 
-void Interpreter::doDup() {
-    vm_oop_t elem = GetFrame()->GetStackElement(0);
-    GetFrame()->Push(elem);
-}
-
-void Interpreter::doPushLocal(long bytecodeIndex) {
-    uint8_t bc1 = method->GetBytecode(bytecodeIndex + 1);
-    uint8_t bc2 = method->GetBytecode(bytecodeIndex + 2);
-
-    vm_oop_t local = GetFrame()->GetLocal(bc1, bc2);
-
-    GetFrame()->Push(local);
-}
-
-void Interpreter::doPushArgument(long bytecodeIndex) {
-    uint8_t bc1 = method->GetBytecode(bytecodeIndex + 1);
-    uint8_t bc2 = method->GetBytecode(bytecodeIndex + 2);
-
-    vm_oop_t argument = GetFrame()->GetArgument(bc1, bc2);
+/*
+ * Run a method classified as trivial by the compiler directly on the current
+ * frame: the receiver and arguments are replaced by the result, as if the
+ * method had been activated and returned.
+ */
+void Interpreter::invokeTrivial(VMMethod* meth) {
+    long numberOfArgs = meth->GetNumberOfArguments();
+    long index = meth->GetTrivialIndex();
+    vm_oop_t receiver = GetFrame()->GetStackElement(numberOfArgs - 1);
+    vm_oop_t result;
+
+    switch (meth->GetTrivialKind()) {
+        case VMMethod::TRIVIAL_GETTER:
+            result = static_cast<VMObject*>(receiver)->GetField(index);
+            break;
+        case VMMethod::TRIVIAL_SETTER:
+            static_cast<VMObject*>(receiver)->SetField(index, GetFrame()->GetStackElement(0));
+            result = receiver;
+            break;
+        case VMMethod::TRIVIAL_RETURN_LITERAL:
+            result = meth->GetIndexableField(index);
+            break;
+        case VMMethod::TRIVIAL_RETURN_ARGUMENT:
+            result = GetFrame()->GetStackElement(numberOfArgs - 1 - index);
+            break;
+        default:
+            result = receiver;
+            break;
+    }
 
-    GetFrame()->Push(argument);
+    for (long i = 0; i < numberOfArgs; ++i)
+        GetFrame()->Pop();
+    GetFrame()->Push(result);
 }
 
-void Interpreter::doPushField(long bytecodeIndex) {
-    uint8_t fieldIndex = method->GetBytecode(bytecodeIndex + 1);
-    vm_oop_t self = GetSelf();
-    vm_oop_t o;
-
-    if (unlikely(IS_TAGGED(self))) {
-        o = nullptr;
-        Universe()->ErrorExit("Integers do not have fields!");
-    }
-    else {
-        o = ((VMObject*)self)->GetField(fieldIndex);
-    }
-
-    GetFrame()->Push(o);
+/*
+ * Call a primitive through its direct entry, if it has one, replacing the
+ * receiver and arguments with the result. Returns false, with the stack
+ * untouched, if there is none or the primitive failed, in which case the
+ * primitive has to be invoked through the frame.
+ */
+bool Interpreter::invokeDirect(VMPrimitive* prim) {
+    PrimitiveRoutine* routine = prim->GetRoutine();
+    long arity = routine->GetDirectArity();
+    if (arity < 0)
+        return false;
+
+    VMFrame* frame = GetFrame();
+    vm_oop_t result = routine->InvokeDirect(frame->stack_ptr);
+    if (result == nullptr)
+        return false;
+
+    frame->stack_ptr -= arity;
+    *frame->stack_ptr = _store_ptr(result);
+    write_barrier(frame, result);
+    return true;
 }
 
 void Interpreter::doPushBlock(long bytecodeIndex) {
@@ -345,20 +737,22 @@ void Interpreter::doPushBlock(long bytecodeIndex) {
 
     long numOfArgs = blockMethod->GetNumberOfArguments();
 
-    GetFrame()->Push(GetUniverse()->NewBlock(blockMethod, GetFrame(), numOfArgs));
-}
+    // the block may outlive the activation, so its context has to be on the
+    // heap. The copy replaces the stack frame for the rest of the activation.
+    if (frameStack.Contains(GetFrame())) {
+        GetFrame()->SetBytecodeIndex(bytecodeIndexGlobal);
+        SetFrame(VMFrame::EmergencyFrameFrom(GetFrame(), 0));
+    }
 
-void Interpreter::doPushConstant(long bytecodeIndex) {
-    vm_oop_t constant = method->GetConstant(bytecodeIndex);
-    GetFrame()->Push(constant);
+    GetFrame()->Push(GetUniverse()->NewBlock(blockMethod, GetFrame(), numOfArgs));
 }
 
 void Interpreter::doPushGlobal(long bytecodeIndex) {
     VMSymbol* globalName = static_cast<VMSymbol*>(method->GetConstant(bytecodeIndex));
-    vm_oop_t global = GetUniverse()->GetGlobal(globalName);
+    GlobalCell* cell = globalName->GetGlobalCell();
 
-    if (global != nullptr)
-        GetFrame()->Push(global);
+    if (likely(cell != nullptr))
+        GetFrame()->Push(load_ptr(cell->value));
     else {
         vm_oop_t arguments[] = {globalName};
         vm_oop_t self = GetSelf();
@@ -376,41 +770,6 @@ void Interpreter::doPushGlobal(long bytecodeIndex) {
     }
 }
 
-void Interpreter::doPop() {
-    GetFrame()->Pop();
-}
-
-void Interpreter::doPopLocal(long bytecodeIndex) {
-    uint8_t bc1 = method->GetBytecode(bytecodeIndex + 1);
-    uint8_t bc2 = method->GetBytecode(bytecodeIndex + 2);
-
-    vm_oop_t o = GetFrame()->Pop();
-
-    GetFrame()->SetLocal(bc1, bc2, o);
-}
-
-void Interpreter::doPopArgument(long bytecodeIndex) {
-    uint8_t bc1 = method->GetBytecode(bytecodeIndex + 1);
-    uint8_t bc2 = method->GetBytecode(bytecodeIndex + 2);
-
-    vm_oop_t o = GetFrame()->Pop();
-    GetFrame()->SetArgument(bc1, bc2, o);
-}
-
-void Interpreter::doPopField(long bytecodeIndex) {
-    uint8_t field_index = method->GetBytecode(bytecodeIndex + 1);
-
-    vm_oop_t self = GetSelf();
-    vm_oop_t o = GetFrame()->Pop();
-
-    if (unlikely(IS_TAGGED(self))) {
-        GetUniverse()->ErrorExit("Integers do not have fields that can be set");
-    }
-    else {
-        ((VMObject*) self)->SetField(field_index, o);
-    }
-}
-
 void Interpreter::doSend(long bytecodeIndex) {
     VMSymbol* signature = static_cast<VMSymbol*>(method->GetConstant(bytecodeIndex));
 
@@ -428,7 +787,20 @@ void Interpreter::doSend(long bytecodeIndex) {
     GetUniverse()->receiverTypes[receiverClass->GetName()->GetStdString()]++;
 #endif
 
-    send(signature, receiverClass);
+    InlineCache* cache = method->GetInlineCache(bytecodeIndex);
+    VMInvokable* invokable = nullptr;
+    if (cache != nullptr)
+        invokable = cache->Lookup(receiverClass);
+
+    if (invokable == nullptr) {
+        invokable = receiverClass->LookupInvokable(signature);
+        if (invokable != nullptr && cache != nullptr) {
+            cache->Update(method, receiverClass, invokable);
+            quicken(bytecodeIndex, signature, cache);
+        }
+    }
+
+    send(signature, receiverClass, invokable);
 }
 
 void Interpreter::doSuperSend(long bytecodeIndex) {
@@ -440,9 +812,13 @@ void Interpreter::doSuperSend(long bytecodeIndex) {
     VMClass* super = holder->GetSuperClass();
     VMInvokable* invokable = static_cast<VMInvokable*>(super->LookupInvokable(signature));
 
-    if (invokable != nullptr)
-        (*invokable)(GetFrame());
-    else {
+    if (invokable != nullptr) {
+        if (!invokable->IsPrimitive() &&
+            static_cast<VMMethod*>(invokable)->GetTrivialKind() != VMMethod::NOT_TRIVIAL)
+            invokeTrivial(static_cast<VMMethod*>(invokable));
+        else
+            (*invokable)(GetFrame());
+    } else {
         long numOfArgs = Signature::GetNumberOfArguments(signature);
         vm_oop_t receiver = GetFrame()->GetStackElement(numOfArgs - 1);
         VMArray* argumentsArray = GetUniverse()->NewArray(numOfArgs);
@@ -500,29 +876,6 @@ void Interpreter::doReturnNonLocal() {
     popFrameAndPushResult(result);
 }
 
-void Interpreter::doJumpIfFalse(long bytecodeIndex) {
-    vm_oop_t value = GetFrame()->Pop();
-    if (value == load_ptr(falseObject))
-        doJump(bytecodeIndex);
-}
-
-void Interpreter::doJumpIfTrue(long bytecodeIndex) {
-    vm_oop_t value = GetFrame()->Pop();
-    if (value == load_ptr(trueObject))
-        doJump(bytecodeIndex);
-}
-
-void Interpreter::doJump(long bytecodeIndex) {
-    long target = 0;
-    target |= method->GetBytecode(bytecodeIndex + 1);
-    target |= method->GetBytecode(bytecodeIndex + 2) << 8;
-    target |= method->GetBytecode(bytecodeIndex + 3) << 16;
-    target |= method->GetBytecode(bytecodeIndex + 4) << 24;
-
-    // do the jump
-    bytecodeIndexGlobal = target;
-}
-
 void Interpreter::WalkGlobals(walk_heap_fn walk) {
 #warning method and frame are stored as VMptrs, is that acceptable? Is the solution here with _store_ptr and load_ptr robust?
     
@@ -530,7 +883,68 @@ void Interpreter::WalkGlobals(walk_heap_fn walk) {
     
     // Get the current frame and mark it.
     // Since marking is done recursively, this automatically
-    // marks the whole stack
+    // marks the whole stack, apart from the frames on the frame stack,
+    // which are walked in place
 # warning Do I need a null check here?
-    frame  = load_ptr(static_cast<GCFrame*>(walk(_store_ptr(frame))));
+    if (!frameStack.Contains(frame))
+        frame = load_ptr(static_cast<GCFrame*>(walk(_store_ptr(frame))));
+    frameStack.WalkFrames(walk);
+}
+
+/*
+ * Rewrite the send at bytecodeIndex based on what its inline cache has seen
+ * so far. This is only done on cache misses, since only those change the
+ * cache. The quickened bytecodes rely on the cache to stay valid, and revert
+ * to a normal send as soon as their guards fail.
+ */
+void Interpreter::quicken(long bytecodeIndex, VMSymbol* signature, InlineCache* cache) {
+    uint8_t bc = BC_SEND;
+
+    VMInvokable* intInvokable = cache->Lookup(load_ptr(integerClass));
+    if (intInvokable != nullptr && intInvokable->IsPrimitive() &&
+        !static_cast<VMPrimitive*>(intInvokable)->IsEmpty()) {
+        const char* sel = signature->GetChars();
+        if      (strcmp(sel, "+") == 0) bc = BC_SEND_INT_ADD;
+        else if (strcmp(sel, "-") == 0) bc = BC_SEND_INT_SUB;
+        else if (strcmp(sel, "*") == 0) bc = BC_SEND_INT_MUL;
+        else if (strcmp(sel, "<") == 0) bc = BC_SEND_INT_LT;
+        else if (strcmp(sel, "=") == 0) bc = BC_SEND_INT_EQ;
+    } else if (cache->GetState() == InlineCache::MONOMORPHIC) {
+        VMInvokable* invokable = cache->GetInvokable(0);
+        if (dynamic_cast<VMEvaluationPrimitive*>(invokable) != nullptr) {
+            bc = BC_SEND_BLOCK;
+        } else if (!invokable->IsPrimitive() &&
+                   static_cast<VMMethod*>(invokable)->GetTrivialKind() == VMMethod::TRIVIAL_GETTER) {
+            bc = BC_SEND_FIELD_GET;
+        }
+    }
+
+    method->SetBytecode(bytecodeIndex, bc);
+    if (method->threadedTargets != nullptr)
+        method->threadedCode[bytecodeIndex].handler = method->threadedTargets[bc];
+}
+
+bool Interpreter::hasIntegerOperands(long bytecodeIndex, vm_oop_t left, vm_oop_t right) const {
+    return (IS_TAGGED(left)  || CLASS_OF(left)  == load_ptr(integerClass)) &&
+           (IS_TAGGED(right) || CLASS_OF(right) == load_ptr(integerClass)) &&
+           method->GetInlineCache(bytecodeIndex)->IsValid();
+}
+
+void Interpreter::doSendBlock(long bytecodeIndex) {
+    VMSymbol* signature = static_cast<VMSymbol*>(method->GetConstant(bytecodeIndex));
+    long numOfArgs = Signature::GetNumberOfArguments(signature);
+    vm_oop_t receiver = GetFrame()->GetStackElement(numOfArgs - 1);
+
+    if (unlikely(method->GetInlineCache(bytecodeIndex)->Lookup(CLASS_OF(receiver)) == nullptr)) {
+        doSend(bytecodeIndex);
+        return;
+    }
+
+    // activate the block directly, without going through its
+    // VMEvaluationPrimitive
+    VMBlock* block = static_cast<VMBlock*>(receiver);
+    VMFrame* callerFrame = GetFrame();
+    VMFrame* blockFrame = PushNewFrame(block->GetMethod());
+    blockFrame->CopyArgumentsFrom(callerFrame);
+    blockFrame->SetContext(block->GetContext());
 }
@@ -26,9 +26,17 @@
  THE SOFTWARE.
  */
 
+#include <vector>
+
 #include <misc/defs.h>
 #include <vmobjects/ObjectFormats.h>
 
+#include "FrameStack.h"
+#include "bytecodes.h"
+
+class InlineCache;
+class TemplateJIT;
+
 class Interpreter {
 public:
     Interpreter();
@@ -38,13 +46,18 @@ public:
     VMFrame*  PushNewFrame(VMMethod* method);
     void      SetFrame(VMFrame* frame);
     inline VMFrame* GetFrame() const;
+    inline bool     IsStackFrame(const VMFrame* frame) const;
     void      WalkGlobals(walk_heap_fn);
+    void      ReleaseThreadedCode();
+    void      PrintBytecodeCounts() const;
     
 private:
     vm_oop_t GetSelf() const;
     
     VMFrame* frame;
     VMMethod* method;
+
+    FrameStack frameStack;
     
     // The following three variables are used to cache main parts of the
     // current execution context
@@ -56,30 +69,46 @@ private:
     const StdString doesNotUnderstand;
     const StdString escapedBlock;
 
+    // executions per bytecode, only counted by the tracing loop
+    long bytecodeCounts[NUMBER_OF_BYTECODES];
+
+    // compiles hot methods with -jit
+    TemplateJIT* jit;
+
+    // the methods threaded since the last collection, whose threaded code
+    // is owned by the interpreter
+    std::vector<VMMethod*> threadedMethods;
+
+    // the interpreter loop, instantiated once per heap class so that
+    // checking for a pending collection does not dispatch on the collector,
+    // and once more with TRACE for -d -d and -p and with JIT for -jit, so
+    // that the loop used otherwise does not check for either
+    template<bool TRACE, bool JIT> void start();
+    template<class HEAP_T, bool TRACE, bool JIT> void interpret();
+    void traceBytecode();
+    void thread(VMMethod* meth, void* const* targets);
+
     VMFrame* popFrame();
     void popFrameAndPushResult(vm_oop_t result);
-    void send(VMSymbol* signature, VMClass* receiverClass);
+    void send(VMSymbol* signature, VMClass* receiverClass, VMInvokable* invokable);
+    void invokeTrivial(VMMethod* meth);
+    bool invokeDirect(VMPrimitive* prim);
+    void quicken(long bytecodeIndex, VMSymbol* signature, InlineCache* cache);
+    inline bool hasIntegerOperands(long bytecodeIndex, vm_oop_t left, vm_oop_t right) const;
 
-    void doDup();
-    void doPushLocal(long bytecodeIndex);
-    void doPushArgument(long bytecodeIndex);
-    void doPushField(long bytecodeIndex);
     void doPushBlock(long bytecodeIndex);
-    void doPushConstant(long bytecodeIndex);
     void doPushGlobal(long bytecodeIndex);
-    void doPop(void);
-    void doPopLocal(long bytecodeIndex);
-    void doPopArgument(long bytecodeIndex);
-    void doPopField(long bytecodeIndex);
     void doSend(long bytecodeIndex);
     void doSuperSend(long bytecodeIndex);
     void doReturnLocal();
     void doReturnNonLocal();
-    void doJumpIfFalse(long bytecodeIndex);
-    void doJumpIfTrue(long bytecodeIndex);
-    void doJump(long bytecodeIndex);
+    void doSendBlock(long bytecodeIndex);
 };
 
 VMFrame* Interpreter::GetFrame() const {
     return frame;
 }
+
+bool Interpreter::IsStackFrame(const VMFrame* frame) const {
+    return frameStack.Contains(frame);
+}
@@ -0,0 +1,559 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstring>
+#include <map>
+
+#include "TemplateJIT.h"
+#include "bytecodes.h"
+
+#include <vm/Universe.h>
+
+#include <vmobjects/VMFrame.h>
+#include <vmobjects/VMMethod.h>
+#include <vmobjects/VMObject.h>
+#include <vmobjects/VMSymbol.h>
+#include <vmobjects/VMPrimitive.h>
+#include <vmobjects/Signature.h>
+#include <vmobjects/VMInteger.h>
+#include <vmobjects/InlineCache.h>
+
+TemplateJIT::TemplateJIT(const bool* collectionTriggered) :
+        collectionTriggered(collectionTriggered), top(nullptr), end(nullptr) {}
+
+TemplateJIT::~TemplateJIT() {
+    for (uint8_t* chunk : chunks)
+        munmap(chunk, JIT_CHUNK_SIZE);
+}
+
+/*
+ * Returns memory for code of the given size, which is writable until it is
+ * passed to protect(). Code is never freed, methods are only compiled once.
+ */
+uint8_t* TemplateJIT::allocate(size_t size) {
+    size = PADDED_SIZE(size);
+    if (size > JIT_CHUNK_SIZE)
+        return nullptr;
+
+    if (top == nullptr || top + size > end) {
+        void* chunk = mmap(nullptr, JIT_CHUNK_SIZE, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk == MAP_FAILED)
+            return nullptr;
+        chunks.push_back((uint8_t*) chunk);
+        top = (uint8_t*) chunk;
+        end = top + JIT_CHUNK_SIZE;
+    }
+
+    uint8_t* result = top;
+    top += size;
+    return result;
+}
+
+/*
+ * Changes the protection of the pages the given code lies on. Pages are
+ * never writable and executable at the same time, code that shares a page
+ * with the code being emitted cannot run meanwhile, since the interpreter
+ * compiles between bytecodes.
+ */
+bool TemplateJIT::protect(uint8_t* code, size_t size, int protection) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t first = (uintptr_t) code & ~(pageSize - 1);
+    uintptr_t last  = ((uintptr_t) code + size + pageSize - 1) & ~(pageSize - 1);
+    return mprotect((void*) first, last - first, protection) == 0;
+}
+
+#if defined(__x86_64__)
+
+bool TemplateJIT::IsSupported() {
+    return true;
+}
+
+//
+// Helpers called from compiled code, for what is too large to be inlined
+// into a template. The quickened sends return whether their guards held.
+//
+
+static vm_oop_t getLocal(VMFrame* frame, long index, long contextLevel) {
+    return frame->GetLocal(index, contextLevel);
+}
+
+static vm_oop_t getArgument(VMFrame* frame, long index, long contextLevel) {
+    return frame->GetArgument(index, contextLevel);
+}
+
+static void setLocal(VMFrame* frame, long index, long contextLevel, vm_oop_t value) {
+    frame->SetLocal(index, contextLevel, value);
+}
+
+static void setArgument(VMFrame* frame, long index, long contextLevel, vm_oop_t value) {
+    frame->SetArgument(index, contextLevel, value);
+}
+
+static vm_oop_t getField(VMFrame* frame, long index) {
+    vm_oop_t self = frame->GetOuterContext()->GetArgument(0, 0);
+    if (unlikely(IS_IMMEDIATE(self)))
+        GetUniverse()->ErrorExit("Integers and doubles do not have fields!");
+    return static_cast<VMObject*>(self)->GetField(index);
+}
+
+static void setField(VMFrame* frame, long index, vm_oop_t value) {
+    vm_oop_t self = frame->GetOuterContext()->GetArgument(0, 0);
+    if (unlikely(IS_IMMEDIATE(self)))
+        GetUniverse()->ErrorExit("Integers and doubles do not have fields that can be set");
+    static_cast<VMObject*>(self)->SetField(index, value);
+}
+
+// returns nullptr for globals that are not defined
+static vm_oop_t getGlobal(gc_oop_t name) {
+    GlobalCell* cell = static_cast<VMSymbol*>(load_ptr(name))->GetGlobalCell();
+    return cell == nullptr ? nullptr : load_ptr(cell->value);
+}
+
+static inline bool hasIntegerOperands(VMFrame* frame, long bytecodeIndex,
+                                      vm_oop_t left, vm_oop_t right) {
+    return (IS_TAGGED(left)  || CLASS_OF(left)  == load_ptr(integerClass)) &&
+           (IS_TAGGED(right) || CLASS_OF(right) == load_ptr(integerClass)) &&
+           frame->GetMethod()->GetInlineCache(bytecodeIndex)->IsValid();
+}
+
+#define INTEGER_SEND(name, result) \
+static bool name(VMFrame* frame, gc_oop_t* sp, long bytecodeIndex) {\
+    vm_oop_t left  = load_ptr(sp[-1]);\
+    vm_oop_t right = load_ptr(sp[0]);\
+    if (unlikely(!hasIntegerOperands(frame, bytecodeIndex, left, right)))\
+        return false;\
+    int64_t l = INT_VAL(left);\
+    int64_t r = INT_VAL(right);\
+    sp[-1] = _store_ptr(result);\
+    return true;\
+}
+
+INTEGER_SEND(sendIntAdd, NEW_INT(l + r))
+INTEGER_SEND(sendIntSub, NEW_INT(l - r))
+INTEGER_SEND(sendIntMul, NEW_INT(l * r))
+INTEGER_SEND(sendIntLt,  l <  r ? load_ptr(trueObject) : load_ptr(falseObject))
+INTEGER_SEND(sendIntEq,  l == r ? load_ptr(trueObject) : load_ptr(falseObject))
+
+static bool sendFieldGet(VMFrame* frame, gc_oop_t* sp, long bytecodeIndex) {
+    vm_oop_t receiver = load_ptr(*sp);
+    if (IS_IMMEDIATE(receiver))
+        return false;
+
+    VMInvokable* getter = frame->GetMethod()->GetInlineCache(bytecodeIndex)->Lookup(CLASS_OF(receiver));
+    if (getter == nullptr)
+        return false;
+
+    long fieldIndex = static_cast<VMMethod*>(getter)->GetTrivialIndex();
+    *sp = _store_ptr(static_cast<VMObject*>(receiver)->GetField(fieldIndex));
+    return true;
+}
+
+/*
+ * Monomorphic sends whose target needs no frame of its own, i.e., trivial
+ * methods and primitives with a direct entry, are run right here. Returns
+ * the new stack pointer, or nullptr if the inline cache misses or the target
+ * has to be activated by the interpreter.
+ */
+gc_oop_t* TemplateJIT::sendMonomorphic(VMFrame* frame, gc_oop_t* sp, long bytecodeIndex,
+                                       long numberOfArgs) {
+    InlineCache* cache = frame->GetMethod()->GetInlineCache(bytecodeIndex);
+    if (cache == nullptr || cache->GetState() != InlineCache::MONOMORPHIC)
+        return nullptr;
+
+    vm_oop_t receiver = load_ptr(sp[1 - numberOfArgs]);
+    VMInvokable* invokable = cache->Lookup(CLASS_OF(receiver));
+    if (invokable == nullptr)
+        return nullptr;
+
+    vm_oop_t result;
+    if (invokable->IsPrimitive()) {
+        PrimitiveRoutine* routine = static_cast<VMPrimitive*>(invokable)->GetRoutine();
+        if (routine->GetDirectArity() < 0)
+            return nullptr;
+        result = routine->InvokeDirect(sp);
+        if (result == nullptr)
+            return nullptr;
+    } else {
+        VMMethod* meth = static_cast<VMMethod*>(invokable);
+        long index = meth->GetTrivialIndex();
+        switch (meth->GetTrivialKind()) {
+            case VMMethod::NOT_TRIVIAL:
+                return nullptr;
+            case VMMethod::TRIVIAL_GETTER:
+                result = static_cast<VMObject*>(receiver)->GetField(index);
+                break;
+            case VMMethod::TRIVIAL_SETTER:
+                static_cast<VMObject*>(receiver)->SetField(index, load_ptr(sp[0]));
+                result = receiver;
+                break;
+            case VMMethod::TRIVIAL_RETURN_LITERAL:
+                result = meth->GetIndexableField(index);
+                break;
+            case VMMethod::TRIVIAL_RETURN_ARGUMENT:
+                result = load_ptr(sp[1 - numberOfArgs + index]);
+                break;
+            default:
+                result = receiver;
+                break;
+        }
+    }
+
+    sp -= numberOfArgs - 1;
+    *sp = _store_ptr(result);
+    return sp;
+}
+
+/*
+ * Emits the templates. Compiled code keeps the frame in rbx, the stack
+ * pointer in r12 and the literals in r13, which are callee-saved, so that
+ * helpers can be called directly. Jumps between templates are relative,
+ * only the dispatch table is referenced absolutely.
+ */
+class Assembler {
+public:
+    vector<uint8_t> code;
+
+    void emit(std::initializer_list<uint8_t> bytes) {
+        code.insert(code.end(), bytes);
+    }
+
+    void emit32(int32_t value) {
+        for (int i = 0; i < 4; ++i)
+            code.push_back((uint8_t) (value >> (8 * i)));
+    }
+
+    void emit64(uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            code.push_back((uint8_t) (value >> (8 * i)));
+    }
+
+    void patch32(size_t position, int32_t value) {
+        for (int i = 0; i < 4; ++i)
+            code[position + i] = (uint8_t) (value >> (8 * i));
+    }
+
+    void patch64(size_t position, uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            code[position + i] = (uint8_t) (value >> (8 * i));
+    }
+
+    // jmp/jcc rel32 to a position patched in later, returns the position
+    // of the displacement
+    size_t jump()              { emit({0xE9});             emit32(0); return code.size() - 4; }
+    size_t jumpIfEqual()       { emit({0x0F, 0x84});       emit32(0); return code.size() - 4; }
+    size_t jumpIfNotEqual()    { emit({0x0F, 0x85});       emit32(0); return code.size() - 4; }
+
+    void bind(size_t displacement, size_t target) {
+        patch32(displacement, (int32_t) (target - (displacement + 4)));
+    }
+
+    void movRaxImm(const void* value) { emit({0x48, 0xB8}); emit64((uint64_t) value); }
+    void movRcxImm(const void* value) { emit({0x48, 0xB9}); emit64((uint64_t) value); }
+    void movEaxImm(int32_t value)     { emit({0xB8}); emit32(value); }
+    void movEsiImm(int32_t value)     { emit({0xBE}); emit32(value); }
+    void movEdxImm(int32_t value)     { emit({0xBA}); emit32(value); }
+    void movEcxImm(int32_t value)     { emit({0xB9}); emit32(value); }
+    void movRdiFrame()                { emit({0x48, 0x89, 0xDF}); }
+    void movRsiStackPointer()         { emit({0x4C, 0x89, 0xE6}); }
+    void movStackPointerRax()         { emit({0x49, 0x89, 0xC4}); }
+
+    void call(const void* function) {
+        movRaxImm(function);
+        emit({0xFF, 0xD0});
+    }
+
+    // rax = frame field, rax = [rax + disp], [rax + disp] = rcx
+    void loadFrameField(int32_t offset) { emit({0x48, 0x8B, 0x83}); emit32(offset); }
+    void loadIndirect(int32_t disp)     { emit({0x48, 0x8B, 0x80}); emit32(disp); }
+    void storeIndirect(int32_t disp)    { emit({0x48, 0x89, 0x88}); emit32(disp); }
+
+    // rax/rdi = literals[index]
+    void loadLiteral(long index)        { emit({0x49, 0x8B, 0x85}); emit32(index * sizeof(gc_oop_t)); }
+    void loadLiteralRdi(long index)     { emit({0x49, 0x8B, 0xBD}); emit32(index * sizeof(gc_oop_t)); }
+
+    // operand stack, with the top element at [r12]
+    void loadTop()  { emit({0x49, 0x8B, 0x04, 0x24}); }
+    void push()     { emit({0x49, 0x83, 0xC4, 0x08, 0x49, 0x89, 0x04, 0x24}); }
+    void drop()     { emit({0x49, 0x83, 0xEC, 0x08}); }
+    void popRax()   { loadTop(); drop(); }
+    void popRcx()   { emit({0x49, 0x8B, 0x0C, 0x24}); drop(); }
+    void popRdx()   { emit({0x49, 0x8B, 0x14, 0x24}); drop(); }
+
+    void testAl()   { emit({0x84, 0xC0}); }
+    void testRax()  { emit({0x48, 0x85, 0xC0}); }
+
+    // compares rax with the object in the given global
+    void compareWithGlobal(const void* global) {
+        movRcxImm(global);
+        emit({0x48, 0x3B, 0x01});
+    }
+
+    // sets the flags for a pending collection
+    void testCollectionTriggered(const bool* flag) {
+        movRaxImm(flag);
+        emit({0x80, 0x38, 0x00});
+    }
+};
+
+CompiledMethod TemplateJIT::Compile(VMMethod* method) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+    const int32_t argumentsOffset = offsetof(VMFrame, arguments);
+    const int32_t localsOffset    = offsetof(VMFrame, locals);
+    const int32_t stackPtrOffset  = offsetof(VMFrame, stack_ptr);
+#pragma GCC diagnostic pop
+
+    long numberOfBytecodes = method->GetNumberOfBytecodes();
+    Assembler as;
+
+    // displacements to bind to the template of a bytecode, or to the exit
+    // that leaves to the interpreter at a bytecode
+    vector<pair<size_t, long>> jumps;
+    map<long, vector<size_t>> exits;
+    vector<long> labels(numberOfBytecodes, -1);
+
+    // entry: save registers, load the state, dispatch on the bytecode index
+    as.emit({0x53, 0x41, 0x54, 0x41, 0x55});
+    as.emit({0x48, 0x89, 0xFB});
+    as.emit({0x49, 0x89, 0xF5});
+    as.emit({0x4C, 0x8B, 0xA3}); as.emit32(stackPtrOffset);
+    as.movRaxImm(nullptr);
+    size_t tablePosition = as.code.size() - 8;
+    as.emit({0xFF, 0x24, 0xD0});
+
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(method->GetBytecode(i))) {
+        labels[i] = as.code.size();
+
+        uint8_t bc = method->GetBytecode(i);
+        long next = i + Bytecode::GetBytecodeLength(bc);
+        uint8_t operand = next - i > 1 ? method->GetBytecode(i + 1) : 0;
+        uint8_t contextLevel = next - i > 2 ? method->GetBytecode(i + 2) : 0;
+
+        switch (bc) {
+            case BC_DUP:
+                as.loadTop();
+                as.push();
+                break;
+
+            case BC_PUSH_LOCAL:
+            case BC_PUSH_ARGUMENT:
+                if (contextLevel == 0) {
+                    as.loadFrameField(bc == BC_PUSH_LOCAL ? localsOffset : argumentsOffset);
+                    as.loadIndirect(operand * sizeof(gc_oop_t));
+                } else {
+                    as.movRdiFrame();
+                    as.movEsiImm(operand);
+                    as.movEdxImm(contextLevel);
+                    as.call((void*) (bc == BC_PUSH_LOCAL ? getLocal : getArgument));
+                }
+                as.push();
+                break;
+
+            case BC_PUSH_FIELD:
+                as.movRdiFrame();
+                as.movEsiImm(operand);
+                as.call((void*) getField);
+                as.push();
+                break;
+
+            case BC_PUSH_CONSTANT:
+                as.loadLiteral(operand);
+                as.push();
+                break;
+
+            case BC_PUSH_GLOBAL:
+                as.loadLiteralRdi(operand);
+                as.call((void*) getGlobal);
+                as.testRax();
+                exits[i].push_back(as.jumpIfEqual());
+                as.push();
+                break;
+
+            case BC_POP:
+                as.drop();
+                break;
+
+            case BC_POP_LOCAL:
+            case BC_POP_ARGUMENT:
+                if (bc == BC_POP_LOCAL && contextLevel == 0) {
+                    as.popRcx();
+                    as.loadFrameField(localsOffset);
+                    as.storeIndirect(operand * sizeof(gc_oop_t));
+                } else {
+                    as.popRcx();
+                    as.movRdiFrame();
+                    as.movEsiImm(operand);
+                    as.movEdxImm(contextLevel);
+                    as.call((void*) (bc == BC_POP_LOCAL ? setLocal : setArgument));
+                }
+                break;
+
+            case BC_POP_FIELD:
+                as.popRdx();
+                as.movRdiFrame();
+                as.movEsiImm(operand);
+                as.call((void*) setField);
+                break;
+
+            case BC_JUMP_IF_FALSE:
+            case BC_JUMP_IF_TRUE:
+            case BC_JUMP: {
+                long target = method->GetBytecode(i + 1)
+                           | (method->GetBytecode(i + 2) << 8)
+                           | (method->GetBytecode(i + 3) << 16)
+                           | (method->GetBytecode(i + 4) << 24);
+                size_t skip = 0;
+                if (bc != BC_JUMP) {
+                    as.popRax();
+                    as.compareWithGlobal(bc == BC_JUMP_IF_FALSE ? &falseObject : &trueObject);
+                    if (target > i) {
+                        jumps.push_back(make_pair(as.jumpIfEqual(), target));
+                        break;
+                    }
+                    skip = as.jumpIfNotEqual();
+                }
+                if (target <= i) {
+                    // back edge, give a pending collection a chance
+                    as.testCollectionTriggered(collectionTriggered);
+                    exits[target].push_back(as.jumpIfNotEqual());
+                }
+                jumps.push_back(make_pair(as.jump(), target));
+                if (skip != 0)
+                    as.bind(skip, as.code.size());
+                break;
+            }
+
+            case BC_SEND_INT_ADD:
+            case BC_SEND_INT_SUB:
+            case BC_SEND_INT_MUL:
+            case BC_SEND_INT_LT:
+            case BC_SEND_INT_EQ:
+            case BC_SEND_FIELD_GET: {
+                void* helper;
+                switch (bc) {
+                    case BC_SEND_INT_ADD: helper = (void*) sendIntAdd;   break;
+                    case BC_SEND_INT_SUB: helper = (void*) sendIntSub;   break;
+                    case BC_SEND_INT_MUL: helper = (void*) sendIntMul;   break;
+                    case BC_SEND_INT_LT:  helper = (void*) sendIntLt;    break;
+                    case BC_SEND_INT_EQ:  helper = (void*) sendIntEq;    break;
+                    default:              helper = (void*) sendFieldGet; break;
+                }
+                as.movRdiFrame();
+                as.movRsiStackPointer();
+                as.movEdxImm(i);
+                as.call(helper);
+                as.testAl();
+                exits[i].push_back(as.jumpIfEqual());
+                if (bc != BC_SEND_FIELD_GET) {
+                    as.drop();
+                    as.testCollectionTriggered(collectionTriggered);
+                    exits[next].push_back(as.jumpIfNotEqual());
+                }
+                break;
+            }
+
+            case BC_SEND: {
+                // sites that missed already are left to the interpreter
+                InlineCache* cache = method->GetInlineCache(i);
+                if (cache == nullptr || cache->GetState() != InlineCache::MONOMORPHIC) {
+                    exits[i].push_back(as.jump());
+                    break;
+                }
+                VMSymbol* signature = static_cast<VMSymbol*>(method->GetConstant(i));
+                as.movRdiFrame();
+                as.movRsiStackPointer();
+                as.movEdxImm(i);
+                as.movEcxImm(Signature::GetNumberOfArguments(signature));
+                as.call((void*) sendMonomorphic);
+                as.testRax();
+                exits[i].push_back(as.jumpIfEqual());
+                as.movStackPointerRax();
+                as.testCollectionTriggered(collectionTriggered);
+                exits[next].push_back(as.jumpIfNotEqual());
+                break;
+            }
+
+            default:
+                // other sends, returns, blocks and halt are left to the
+                // interpreter
+                exits[i].push_back(as.jump());
+                break;
+        }
+    }
+
+    // leave at the bytecode index in eax, with the stack pointer written back
+    size_t leave = as.code.size();
+    as.emit({0x4C, 0x89, 0xA3}); as.emit32(stackPtrOffset);
+    as.emit({0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});
+
+    for (auto& exit : exits) {
+        size_t stub = as.code.size();
+        as.movEaxImm(exit.first);
+        as.bind(as.jump(), leave);
+        for (size_t displacement : exit.second)
+            as.bind(displacement, stub);
+    }
+
+    for (auto& jump : jumps)
+        as.bind(jump.first, labels[jump.second]);
+
+    // the dispatch table follows the code
+    size_t codeSize = PADDED_SIZE(as.code.size());
+    uint8_t* memory = allocate(codeSize + numberOfBytecodes * sizeof(void*));
+    if (memory == nullptr)
+        return nullptr;
+
+    size_t size = codeSize + numberOfBytecodes * sizeof(void*);
+    if (!protect(memory, size, PROT_READ | PROT_WRITE))
+        return nullptr;
+
+    uint8_t** table = (uint8_t**) (memory + codeSize);
+    as.patch64(tablePosition, (uint64_t) table);
+    memcpy(memory, as.code.data(), as.code.size());
+    // frames never stop inside a bytecode, the other entries are not used
+    for (long i = 0; i < numberOfBytecodes; ++i)
+        table[i] = labels[i] < 0 ? memory + leave : memory + labels[i];
+
+    if (!protect(memory, size, PROT_READ | PROT_EXEC))
+        return nullptr;
+    return (CompiledMethod) memory;
+}
+
+#else
+
+bool TemplateJIT::IsSupported() {
+    return false;
+}
+
+CompiledMethod TemplateJIT::Compile(VMMethod* method) {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <vector>
+
+#include <misc/defs.h>
+#include <memory/GenerationalHeap.h>
+#include <vmobjects/ObjectFormats.h>
+#include <vmobjects/VMFrame.h>
+
+/*
+ * Number of invocations and back edges after which a method is compiled.
+ */
+#define JIT_THRESHOLD 1000
+
+/*
+ * Size of the executable chunks compiled code is placed in.
+ */
+#define JIT_CHUNK_SIZE (1024 * 1024)
+
+/*
+ * Entry point of a compiled method. Runs the method on the given frame,
+ * starting at the given bytecode index, and returns the index of the first
+ * bytecode it leaves to the interpreter, with the frame's stack pointer
+ * written back.
+ */
+typedef long (*CompiledMethod)(VMFrame* frame, gc_oop_t* literals, long bytecodeIndex);
+
+/*
+ * Baseline compiler for x86-64 that translates a method by stitching a
+ * machine code template per bytecode.
+ *
+ * Compiled code can be entered at any bytecode, so the interpreter may
+ * switch to it in the middle of an activation, e.g., on a back edge. The
+ * templates cover the stack, variable and jump bytecodes, the quickened
+ * sends, and sends whose inline cache is monomorphic, as long as the cached
+ * target is a trivial method or a primitive with a direct entry. Everything
+ * else, i.e., other sends, returns and block creation, as well as failing
+ * guards and inline cache misses, leaves to the interpreter, which executes
+ * the bytecode with its inline caches and continues in compiled code
+ * afterwards.
+ *
+ * Code is emitted into writable memory, which is made executable instead
+ * once the method is complete.
+ *
+ * The code does not embed heap objects, literals are loaded through the
+ * method on every entry and the well-known objects through their globals,
+ * so the collector does not need to scan or update it. Collections only
+ * happen in the interpreter, so compiled code leaves to it when one is
+ * pending after an allocation or on a back edge.
+ *
+ * Stores into the frame are not guarded by the write barrier, the
+ * interpreter only enters compiled code on frames that are young, or whose
+ * card is dirty already, see CanRunOn().
+ */
+class TemplateJIT {
+public:
+    TemplateJIT(const bool* collectionTriggered);
+    ~TemplateJIT();
+
+    CompiledMethod Compile(VMMethod* method);
+
+    static inline bool CanRunOn(VMFrame* frame);
+    static bool IsSupported();
+
+private:
+    uint8_t* allocate(size_t size);
+    bool     protect(uint8_t* code, size_t size, int protection);
+
+    static gc_oop_t* sendMonomorphic(VMFrame* frame, gc_oop_t* sp, long bytecodeIndex,
+                                     long numberOfArgs);
+
+    const bool* collectionTriggered;
+
+    std::vector<uint8_t*> chunks;
+    uint8_t* top;
+    uint8_t* end;
+};
+
+bool TemplateJIT::CanRunOn(VMFrame* frame) {
+    // a dirty card gets all fields of the frame scanned by the next minor
+    // collection, whichever of them compiled code stores into
+    return gcType != GENERATIONAL
+        || !(frame->GetGCField() & MASK_OBJECT_IS_OLD)
+        || GetHeap<GenerationalHeap>()->IsRemembered(frame);
+}
@@ -45,7 +45,14 @@ const uint8_t Bytecode::bytecodeLengths[] = {
         1, // BC_RETURN_NON_LOCAL
         5, // JUMP_IF_FALSE
         5, // JUMP_IF_TRUE
-        5  // JUMP
+        5, // JUMP
+        2, // BC_SEND_INT_ADD
+        2, // BC_SEND_INT_SUB
+        2, // BC_SEND_INT_MUL
+        2, // BC_SEND_INT_LT
+        2, // BC_SEND_INT_EQ
+        2, // BC_SEND_FIELD_GET
+        2  // BC_SEND_BLOCK
         };
 
 const char* Bytecode::bytecodeNames[] = { "HALT            ",
@@ -54,5 +61,8 @@ const char* Bytecode::bytecodeNames[] = { "HALT            ",
         "PUSH_GLOBAL     ", "POP             ", "POP_LOCAL       ",
         "POP_ARGUMENT    ", "POP_FIELD       ", "SEND            ",
         "SUPER_SEND      ", "RETURN_LOCAL    ", "RETURN_NON_LOCAL",
-        "JUMP_IF_FALSE   ", "JUMP_IF_TRUE    ", "JUMP            " };
+        "JUMP_IF_FALSE   ", "JUMP_IF_TRUE    ", "JUMP            ",
+        "SEND_INT_ADD    ", "SEND_INT_SUB    ", "SEND_INT_MUL    ",
+        "SEND_INT_LT     ", "SEND_INT_EQ     ", "SEND_FIELD_GET  ",
+        "SEND_BLOCK      " };
 
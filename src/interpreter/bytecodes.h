@@ -50,6 +50,18 @@
 #define BC_JUMP_IF_TRUE      17
 #define BC_JUMP              18
 
+// quickened sends, they are never emitted by the compiler but replace a
+// BC_SEND at run time, and fall back to a normal send when their guard fails
+#define BC_SEND_INT_ADD      19
+#define BC_SEND_INT_SUB      20
+#define BC_SEND_INT_MUL      21
+#define BC_SEND_INT_LT       22
+#define BC_SEND_INT_EQ       23
+#define BC_SEND_FIELD_GET    24
+#define BC_SEND_BLOCK        25
+
+#define NUMBER_OF_BYTECODES  26
+
 // bytecode lengths
 
 class Bytecode {
@@ -0,0 +1,67 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "CardTable.h"
+
+#include <sys/mman.h>
+#include <iostream>
+
+#include "../vm/Universe.h"
+
+CardTable::CardTable(const PageAllocator& space) : space(space) {
+    // the space is aligned to huge pages, so cards are aligned to their size
+    start = space.GetStart();
+    size  = space.GetReservedSize() >> CARD_SHIFT;
+    // only the part of the table covering the space handed out is touched
+    cards = (uint8_t*) mmap(nullptr, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (cards == MAP_FAILED) {
+        cout << "Failed to allocate the card table." << endl;
+        GetUniverse()->Quit(-1);
+    }
+}
+
+CardTable::~CardTable() {
+    munmap(cards, size);
+}
+
+size_t CardTable::GetNumberOfCards() const {
+    return (space.GetEnd() - start) >> CARD_SHIFT;
+}
+
+size_t CardTable::NextDirtyCard(size_t from, size_t to) const {
+    while (from < to && from % sizeof(size_t) != 0) {
+        if (cards[from] != CARD_CLEAN)
+            return from;
+        from++;
+    }
+    // most cards are clean, they are skipped a word at a time
+    while (from + sizeof(size_t) <= to && *(const size_t*) (cards + from) == 0)
+        from += sizeof(size_t);
+    while (from < to && cards[from] == CARD_CLEAN)
+        from++;
+    return from;
+}
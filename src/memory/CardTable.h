@@ -0,0 +1,92 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PageAllocator.h"
+
+// a card covers 2^CARD_SHIFT bytes of the mature space
+#define CARD_SHIFT 9
+#define CARD_SIZE ((size_t) 1 << CARD_SHIFT)
+
+#define CARD_CLEAN 0
+#define CARD_DIRTY 1
+
+/*
+ * Remembers which parts of the mature space refer to young objects.
+ *
+ * The mature space is one contiguous range of addresses, and the table has a
+ * mark byte for every card of it, so the write barrier marks a card with a
+ * shift and a store. A store into a field of an old object dirties the card
+ * holding the header of the object, a store into an indexable field of an
+ * array the card holding the field, so that only those parts of large arrays
+ * are scanned. A minor collection scans the objects on dirty cards, and
+ * cleans the cards that do not refer to young objects anymore.
+ */
+class CardTable {
+public:
+    CardTable(const PageAllocator& space);
+    ~CardTable();
+
+    inline void MarkCard(const void* address);
+    inline bool IsDirty(const void* address) const;
+    void CleanCard(size_t card) { cards[card] = CARD_CLEAN; }
+
+    // the first dirty card in [from, to), to if there is none
+    size_t NextDirtyCard(size_t from, size_t to) const;
+
+    // the cards covering the part of the space handed out so far
+    size_t GetNumberOfCards() const;
+    char* GetCardStart(size_t card) const { return start + (card << CARD_SHIFT); }
+    static char* GetCardStart(const void* address) {
+        return (char*) ((size_t) address & ~(CARD_SIZE - 1));
+    }
+
+private:
+    inline size_t cardOf(const void* address) const;
+
+    const PageAllocator& space;
+    char* start;
+    size_t size;
+    uint8_t* cards;
+};
+
+size_t CardTable::cardOf(const void* address) const {
+    assert((size_t) address - (size_t) start < space.GetReservedSize());
+    return ((size_t) address - (size_t) start) >> CARD_SHIFT;
+}
+
+void CardTable::MarkCard(const void* address) {
+    cards[cardOf(address)] = CARD_DIRTY;
+}
+
+bool CardTable::IsDirty(const void* address) const {
+    return cards[cardOf(address)] != CARD_CLEAN;
+}
@@ -1,6 +1,8 @@
 #include "../misc/defs.h"
 
 #include "CopyingHeap.h"
+#include "PagedSpace.h"
+#include "MarkStack.h"
 #include "../vm/Universe.h"
 #include "../vmobjects/AbstractObject.h"
 #include "../vmobjects/VMFrame.h"
@@ -8,9 +10,12 @@
 
 #include "CopyingCollector.h"
 
+// large objects that were marked, but whose fields were not walked yet
+static MarkStack largeObjectsToWalk;
+
 static gc_oop_t copy_if_necessary(gc_oop_t oop) {
     // don't process tagged objects
-    if (IS_TAGGED(oop))
+    if (IS_IMMEDIATE(oop))
         return oop;
     
     AbstractVMObject* obj = AS_OBJ(oop);
@@ -22,6 +27,13 @@ static gc_oop_t copy_if_necessary(gc_oop_t oop) {
     //if someone has moved before, return the moved object
     if (gcField != 0)
         return (gc_oop_t) gcField;
+
+    // large objects stay where they are
+    if (obj->GetObjectSize() >= LARGE_OBJECT_SIZE) {
+        if (PagedSpace::Mark(obj))
+            largeObjectsToWalk.Push(obj);
+        return oop;
+    }
     
     // we have to clone ourselves
     AbstractVMObject* newObj = obj->Clone();
@@ -39,14 +51,25 @@ void CopyingCollector::Collect() {
     //reset collection trigger
     heap->resetGCTrigger();
 
-    static bool increaseMemory;
-    size_t newSize = ((size_t)(heap->currentBufferEnd) -
-            (size_t)(heap->currentBuffer)) * 2;
+    heap->sizing.CollectionStarted();
+    GetUniverse()->GetInterpreter()->ReleaseThreadedCode();
+
+    // the semispaces are resized as the previous collection decided, but
+    // they have to hold everything that might survive this one, including
+    // the objects allocated outside the semispace
+    size_t bufSize = (size_t)(heap->currentBufferEnd) - (size_t)(heap->currentBuffer);
+    size_t used = (size_t)(heap->nextFreePosition) - (size_t)(heap->currentBuffer);
+    size_t newSize = heap->scheduledSize;
+    if (heap->overflowSize > 0 && newSize < bufSize + 2 * heap->overflowSize)
+        newSize = bufSize + 2 * heap->overflowSize;
+    if (newSize != 0 && newSize < used + heap->overflowSize)
+        newSize = used + heap->overflowSize;
+    bool resize = newSize != 0 && newSize != bufSize;
+    heap->scheduledSize = 0;
 
     heap->switchBuffers();
 
-    // increase memory if scheduled in collection before
-    if (increaseMemory) {
+    if (resize) {
         free(heap->currentBuffer);
         heap->currentBuffer = malloc(newSize);
         heap->nextFreePosition = heap->currentBuffer;
@@ -65,27 +88,37 @@ void CopyingCollector::Collect() {
 
     //now copy all objects that are referenced by the objects we have moved so far
     AbstractVMObject* curObject = (AbstractVMObject*)(heap->currentBuffer);
-    while (curObject < heap->nextFreePosition) {
-        curObject->WalkObjects(copy_if_necessary);
-        curObject = (AbstractVMObject*)((size_t)curObject + curObject->GetObjectSize());
+    while (curObject < heap->nextFreePosition || !largeObjectsToWalk.IsEmpty()) {
+        while (curObject < heap->nextFreePosition) {
+            curObject->WalkObjects(copy_if_necessary);
+            curObject = (AbstractVMObject*)((size_t)curObject + curObject->GetObjectSize());
+        }
+        while (!largeObjectsToWalk.IsEmpty())
+            largeObjectsToWalk.Pop()->WalkObjects(copy_if_necessary);
     }
     
-    //increase memory if scheduled in collection before
-    if (increaseMemory) {
-        increaseMemory = false;
+    heap->freeOverflowObjects();
+
+    size_t largeObjectsSize = heap->largeObjects.Sweep();
+    heap->largeObjectsLimit = max(2 * largeObjectsSize,
+            (size_t)(heap->currentBufferEnd) - (size_t)(heap->currentBuffer));
+
+    if (resize) {
         free(heap->oldBuffer);
         heap->oldBuffer = malloc(newSize);
         if (heap->oldBuffer == nullptr)
             GetUniverse()->ErrorExit("unable to allocate more memory");
     }
+    heap->sizing.CollectionFinished();
 
-    // if semispace is still 50% full after collection, we have to realloc
-    //  bigger ones -> done in next collection
-    if ((size_t)(heap->nextFreePosition) - (size_t)(heap->currentBuffer) >=
-            (size_t)(heap->currentBufferEnd) -
-            (size_t)(heap->nextFreePosition)) {
-        increaseMemory = true;
-    }
+    // the collection is triggered at 90% of a semispace, the next one
+    // grows the semispaces to what the sizing policy asks for, and shrinks
+    // them only once they are twice as large as needed
+    size_t survivorsSize = (size_t)(heap->nextFreePosition) - (size_t)(heap->currentBuffer);
+    size_t targetSize = (size_t)(heap->sizing.NextLimit(survivorsSize) / 0.9);
+    size_t currentSize = (size_t)(heap->currentBufferEnd) - (size_t)(heap->currentBuffer);
+    if (targetSize > currentSize || targetSize < currentSize / 2)
+        heap->scheduledSize = targetSize;
 
     Timer::GCTimer->Halt();
 }
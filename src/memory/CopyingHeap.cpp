@@ -4,7 +4,8 @@
 #include "../vmobjects/AbstractObject.h"
 #include "../vm/Universe.h"
 
-CopyingHeap::CopyingHeap(long objectSpaceSize) : Heap<CopyingHeap>(new CopyingCollector(this), objectSpaceSize) {
+CopyingHeap::CopyingHeap(long objectSpaceSize) : Heap<CopyingHeap>(new CopyingCollector(this), objectSpaceSize),
+        largeObjects(&largeObjectPages), sizing(objectSpaceSize * 0.9) {
     size_t bufSize = objectSpaceSize;
     currentBuffer = malloc(bufSize);
     oldBuffer = malloc(bufSize);
@@ -14,6 +15,9 @@ CopyingHeap::CopyingHeap(long objectSpaceSize) : Heap<CopyingHeap>(new CopyingCo
     collectionLimit = (void*)((size_t)currentBuffer + ((size_t)(bufSize *
                             0.9)));
     nextFreePosition = currentBuffer;
+    overflowSize = 0;
+    scheduledSize = 0;
+    largeObjectsLimit = bufSize;
 }
 
 void CopyingHeap::switchBuffers() {
@@ -28,14 +32,50 @@ void CopyingHeap::switchBuffers() {
 }
 
 AbstractVMObject* CopyingHeap::AllocateObject(size_t size) {
+    if (unlikely(size >= LARGE_OBJECT_SIZE))
+        return allocateLargeObject(size);
+    if (unlikely((size_t)nextFreePosition + size > (size_t)currentBufferEnd))
+        return allocateOverflowObject(size);
+
     AbstractVMObject* newObject = (AbstractVMObject*) nextFreePosition;
     nextFreePosition = (void*)((size_t)nextFreePosition + size);
-    if (nextFreePosition > currentBufferEnd) {
-        cout << "Failed to allocate " << size << " Bytes." << endl;
-        GetUniverse()->Quit(-1);
-    }
     //let's see if we have to trigger the GC
     if (nextFreePosition > collectionLimit)
         triggerGC();
     return newObject;
 }
+
+AbstractVMObject* CopyingHeap::allocateLargeObject(size_t size) {
+    AbstractVMObject* newObject = largeObjects.Allocate(size);
+    if (largeObjects.GetUsedBytes() > largeObjectsLimit)
+        triggerGC();
+    return newObject;
+}
+
+/*
+ * Slow path for allocations that do not fit into the semispace anymore before
+ * the interpreter reaches its next safepoint. The object gets a block of its
+ * own, which the next collection copies into the semispace like any other
+ * live object, and frees afterwards.
+ *
+ * TODO: collect here instead, once the primitives and the compiler register
+ * the objects they hold across allocations as roots.
+ */
+AbstractVMObject* CopyingHeap::allocateOverflowObject(size_t size) {
+    void* newObject = malloc(size);
+    if (newObject == nullptr)
+        GetUniverse()->ErrorExit("unable to allocate more memory");
+    memset(newObject, 0x0, size);
+    overflowObjects.push_back(newObject);
+    overflowSize += size;
+    triggerGC();
+    return (AbstractVMObject*) newObject;
+}
+
+void CopyingHeap::freeOverflowObjects() {
+    for (vector<void*>::iterator it = overflowObjects.begin();
+         it != overflowObjects.end(); ++it)
+        free(*it);
+    overflowObjects.clear();
+    overflowSize = 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Heap.h"
+#include "HeapSizing.h"
+#include "LargeObjectSpace.h"
 #include <string.h>
 
 class CopyingHeap : public Heap<CopyingHeap> {
@@ -15,4 +17,21 @@ private:
     void* currentBufferEnd;
     void switchBuffers(void);
     void* nextFreePosition;
+
+    AbstractVMObject* allocateLargeObject(size_t size);
+    // large objects are never copied, but marked in place and swept
+    PageAllocator largeObjectPages;
+    LargeObjectSpace largeObjects;
+    // size the large objects may grow to before they trigger a collection
+    size_t largeObjectsLimit;
+
+    AbstractVMObject* allocateOverflowObject(size_t size);
+    void freeOverflowObjects();
+    // allocated by allocateOverflowObject() since the last collection
+    vector<void*> overflowObjects;
+    size_t overflowSize;
+
+    HeapSizing sizing;
+    // size of the semispaces after the next collection, 0 to keep it
+    size_t scheduledSize;
 };
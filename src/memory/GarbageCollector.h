@@ -35,7 +35,8 @@ public:
     GarbageCollector(HEAP_T* h) : heap(h) {}
     virtual ~GarbageCollector() {}
     virtual void Collect() = 0;
-    void PrintGCStat() const;
+    // prints collector specific statistics when the VM shuts down
+    virtual void PrintGCStat() const {}
     void PrintCollectStat() const;
 protected:
     HEAP_T* const heap;
@@ -3,9 +3,12 @@
 #include "GenerationalCollector.h"
 
 #include "Heap.h"
+#include "MarkStack.h"
+#include "ParallelMarker.h"
 #include "../vm/Universe.h"
 #include "../vmobjects/VMMethod.h"
 #include "../vmobjects/VMObject.h"
+#include "../vmobjects/VMArray.h"
 #include "../vmobjects/VMSymbol.h"
 #include "../vmobjects/VMFrame.h"
 #include "../vmobjects/VMBlock.h"
@@ -16,32 +19,51 @@
 
 #define INITIAL_MAJOR_COLLECTION_THRESHOLD (5 * 1024 * 1024) //5 MB
 
-GenerationalCollector::GenerationalCollector(GenerationalHeap* heap) : GarbageCollector(heap) {
+// an adaptive nursery does not grow beyond this, or half of the -Xmx heap
+#define MAX_ADAPTIVE_NURSERY_SIZE (256 * 1024 * 1024)
+// and it only shrinks if less than this part of eden survives
+#define LOW_SURVIVAL_RATE 0.05
+
+GenerationalCollector::GenerationalCollector(GenerationalHeap* heap) : GarbageCollector(heap),
+        minorSizing(0), majorSizing(INITIAL_MAJOR_COLLECTION_THRESHOLD) {
     majorCollectionThreshold = INITIAL_MAJOR_COLLECTION_THRESHOLD;
+    pendingNurserySize = 0;
+    survivalRate = 0.0;
     matureObjectsSize = 0;
+    cardsScanned = 0;
+    cardScanTime = 0;
+    overflowObjects = 0;
 }
 
+// objects that are marked or promoted, but whose fields have not been walked yet
+static MarkStack markStack;
+
 static gc_oop_t mark_object(gc_oop_t oop) {
     // don't process tagged objects
-    if (IS_TAGGED(oop))
+    if (IS_IMMEDIATE(oop))
         return oop;
     
     AbstractVMObject* obj = AS_OBJ(oop);
     assert(Universe::IsValidObject(obj));
     
 
-    if (obj->GetGCField() & MASK_OBJECT_IS_MARKED)
+    // the minor collection before promoted all young objects
+    assert(!GetHeap<GenerationalHeap>()->isObjectInNursery(obj));
+
+    if (!PagedSpace::Mark(obj))
         return oop;
 
-    obj->SetGCField(MASK_OBJECT_IS_OLD | MASK_OBJECT_IS_MARKED);
-    obj->WalkObjects(&mark_object);
+    markStack.Push(obj);
     
     return oop;
 }
 
+// objects surviving more minor collections than this are promoted
+static long tenuringAge;
+
 static gc_oop_t copy_if_necessary(gc_oop_t oop) {
     // don't process tagged objects
-    if (IS_TAGGED(oop))
+    if (IS_IMMEDIATE(oop))
         return oop;
     
     AbstractVMObject* obj = AS_OBJ(oop);
@@ -56,11 +78,21 @@ static gc_oop_t copy_if_necessary(gc_oop_t oop) {
 
     // GCField is abused as forwarding pointer here
     // if someone has moved before, return the moved object
-    if (gcField != 0)
+    if (gcField > MASK_BITS_ALL)
         return (gc_oop_t) gcField;
+
+    // a field that is visited twice, e.g., of an object spanning two dirty
+    // cards, refers to the copy already
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    if (heap->isObjectInToSpace(obj))
+        return oop;
     
-    // we have to clone ourselves
+    // we have to clone ourselves, either into the survivor space or, once
+    // the object is old enough, into the mature space
+    long age = ((gcField & MASK_OBJECT_AGE) >> OBJECT_AGE_SHIFT) + 1;
+    heap->cloneIntoSurvivorSpace = age <= tenuringAge;
     AbstractVMObject* newObj = obj->Clone();
+    heap->cloneIntoSurvivorSpace = false;
 
     if (DEBUG)
         obj->MarkObjectAsInvalid();
@@ -69,71 +101,231 @@ static gc_oop_t copy_if_necessary(gc_oop_t oop) {
     assert( obj->GetObjectSize() == newObj->GetObjectSize());
     
     obj->SetGCField((size_t) newObj);
-    newObj->SetGCField(MASK_OBJECT_IS_OLD);
+    if (heap->isObjectInNursery(newObj))
+        newObj->SetGCField(age << OBJECT_AGE_SHIFT);
+    else
+        newObj->SetGCField(MASK_OBJECT_IS_OLD);
 
-    // walk recursively
-    newObj->WalkObjects(copy_if_necessary);
+    // its fields are updated later by scanCopiedObjects()
+    markStack.Push(newObj);
     
 #warning not sure about the use of _store_ptr here, or whether it should be a plain cast
     return _store_ptr(newObj);
 }
 
-void GenerationalCollector::MinorCollection() {
+// set while old objects are walked, if one of their fields is still young
+static bool refersToYoungObject;
+
+static gc_oop_t copy_and_check(gc_oop_t oop) {
+    gc_oop_t result = copy_if_necessary(oop);
+    if (!IS_IMMEDIATE(result) &&
+        GetHeap<GenerationalHeap>()->isObjectInNursery(AS_OBJ(result)))
+        refersToYoungObject = true;
+    return result;
+}
+
+// Old objects that still point to survivors after their fields are updated
+// have to be remembered, so their cards are marked like by the write barrier.
+static void scanOldObject(AbstractVMObject* obj) {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    VMArray* array = PagedSpace::IsLargeObject(obj) ? dynamic_cast<VMArray*>(obj)
+                                                   : nullptr;
+    if (array == nullptr) {
+        refersToYoungObject = false;
+        obj->WalkObjects(copy_and_check);
+        if (refersToYoungObject)
+            heap->Remember(obj);
+        return;
+    }
+
+    // large arrays are remembered card by card
+    char* end = (char*) obj + obj->GetObjectSize();
+    for (char* card = CardTable::GetCardStart(obj); card < end; card += CARD_SIZE) {
+        refersToYoungObject = false;
+        array->WalkObjectsOnCard(copy_and_check, card, card + CARD_SIZE);
+        if (refersToYoungObject)
+            heap->Remember(card);
+    }
+}
+
+// Walks all objects that were copied but not scanned yet. Mature objects
+// are allocated individually, so there is no contiguous to-space that could
+// be scanned Cheney-style, the mark stack serves as the scan queue instead.
+static void scanCopiedObjects(GenerationalHeap* heap) {
+    while (!markStack.IsEmpty()) {
+        AbstractVMObject* obj = markStack.Pop();
+        if (heap->isObjectInNursery(obj))
+            obj->WalkObjects(copy_if_necessary);
+        else
+            scanOldObject(obj);
+    }
+}
+
+void GenerationalCollector::MinorCollection(bool tenureAll) {
+    tenuringAge = tenureAll ? 0 : GenerationalHeap::maxTenuringAge;
+    size_t edenUsed = (size_t)heap->nextFreePosition - (size_t)heap->nursery;
+    size_t matureSizeBefore = heap->matureObjectsSize;
+    heap->flipSurvivorSpaces();
+
+    // objects that did not fit into eden are old from now on, and may refer
+    // to young objects without having passed the write barrier
+    for (vector<size_t>::iterator objIter = heap->overflowObjects.begin();
+         objIter != heap->overflowObjects.end();
+         objIter++) {
+        ((AbstractVMObject*)(*objIter))->SetGCField(MASK_OBJECT_IS_OLD);
+    }
+
     // walk all globals of universe, and implicily the interpreter
     GetUniverse()->WalkGlobals(&copy_if_necessary);
+    scanCopiedObjects(heap);
 
-    // and also all objects that have been detected by the write barriers
-    for (vector<size_t>::iterator objIter =
-            heap->oldObjsWithRefToYoungObjs->begin();
-         objIter != heap->oldObjsWithRefToYoungObjs->end();
+    // the fields of the overflow objects are walked once all of them are old
+    for (vector<size_t>::iterator objIter = heap->overflowObjects.begin();
+         objIter != heap->overflowObjects.end();
          objIter++) {
-        // content of oldObjsWithRefToYoungObjs is not altered while iteration,
-        // because copy_if_necessary returns old objs only -> ignored by
-        // write_barrier
-        AbstractVMObject* obj = (AbstractVMObject*)(*objIter);
-        obj->SetGCField(MASK_OBJECT_IS_OLD);
-        obj->WalkObjects(&copy_if_necessary);
+        scanOldObject((AbstractVMObject*)(*objIter));
+        scanCopiedObjects(heap);
     }
-    heap->oldObjsWithRefToYoungObjs->clear();
+    overflowObjects += heap->overflowObjects.size();
+    heap->overflowObjects.clear();
+
+    // and also all objects on cards that have been marked by the write barriers
+    scanDirtyCards();
     heap->nextFreePosition = heap->nursery;
+
+    size_t survived = ((size_t)heap->toSpaceFree - (size_t)heap->toSpace)
+                    + (heap->matureObjectsSize - matureSizeBefore);
+    survivalRate = edenUsed > 0 ? (double) survived / edenUsed : 0.0;
+}
+
+/*
+ * Cards of objects promoted by this collection may become dirty while the
+ * table is scanned. They are scanned as well if they come after the current
+ * card, and otherwise stay dirty until the next minor collection, which is
+ * correct either way, since the objects are scanned when they are promoted.
+ */
+void GenerationalCollector::scanDirtyCards() {
+    int64_t start = get_microseconds();
+    CardTable& cardTable = heap->cardTable;
+    size_t numberOfCards = cardTable.GetNumberOfCards();
+
+    for (size_t card = cardTable.NextDirtyCard(0, numberOfCards);
+         card < numberOfCards;
+         card = cardTable.NextDirtyCard(card + 1, numberOfCards)) {
+        cardTable.CleanCard(card);
+        scanCard(card);
+        scanCopiedObjects(heap);
+        cardsScanned++;
+    }
+
+    cardScanTime += get_microseconds() - start;
+}
+
+// walks the old objects with fields on the card, the card stays dirty as
+// long as they refer to survivors
+void GenerationalCollector::scanCard(size_t card) {
+    char* start = heap->cardTable.GetCardStart(card);
+    char* end   = start + CARD_SIZE;
+    Page* page  = heap->matureSpace.GetPageAllocator().PageOf(start);
+    if (page == nullptr)
+        return;
+
+    refersToYoungObject = false;
+    if (page->numberOfCells == 1) {
+        // a large object, only arrays are remembered by the cards of their
+        // fields, other objects by the card of their header
+        AbstractVMObject* obj = (AbstractVMObject*) page->cells;
+        if (obj->GetGCField() & MASK_OBJECT_IS_OLD) {
+            VMArray* array = dynamic_cast<VMArray*>(obj);
+            if (array != nullptr)
+                array->WalkObjectsOnCard(copy_and_check, start, end);
+            else if ((char*) obj >= start && (char*) obj < end)
+                obj->WalkObjects(copy_and_check);
+        }
+    } else {
+        // every cell overlapping the card, free cells and young objects
+        // allocated outside eden are not old
+        size_t first = start > page->cells ? (start - page->cells) / page->cellSize : 0;
+        for (size_t i = first; i < page->numberOfCells; i++) {
+            AbstractVMObject* obj = (AbstractVMObject*) (page->cells + i * page->cellSize);
+            if ((char*) obj >= end)
+                break;
+            if (obj->GetGCField() & MASK_OBJECT_IS_OLD)
+                obj->WalkObjects(copy_and_check);
+        }
+    }
+
+    if (refersToYoungObject)
+        heap->cardTable.MarkCard(start);
 }
 
 void GenerationalCollector::MajorCollection() {
     // first we have to mark all objects (globals and current frame recursively)
-    GetUniverse()->WalkGlobals(&mark_object);
-
-    //now that all objects are marked we can safely delete all allocated objects that are not marked
-    vector<AbstractVMObject*>* survivors = new vector<AbstractVMObject*>();
-    for (vector<AbstractVMObject*>::iterator objIter =
-            heap->allocatedObjects->begin(); objIter !=
-            heap->allocatedObjects->end(); objIter++) {
-        
-        AbstractVMObject* obj = *objIter;
-        assert(Universe::IsValidObject(obj));
-        
-        if (obj->GetGCField() & MASK_OBJECT_IS_MARKED) {
-            survivors->push_back(obj);
-            obj->SetGCField(MASK_OBJECT_IS_OLD);
-        }
-        else {
-            heap->FreeObject(obj);
+    if (ParallelMarker::numberOfThreads > 1)
+        ParallelMarker::MarkReachableObjects();
+    else {
+        GetUniverse()->WalkGlobals(&mark_object);
+        while (!markStack.IsEmpty()) {
+            markStack.Pop()->WalkObjects(&mark_object);
         }
     }
-    delete heap->allocatedObjects;
-    heap->allocatedObjects = survivors;
+
+    //now that all objects are marked we can safely free all objects that are not marked
+    heap->matureObjectsSize = heap->matureSpace.Sweep();
+}
+
+void GenerationalCollector::adaptNurserySize() {
+    size_t size = heap->nurserySize;
+    size_t maxSize = HeapSizing::maxHeapSize != 0 ? HeapSizing::maxHeapSize / 2
+                                                  : MAX_ADAPTIVE_NURSERY_SIZE;
+
+    // a larger nursery needs fewer minor collections, and gives more young
+    // objects the time to die before they are copied
+    if (minorSizing.IsOverTarget() && size * 2 <= maxSize)
+        pendingNurserySize = size * 2;
+    else if (minorSizing.IsUnderTarget() && survivalRate < LOW_SURVIVAL_RATE
+             && size / 2 >= heap->initialNurserySize)
+        pendingNurserySize = size / 2;
+}
+
+void GenerationalCollector::PrintGCStat() const {
+    cout << "Nursery size: " << heap->nurserySize / 1024 << " KB, "
+         << "major collection threshold: " << majorCollectionThreshold / 1024
+         << " KB" << endl;
+    cout << "Objects allocated outside eden: " << overflowObjects << endl;
+    cout << "Write barrier hits: " << heap->writeBarrierHits << endl;
+    cout << "Dirty cards scanned: " << cardsScanned << " in ["
+         << cardScanTime / 1000.0 << "] msec" << endl;
 }
 
 void GenerationalCollector::Collect() {
     Timer::GCTimer->Resume();
     //reset collection trigger
     heap->resetGCTrigger();
+    minorSizing.CollectionStarted();
+    GetUniverse()->GetInterpreter()->ReleaseThreadedCode();
 
-    MinorCollection();
-    if (heap->matureObjectsSize > majorCollectionThreshold)
+    // a major collection only looks at mature objects, so all young objects
+    // are promoted by the minor collection preceding it, as they are before
+    // the nursery is resized
+    bool major = heap->matureObjectsSize > majorCollectionThreshold;
+    MinorCollection(major || pendingNurserySize != 0);
+    if (major)
     {
+        majorSizing.CollectionStarted();
         MajorCollection();
-        majorCollectionThreshold = 2 * heap->matureObjectsSize;
-
+        majorSizing.CollectionFinished();
+        majorCollectionThreshold = majorSizing.NextLimit(heap->matureObjectsSize);
     }
+
+    minorSizing.CollectionFinished();
+
+    // resizing is not counted as collection time, a larger nursery would
+    // otherwise look like more overhead and grow even further
+    if (pendingNurserySize != 0) {
+        heap->resizeNursery(pendingNurserySize);
+        pendingNurserySize = 0;
+    } else if (HeapSizing::nurserySize == 0)
+        adaptNurserySize();
     Timer::GCTimer->Halt();
 }
@@ -3,15 +3,35 @@
 #include "../misc/defs.h"
 
 #include "GarbageCollector.h"
+#include "HeapSizing.h"
 
 class GenerationalHeap;
 class GenerationalCollector : public GarbageCollector<GenerationalHeap> {
 public:
     GenerationalCollector(GenerationalHeap* heap);
     void Collect();
+    void PrintGCStat() const;
 private:
     intptr_t majorCollectionThreshold;
     size_t matureObjectsSize;
     void MajorCollection();
-    void MinorCollection();
+    void MinorCollection(bool tenureAll);
+    void scanDirtyCards();
+    void scanCard(size_t card);
+    void adaptNurserySize();
+
+    HeapSizing minorSizing;
+    HeapSizing majorSizing;
+
+    // the nursery is resized by the next collection, 0 if it keeps its size
+    size_t pendingNurserySize;
+    // bytes surviving the last minor collection, relative to the eden used
+    double survivalRate;
+
+    // card scanning statistics, the time is in microseconds
+    long    cardsScanned;
+    int64_t cardScanTime;
+
+    // objects that had to be allocated outside eden
+    long overflowObjects;
 };
@@ -2,6 +2,7 @@
 #include "GenerationalHeap.h"
 #include "GenerationalCollector.h"
 #include "../vmobjects/AbstractObject.h"
+#include "../vmobjects/IntegerBox.h"
 #include "../vm/Universe.h"
 
 #include <string.h>
@@ -9,52 +10,115 @@
 
 using namespace std;
 
-GenerationalHeap::GenerationalHeap(long objectSpaceSize) : Heap<GenerationalHeap>(new GenerationalCollector(this), objectSpaceSize) {
-    //our initial collection limit is 90% of objectSpaceSize
-    //collectionLimit = objectSpaceSize * 0.9;
+long GenerationalHeap::survivorRatio  = DEFAULT_SURVIVOR_RATIO;
+long GenerationalHeap::maxTenuringAge = DEFAULT_MAX_TENURING_AGE;
 
-    nursery = malloc(objectSpaceSize);
-    nurserySize = objectSpaceSize;
-    maxNurseryObjSize = objectSpaceSize / 2;
-    nursery_end = (size_t)nursery + nurserySize;
+GenerationalHeap::GenerationalHeap(long objectSpaceSize) : Heap<GenerationalHeap>(new GenerationalCollector(this), objectSpaceSize),
+        cardTable(matureSpace.GetPageAllocator()) {
+    // -Xmn fixes the size of the nursery, otherwise it starts out with the
+    // heap size and is adapted by the collector
+    nursery = nullptr;
+    setupNursery(HeapSizing::nurserySize != 0 ? HeapSizing::nurserySize
+                                              : objectSpaceSize);
+    initialNurserySize = nurserySize;
+    cloneIntoSurvivorSpace = false;
     matureObjectsSize = 0;
-    memset(nursery, 0x0, objectSpaceSize);
-    collectionLimit = (void*)((size_t)nursery + ((size_t)(objectSpaceSize *
-                            0.9)));
+    writeBarrierHits = 0;
+}
+
+void GenerationalHeap::setupNursery(size_t size) {
+    free(nursery);
+    nursery = malloc(size);
+    if (nursery == nullptr)
+        GetUniverse()->ErrorExit("unable to allocate the nursery");
+    nurserySize = size;
+    nursery_end = (size_t)nursery + nurserySize;
+
+    // eden at the start of the nursery, followed by the two survivor spaces
+    survivorSpaceSize = (size / (survivorRatio + 2)) & ~(sizeof(void*) - 1);
+    size_t edenSize = nurserySize - 2 * survivorSpaceSize;
+    eden_end    = (size_t)nursery + edenSize;
+    fromSpace   = (void*) eden_end;
+    toSpace     = (void*)(eden_end + survivorSpaceSize);
+    toSpaceFree = toSpace;
+
+    maxNurseryObjSize = edenSize / 2;
+    memset(nursery, 0x0, size);
+    //our initial collection limit is 90% of eden
+    collectionLimit = (void*)((size_t)nursery + ((size_t)(edenSize * 0.9)));
     nextFreePosition = nursery;
-    allocatedObjects = new vector<AbstractVMObject*>();
-    oldObjsWithRefToYoungObjs = new vector<size_t>();
 }
 
-AbstractVMObject* GenerationalHeap::AllocateNurseryObject(size_t size) {
-    AbstractVMObject* newObject = (AbstractVMObject*) nextFreePosition;
-    nextFreePosition = (void*)((size_t)nextFreePosition + size);
-    if ((size_t)nextFreePosition > nursery_end) {
-        cout << "Failed to allocate " << size << " Bytes in nursery." << endl;
-        GetUniverse()->Quit(-1);
+static gc_oop_t check_not_in_nursery(gc_oop_t oop) {
+    if (!IS_IMMEDIATE(oop) &&
+        GetHeap<GenerationalHeap>()->isObjectInNursery(AS_OBJ(oop)))
+        GetUniverse()->ErrorExit("reference into the nursery that is resized");
+    return oop;
+}
+
+static void check_old_cell(AbstractVMObject* obj) {
+    if (obj->GetGCField() & MASK_OBJECT_IS_OLD)
+        obj->WalkObjects(check_not_in_nursery);
+}
+
+// only possible while the nursery is empty, i.e., right after all young
+// objects were promoted. The old nursery is freed, so debug builds also make
+// sure that neither the globals nor any old object still refer to it.
+void GenerationalHeap::resizeNursery(size_t size) {
+    if (toSpaceFree != toSpace || !overflowObjects.empty())
+        GetUniverse()->ErrorExit("the nursery is resized while it holds objects");
+    if (DEBUG) {
+        GetUniverse()->WalkGlobals(check_not_in_nursery);
+        matureSpace.WalkCells(check_old_cell);
     }
-    //let's see if we have to trigger the GC
-    if (nextFreePosition > collectionLimit)
-        triggerGC();
+    setupNursery(size);
+}
+
+/*
+ * Slow path for allocations that do not fit into eden anymore, because more
+ * was allocated between two safepoints of the interpreter than the collection
+ * limit leaves room for. Collecting right here is not possible, since the
+ * callers hold unrooted pointers, so the object is allocated in the mature
+ * space instead. It is constructed as a young object, and only becomes old
+ * at the next minor collection, which also scans its fields like those of an
+ * object on a dirty card.
+ *
+ * TODO: collect here instead, once the primitives and the compiler register
+ * the objects they hold across allocations as roots.
+ */
+AbstractVMObject* GenerationalHeap::allocateOverflowObject(size_t size) {
+    AbstractVMObject* newObject = matureSpace.Allocate(size);
+    matureObjectsSize += size;
+    overflowObjects.push_back((size_t)newObject);
+    triggerGC();
     return newObject;
 }
 
 AbstractVMObject* GenerationalHeap::AllocateMatureObject(size_t size) {
-    AbstractVMObject* newObject = (AbstractVMObject*) malloc(size);
-    if (newObject == nullptr) {
-        cout << "Failed to allocate " << size << " Bytes." << endl;
-        GetUniverse()->Quit(-1);
+    // Clone() asks for a mature object, but during a minor collection an
+    // object that is not old enough yet is copied into the survivor space
+    if (cloneIntoSurvivorSpace) {
+        AbstractVMObject* survivor = AllocateSurvivorObject(size);
+        if (survivor != nullptr)
+            return survivor;
     }
-    allocatedObjects->push_back(newObject);
+
+    AbstractVMObject* newObject = matureSpace.Allocate(size);
     matureObjectsSize += size;
     return newObject;
 }
 
-void GenerationalHeap::writeBarrier_OldHolder(AbstractVMObject* holder,
-                                              const vm_oop_t referencedObject) {
-    if (isObjectInNursery(referencedObject)) {
-        oldObjsWithRefToYoungObjs->push_back((size_t)holder);
-        holder->SetGCField(holder->GetGCField() | MASK_SEEN_BY_WRITE_BARRIER);
-    }
+AbstractVMObject* GenerationalHeap::AllocateSurvivorObject(size_t size) {
+    if ((size_t)toSpaceFree + size > (size_t)toSpace + survivorSpaceSize)
+        return nullptr;
+    AbstractVMObject* newObject = (AbstractVMObject*) toSpaceFree;
+    toSpaceFree = (void*)((size_t)toSpaceFree + size);
+    return newObject;
 }
 
+void GenerationalHeap::flipSurvivorSpaces() {
+    void* tmp   = fromSpace;
+    fromSpace   = toSpace;
+    toSpace     = tmp;
+    toSpaceFree = toSpace;
+}
@@ -5,65 +5,144 @@
 
 
 #include "Heap.h"
+#include "CardTable.h"
+#include "PagedSpace.h"
+#include "HeapSizing.h"
 #include "../vmobjects/VMObjectBase.h"
 
 #include <vm/Universe.h>
 
 #ifdef UNITTESTS
 struct VMObjectCompare {
-    bool operator() (pair<vm_oop_t, vm_oop_t> lhs,
-                     pair<vm_oop_t, vm_oop_t> rhs) const
+    bool operator() (const pair<AbstractVMObject*, vm_oop_t>& lhs,
+                     const pair<AbstractVMObject*, vm_oop_t>& rhs) const
     {   return (size_t) lhs.first < (size_t) rhs.first
             && (size_t) lhs.second < (size_t) rhs.second;
     }
 };
 #endif
 
+#define DEFAULT_SURVIVOR_RATIO 8
+#define DEFAULT_MAX_TENURING_AGE 3
+
+/*
+ * The nursery is divided into eden, where new objects are allocated, and two
+ * survivor spaces of equal size. A minor collection copies live young objects
+ * into the empty survivor space, and only promotes them to the mature space
+ * once they have survived maxTenuringAge minor collections, or when the
+ * survivor space is full.
+ */
 class GenerationalHeap : public Heap<GenerationalHeap> {
     friend class GenerationalCollector;
 public:
     GenerationalHeap(long objectSpaceSize = 1048576);
-    AbstractVMObject* AllocateNurseryObject(size_t size);
+    inline AbstractVMObject* AllocateNurseryObject(size_t size);
     AbstractVMObject* AllocateMatureObject(size_t size);
+    AbstractVMObject* AllocateSurvivorObject(size_t size);
     size_t GetMaxNurseryObjectSize();
     void writeBarrier(AbstractVMObject* holder, vm_oop_t referencedObject);
+    void writeBarrierArray(VMArray* holder, gc_oop_t* field, vm_oop_t referencedObject);
+    // whether stores into the fields of obj are remembered already
+    bool IsRemembered(AbstractVMObject* obj) const { return cardTable.IsDirty(obj); }
+    // marks the card of address, like the write barrier
+    void Remember(const void* address) { cardTable.MarkCard(address); }
     inline bool isObjectInNursery(vm_oop_t obj);
+    inline bool isObjectInToSpace(AbstractVMObject* obj);
 #ifdef UNITTESTS
     std::set< pair<AbstractVMObject*, vm_oop_t>, VMObjectCompare > writeBarrierCalledOn;
 #endif
+
+    // eden is survivorRatio times the size of one survivor space
+    static long survivorRatio;
+    static long maxTenuringAge;
+
+    // set by the collector while it clones an object that stays young
+    bool cloneIntoSurvivorSpace;
 private:
+    void flipSurvivorSpaces();
+    void setupNursery(size_t size);
+    void resizeNursery(size_t size);
+
+    // nursery covers eden and both survivor spaces
     void* nursery;
     size_t nursery_end;
     size_t nurserySize;
+    size_t initialNurserySize;
+    size_t eden_end;
+    size_t survivorSpaceSize;
+    void* toSpace;
+    void* toSpaceFree;
+    void* fromSpace;
     size_t maxNurseryObjSize;
     size_t matureObjectsSize;
     void* nextFreePosition;
-    void writeBarrier_OldHolder(AbstractVMObject* holder, const vm_oop_t
-            referencedObject);
+    AbstractVMObject* allocateOverflowObject(size_t size);
+    // allocated by allocateOverflowObject() since the last minor collection
+    vector<size_t> overflowObjects;
     void* collectionLimit;
-    vector<size_t>* oldObjsWithRefToYoungObjs;
-    vector<AbstractVMObject*>* allocatedObjects;
+    // number of stores of young objects into old ones
+    long writeBarrierHits;
+    PagedSpace matureSpace;
+    // covers matureSpace, so it is declared after it
+    CardTable cardTable;
 };
 
 inline bool GenerationalHeap::isObjectInNursery(vm_oop_t obj) {
     assert(Universe::IsValidObject(obj));
     
-    return (size_t) obj >= (size_t)nursery && (size_t) obj < nursery_end;
+    return ((size_t) obj - (size_t) nursery) < nurserySize;
+}
+
+// the survivors copied by the current minor collection
+inline bool GenerationalHeap::isObjectInToSpace(AbstractVMObject* obj) {
+    return ((size_t) obj - (size_t) toSpace) < ((size_t) toSpaceFree - (size_t) toSpace);
 }
 
 inline size_t GenerationalHeap::GetMaxNurseryObjectSize() {
     return maxNurseryObjSize;
 }
 
+inline AbstractVMObject* GenerationalHeap::AllocateNurseryObject(size_t size) {
+    if (unlikely((size_t)nextFreePosition + size > eden_end))
+        return allocateOverflowObject(size);
+
+    AbstractVMObject* newObject = (AbstractVMObject*) nextFreePosition;
+    nextFreePosition = (void*)((size_t)nextFreePosition + size);
+    //let's see if we have to trigger the GC
+    if (nextFreePosition > collectionLimit)
+        triggerGC();
+    return newObject;
+}
+
 inline void GenerationalHeap::writeBarrier(AbstractVMObject* holder, vm_oop_t referencedObject) {
 #ifdef UNITTESTS
     writeBarrierCalledOn.insert(make_pair(holder, referencedObject));
 #endif
     
+    assert(gcType == GENERATIONAL);
+    assert(Universe::IsValidObject(referencedObject));
+    assert(Universe::IsValidObject((vm_oop_t) holder));
+
+    size_t gcfield = *(((size_t*)holder)+1);
+    if ((gcfield & MASK_OBJECT_IS_OLD) && isObjectInNursery(referencedObject)) {
+        ++writeBarrierHits;
+        cardTable.MarkCard(holder);
+    }
+}
+
+inline void GenerationalHeap::writeBarrierArray(VMArray* holder, gc_oop_t* field, vm_oop_t referencedObject) {
+#ifdef UNITTESTS
+    writeBarrierCalledOn.insert(make_pair((AbstractVMObject*) holder, referencedObject));
+#endif
+
+    assert(gcType == GENERATIONAL);
     assert(Universe::IsValidObject(referencedObject));
     assert(Universe::IsValidObject((vm_oop_t) holder));
 
+    // only the card holding the field is marked, not the one of the header
     size_t gcfield = *(((size_t*)holder)+1);
-    if ((gcfield & 6 /* MASK_OBJECT_IS_OLD + MASK_SEEN_BY_WRITE_BARRIER */) == 2 /* MASK_OBJECT_IS_OLD */)
-        writeBarrier_OldHolder(holder, referencedObject);
+    if ((gcfield & MASK_OBJECT_IS_OLD) && isObjectInNursery(referencedObject)) {
+        ++writeBarrierHits;
+        cardTable.MarkCard(field);
+    }
 }
@@ -41,7 +41,7 @@ void Heap<HEAP_T>::InitializeHeap(long objectSpaceSize) {
                 << "all data will be lost!" << endl;
         delete theHeap;
     }
-    theHeap = new HEAP_CLS(objectSpaceSize);
+    theHeap = new HEAP_T(objectSpaceSize);
 }
 
 template<class HEAP_T>
@@ -61,18 +61,20 @@ void Heap<HEAP_T>::FullGC() {
 }
 
 // Instantitate Template for the heap classes
-template void Heap<HEAP_CLS>::InitializeHeap(long);
-template void Heap<HEAP_CLS>::DestroyHeap();
-template void Heap<HEAP_CLS>::FullGC();
-
-class GenerationalHeap;
 template GenerationalHeap* Heap<GenerationalHeap>::theHeap;
+template void Heap<GenerationalHeap>::InitializeHeap(long);
+template void Heap<GenerationalHeap>::DestroyHeap();
+template void Heap<GenerationalHeap>::FullGC();
 template Heap<GenerationalHeap>::~Heap();
 
-class CopyingHeap;
 template CopyingHeap* Heap<CopyingHeap>::theHeap;
+template void Heap<CopyingHeap>::InitializeHeap(long);
+template void Heap<CopyingHeap>::DestroyHeap();
+template void Heap<CopyingHeap>::FullGC();
 template Heap<CopyingHeap>::~Heap();
 
-class MarkSweepHeap;
 template MarkSweepHeap* Heap<MarkSweepHeap>::theHeap;
+template void Heap<MarkSweepHeap>::InitializeHeap(long);
+template void Heap<MarkSweepHeap>::DestroyHeap();
+template void Heap<MarkSweepHeap>::FullGC();
 template Heap<MarkSweepHeap>::~Heap();
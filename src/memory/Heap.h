@@ -47,8 +47,12 @@ public:
     inline void triggerGC()      { gcTriggered = true; }
     inline void resetGCTrigger() { gcTriggered = false; }
     bool isCollectionTriggered() { return gcTriggered;  }
+    const bool* GetCollectionTrigger() const { return &gcTriggered; }
+    // only the generational heap has a write barrier, code instantiated per
+    // heap class calls it through the heap instead of testing gcType
+    inline void writeBarrier(AbstractVMObject* holder, vm_oop_t referencedObject) {}
     void FullGC();
-    inline void FreeObject(AbstractVMObject* o) { free(o); }
+    void PrintGCStat() const { gc->PrintGCStat(); }
 protected:
     GarbageCollector<HEAP_T>* const gc;
 private:
@@ -0,0 +1,76 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "HeapSizing.h"
+
+#include "../misc/Timer.h"
+#include "../vm/Universe.h"
+
+size_t HeapSizing::maxHeapSize      = 0;
+size_t HeapSizing::nurserySize      = 0;
+long   HeapSizing::targetGCOverhead = DEFAULT_TARGET_GC_OVERHEAD;
+
+HeapSizing::HeapSizing(size_t minimumSize) : minimumSize(minimumSize) {
+    headroom          = INITIAL_HEADROOM;
+    overhead          = 0.0;
+    gcTime            = 0.0;
+    totalTime         = 0.0;
+    collectionStart   = 0;
+    lastCollectionEnd = get_microseconds();
+}
+
+void HeapSizing::CollectionStarted() {
+    collectionStart = get_microseconds();
+}
+
+void HeapSizing::CollectionFinished() {
+    int64_t end = get_microseconds();
+
+    // earlier collections count less and less, so the overhead follows the
+    // phases of a program without overreacting to a single slow collection
+    gcTime    = gcTime    * OVERHEAD_DECAY + (end - collectionStart);
+    totalTime = totalTime * OVERHEAD_DECAY + (end - lastCollectionEnd);
+    overhead  = totalTime > 0 ? gcTime / totalTime : 0.0;
+    lastCollectionEnd = end;
+}
+
+size_t HeapSizing::NextLimit(size_t liveSize) {
+    if (IsOverTarget() && headroom < MAX_HEADROOM)
+        headroom *= 2;
+    else if (IsUnderTarget() && headroom > MIN_HEADROOM)
+        headroom /= 2;
+
+    size_t limit = liveSize + (size_t)(liveSize * headroom);
+    if (limit < minimumSize)
+        limit = minimumSize;
+
+    if (maxHeapSize != 0 && limit > maxHeapSize) {
+        if (liveSize > maxHeapSize)
+            GetUniverse()->ErrorExit("Out of memory, the live objects exceed the maximum heap size");
+        limit = maxHeapSize;
+    }
+    return limit;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEFAULT_TARGET_GC_OVERHEAD 5   // percent
+
+// the headroom is the space a heap may grow by until the next collection,
+// relative to the size of the objects that survived the last one
+#define INITIAL_HEADROOM 1.0
+#define MIN_HEADROOM     0.25
+#define MAX_HEADROOM     16.0
+
+// weight of the previous collections when the overhead is measured
+#define OVERHEAD_DECAY   0.75
+
+/*
+ * Sizing policy shared by the collectors. Each heap owns a HeapSizing that
+ * brackets its collections, and asks it afterwards how large the heap may
+ * grow before the next collection.
+ *
+ * The policy measures which part of the time went into collections, with
+ * recent collections weighing most. Above targetGCOverhead the headroom is
+ * doubled, so collections get less frequent. Below a quarter of the target
+ * it is halved, and the heap shrinks back towards the live objects. The
+ * result stays within minimum size and maxHeapSize.
+ */
+class HeapSizing {
+public:
+    HeapSizing(size_t minimumSize);
+
+    void   CollectionStarted();
+    void   CollectionFinished();
+
+    // the size the heap may reach before it is collected again
+    size_t NextLimit(size_t liveSize);
+
+    // fraction of the time spent collecting, recent collections weigh most
+    double GetGCOverhead() const { return overhead; }
+
+    bool   IsOverTarget() const  { return overhead * 100 > targetGCOverhead; }
+    bool   IsUnderTarget() const { return overhead * 400 < targetGCOverhead; }
+
+    // set from the command line, 0 lets the policy decide
+    static size_t maxHeapSize;
+    static size_t nurserySize;
+    static long   targetGCOverhead;
+
+private:
+    size_t  minimumSize;
+    double  headroom;
+    double  overhead;
+    double  gcTime;
+    double  totalTime;
+    int64_t collectionStart;
+    int64_t lastCollectionEnd;
+};
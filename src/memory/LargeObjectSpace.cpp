@@ -0,0 +1,90 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "LargeObjectSpace.h"
+
+#include <sys/mman.h>
+
+LargeObjectSpace::LargeObjectSpace(PageAllocator* allocator) {
+    this->allocator = allocator;
+    pages = nullptr;
+    usedBytes = 0;
+}
+
+/*
+ * Objects that span a huge page are aligned to huge pages, and their run is
+ * advised to use them, which saves most of the page faults when they are
+ * initialized.
+ */
+AbstractVMObject* LargeObjectSpace::Allocate(size_t size) {
+    size_t length = CELLS_OFFSET + size;
+    size_t alignment = length >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : SPACE_PAGE_SIZE;
+    Page* page = allocator->Allocate(length, alignment);
+#ifdef MADV_HUGEPAGE
+    if (alignment == HUGE_PAGE_SIZE)
+        madvise(page, length, MADV_HUGEPAGE);
+#endif
+
+    // runs are zero filled, so are the mark bits and the object
+    page->cells         = (char*) page + CELLS_OFFSET;
+    page->cellSize      = size;
+    page->numberOfCells = 1;
+    page->usedCells     = 1;
+    page->next = pages;
+    pages = page;
+
+    usedBytes += size;
+    return (AbstractVMObject*) page->cells;
+}
+
+size_t LargeObjectSpace::Sweep() {
+    usedBytes = 0;
+
+    Page** link = &pages;
+    while (*link != nullptr) {
+        Page* page = *link;
+        if (page->markBits[0] & 1) {
+            page->markBits[0] = 0;
+            usedBytes += page->cellSize;
+            link = &page->next;
+        } else {
+            *link = page->next;
+            size_t length = CELLS_OFFSET + page->cellSize;
+#ifdef MADV_NOHUGEPAGE
+            // the pages may be reused for small objects
+            if (length >= HUGE_PAGE_SIZE)
+                madvise(page, length, MADV_NOHUGEPAGE);
+#endif
+            allocator->Free(page, length);
+        }
+    }
+    return usedBytes;
+}
+
+void LargeObjectSpace::WalkCells(void (*walk)(AbstractVMObject*)) {
+    for (Page* page = pages; page != nullptr; page = page->next)
+        walk((AbstractVMObject*) page->cells);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+#include "Page.h"
+#include "PageAllocator.h"
+
+// objects of at least this size are not copied by the copying collector, the
+// non-moving spaces use the large object space for everything that does not
+// fit into a size class of their PagedSpace
+#define LARGE_OBJECT_SIZE (32 * 1024)
+
+// runs of at least this size are aligned to it, so they can use huge pages
+#define HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+/*
+ * Space for objects that are too big to be copied cheaply, or to fit into a
+ * size class of a PagedSpace.
+ *
+ * Every object gets a run of pages of its own from a PageAllocator, which
+ * starts with a Page header, so collectors mark large objects in place with
+ * PagedSpace::Mark(), like any other object of a non-moving space. Sweep()
+ * frees the runs of unmarked objects, which gives their memory back to the
+ * operating system right away.
+ */
+class LargeObjectSpace {
+public:
+    LargeObjectSpace(PageAllocator* allocator);
+
+    AbstractVMObject* Allocate(size_t size);
+
+    // frees all unmarked objects, clears the marks and returns the number of
+    // bytes still in use
+    size_t Sweep();
+
+    // calls walk for every object of the space
+    void WalkCells(void (*walk)(AbstractVMObject*));
+
+    size_t GetUsedBytes() const { return usedBytes; }
+
+private:
+    PageAllocator* allocator;
+    Page* pages;
+    size_t usedBytes;
+};
@@ -0,0 +1,84 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "MarkDeque.h"
+
+#include <new>
+
+#include "../vm/Universe.h"
+
+MarkDeque::MarkDeque() : top(0), bottom(0) {
+    buffer.store(newBuffer(INITIAL_MARK_DEQUE_SIZE), std::memory_order_relaxed);
+}
+
+MarkDeque::~MarkDeque() {
+    Reset();
+    freeBuffer(buffer.load(std::memory_order_relaxed));
+}
+
+MarkDeque::Buffer* MarkDeque::newBuffer(long size) {
+    Buffer* buffer = new Buffer;
+    buffer->size = size;
+    buffer->elements = new (std::nothrow) std::atomic<AbstractVMObject*>[size];
+    if (buffer->elements == nullptr)
+        GetUniverse()->ErrorExit("unable to grow the mark deque");
+    return buffer;
+}
+
+void MarkDeque::freeBuffer(Buffer* buffer) {
+    delete[] buffer->elements;
+    delete buffer;
+}
+
+MarkDeque::Buffer* MarkDeque::grow(Buffer* buf, long b, long t) {
+    Buffer* bigger = newBuffer(buf->size * 2);
+    for (long i = t; i < b; ++i)
+        bigger->Put(i, buf->Get(i));
+    replacedBuffers.push_back(buf);
+    buffer.store(bigger, std::memory_order_release);
+    return bigger;
+}
+
+AbstractVMObject* MarkDeque::Steal() {
+    long t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+        return nullptr;
+
+    Buffer* buf = buffer.load(std::memory_order_acquire);
+    AbstractVMObject* obj = buf->Get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+        return nullptr;
+    return obj;
+}
+
+void MarkDeque::Reset() {
+    for (size_t i = 0; i < replacedBuffers.size(); ++i)
+        freeBuffer(replacedBuffers[i]);
+    replacedBuffers.clear();
+}
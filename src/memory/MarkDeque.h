@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+#define INITIAL_MARK_DEQUE_SIZE 4096
+
+/*
+ * Work-stealing deque of objects whose fields still have to be walked by a
+ * parallel marker (Chase and Lev, with the memory orders of Le et al.).
+ *
+ * Only the thread owning the deque pushes and takes objects, at its bottom.
+ * Other threads steal from the top when they run out of work. The buffer
+ * doubles when it is full, buffers that were replaced are kept until Reset(),
+ * because a thief might still read from them.
+ */
+class MarkDeque {
+public:
+    MarkDeque();
+    ~MarkDeque();
+
+    inline void              Push(AbstractVMObject* obj);
+    inline AbstractVMObject* Take();
+    // returns nullptr if the deque is empty, or another thread was faster
+           AbstractVMObject* Steal();
+    inline bool              IsEmpty() const;
+
+    // frees the replaced buffers, no other thread may use the deque
+    void Reset();
+
+private:
+    struct Buffer {
+        long size;
+        std::atomic<AbstractVMObject*>* elements;
+
+        AbstractVMObject* Get(long idx) const {
+            return elements[idx & (size - 1)].load(std::memory_order_relaxed);
+        }
+        void Put(long idx, AbstractVMObject* obj) {
+            elements[idx & (size - 1)].store(obj, std::memory_order_relaxed);
+        }
+    };
+
+    static Buffer* newBuffer(long size);
+    static void    freeBuffer(Buffer* buffer);
+    Buffer* grow(Buffer* buffer, long bottom, long top);
+
+    // the owner works at the bottom and thieves at the top, keep them on
+    // separate cache lines
+    alignas(64) std::atomic<long> top;
+    alignas(64) std::atomic<long> bottom;
+    std::atomic<Buffer*> buffer;
+    std::vector<Buffer*> replacedBuffers;
+};
+
+void MarkDeque::Push(AbstractVMObject* obj) {
+    long b = bottom.load(std::memory_order_relaxed);
+    long t = top.load(std::memory_order_acquire);
+    Buffer* buf = buffer.load(std::memory_order_relaxed);
+    if (unlikely(b - t > buf->size - 1))
+        buf = grow(buf, b, t);
+    buf->Put(b, obj);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+AbstractVMObject* MarkDeque::Take() {
+    long b = bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* buf = buffer.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    AbstractVMObject* obj = buf->Get(b);
+    if (t == b) {
+        // the last object, a thief might take it at the same time
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+            obj = nullptr;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return obj;
+}
+
+bool MarkDeque::IsEmpty() const {
+    return top.load(std::memory_order_relaxed) >=
+            bottom.load(std::memory_order_relaxed);
+}
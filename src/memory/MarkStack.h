@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+#define INITIAL_MARK_STACK_SIZE 4096
+
+/*
+ * Work list of objects whose fields still have to be walked by a collector.
+ *
+ * Collectors push objects when they reach them for the first time, and walk
+ * them after popping them again, instead of recursing through WalkObjects.
+ * The native stack depth of a collection therefore does not depend on the
+ * shape of the object graph. The stack doubles in size when it is full.
+ */
+class MarkStack {
+public:
+    MarkStack();
+    ~MarkStack();
+
+    inline void              Push(AbstractVMObject* obj);
+    inline AbstractVMObject* Pop();
+    inline bool              IsEmpty() const;
+
+private:
+    void grow();
+
+    AbstractVMObject** elements;
+    size_t top;
+    size_t capacity;
+};
+
+void MarkStack::Push(AbstractVMObject* obj) {
+    if (unlikely(top == capacity))
+        grow();
+    elements[top++] = obj;
+}
+
+AbstractVMObject* MarkStack::Pop() {
+    AbstractVMObject* obj = elements[--top];
+    // the next object is walked right after this one
+    if (top > 0)
+        __builtin_prefetch(elements[top - 1]);
+    return obj;
+}
+
+bool MarkStack::IsEmpty() const {
+    return top == 0;
+}
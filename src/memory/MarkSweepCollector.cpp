@@ -2,63 +2,59 @@
 
 #include "../vm/Universe.h"
 #include "MarkSweepHeap.h"
+#include "MarkStack.h"
+#include "ParallelMarker.h"
 #include "../vmobjects/AbstractObject.h"
 #include "../vmobjects/VMFrame.h"
 #include <vmobjects/IntegerBox.h>
 
-#define GC_MARKED 3456
+// objects that are marked, but whose fields have not been walked yet
+static MarkStack markStack;
 
 void MarkSweepCollector::Collect() {
     MarkSweepHeap* heap = GetHeap<MarkSweepHeap>();
     Timer::GCTimer->Resume();
     //reset collection trigger
     heap->resetGCTrigger();
+    heap->sizing.CollectionStarted();
+    GetUniverse()->GetInterpreter()->ReleaseThreadedCode();
 
     //now mark all reachables
     markReachableObjects();
 
-    //in this survivors stack we will remember all objects that survived
-    auto survivors = new vector<AbstractVMObject*>();
-    size_t survivorsSize = 0;
-
-    vector<AbstractVMObject*>::iterator iter;
-    for (iter = heap->allocatedObjects->begin(); iter !=
-            heap->allocatedObjects->end(); iter++) {
-        if ((*iter)->GetGCField() == GC_MARKED) {
-            //object ist marked -> let it survive
-            survivors->push_back(*iter);
-            survivorsSize += (*iter)->GetObjectSize();
-            (*iter)->SetGCField(0);
-        } else {
-            //not marked -> kill it
-            heap->FreeObject(*iter);
-        }
-    }
-
-    delete heap->allocatedObjects;
-    heap->allocatedObjects = survivors;
+    //unmarked objects are put back on the free lists of their pages
+    size_t survivorsSize = heap->objectSpace.Sweep();
 
+    heap->sizing.CollectionFinished();
     heap->spcAlloc = survivorsSize;
-    //TODO: Maybe choose another constant to calculate new collectionLimit here
-    heap->collectionLimit = 2 * survivorsSize;
+    heap->collectionLimit = heap->sizing.NextLimit(survivorsSize);
     Timer::GCTimer->Halt();
 }
 
 static gc_oop_t mark_object(gc_oop_t oop) {
-    if (IS_TAGGED(oop))
+    if (IS_IMMEDIATE(oop))
         return oop;
     
     AbstractVMObject* obj = AS_OBJ(oop);
 
-    if (obj->GetGCField())
+    if (!PagedSpace::Mark(obj))
         return oop;
 
-    obj->SetGCField(GC_MARKED);
-    obj->WalkObjects(mark_object);
+    markStack.Push(obj);
     return oop;
 }
 
 void MarkSweepCollector::markReachableObjects() {
+    if (ParallelMarker::numberOfThreads > 1) {
+        ParallelMarker::MarkReachableObjects();
+        return;
+    }
+
     // This walks the globals of the universe, and the interpreter
     GetUniverse()->WalkGlobals(mark_object);
+
+    // now walk everything that is reachable from the roots
+    while (!markStack.IsEmpty()) {
+        markStack.Pop()->WalkObjects(mark_object);
+    }
 }
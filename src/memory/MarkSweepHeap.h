@@ -3,6 +3,8 @@
 #include "../misc/defs.h"
 
 #include "Heap.h"
+#include "PagedSpace.h"
+#include "HeapSizing.h"
 
 class MarkSweepHeap : public Heap<MarkSweepHeap> {
     friend class MarkSweepCollector;
@@ -10,8 +12,9 @@ public:
     MarkSweepHeap(long objectSpaceSize = 1048576);
     AbstractVMObject* AllocateObject(size_t size);
 private:
-    vector<AbstractVMObject*>* allocatedObjects;
+    PagedSpace objectSpace;
     size_t spcAlloc;
     long collectionLimit;
+    HeapSizing sizing;
 
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+// pages are aligned to their size, so the page of an object can be found by
+// masking its address
+#define PAGE_SIZE_BITS 16
+#define SPACE_PAGE_SIZE ((size_t) 1 << PAGE_SIZE_BITS)
+
+#define MIN_CELL_SIZE 16
+#define MAX_CELLS_PER_PAGE (SPACE_PAGE_SIZE / MIN_CELL_SIZE)
+
+/*
+ * Header of a page of a PagedSpace or a LargeObjectSpace. A page of the large
+ * object space holds a single cell, which may extend over many times
+ * SPACE_PAGE_SIZE, but since it starts within the first SPACE_PAGE_SIZE bytes
+ * the header is still found by masking the address of the object.
+ */
+struct Page {
+    Page*  next;           // next page of the same size class
+    Page*  nextAvailable;  // next page with free cells of the same size class
+    size_t cellSize;
+    size_t numberOfCells;
+    char*  cells;
+    void*  freeList;
+    size_t usedCells;
+    uint64_t markBits[MAX_CELLS_PER_PAGE / 64];
+};
+
+// the cells of a page start after its header
+#define CELLS_OFFSET ((sizeof(Page) + 15) & ~(size_t) 15)
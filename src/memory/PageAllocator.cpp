@@ -0,0 +1,162 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "PageAllocator.h"
+
+#include <assert.h>
+#include <sys/mman.h>
+#include <iostream>
+
+#include "../vm/Universe.h"
+
+// memory is made accessible in steps of this size, the start of the range is
+// aligned to it as well, so that huge pages fit
+#define COMMIT_SIZE ((size_t) 2 * 1024 * 1024)
+
+static void* mapMemory(size_t size, int protection) {
+    return mmap(nullptr, size, protection,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+}
+
+PageAllocator::PageAllocator() {
+    // only the addresses are reserved here, the memory is not accessible
+    // before it is handed out
+    reservedSize = DEFAULT_RESERVED_SIZE;
+    reservationSize = reservedSize + COMMIT_SIZE;
+    reservation = (char*) mapMemory(reservationSize, PROT_NONE);
+    while (reservation == MAP_FAILED && reservedSize > MIN_RESERVED_SIZE) {
+        reservedSize /= 2;
+        reservationSize = reservedSize + COMMIT_SIZE;
+        reservation = (char*) mapMemory(reservationSize, PROT_NONE);
+    }
+    pageTable = (Page**) mapMemory((reservedSize >> PAGE_SIZE_BITS) * sizeof(Page*),
+            PROT_READ | PROT_WRITE);
+    if (reservation == MAP_FAILED || pageTable == MAP_FAILED) {
+        cout << "Failed to reserve the address space of the heap." << endl;
+        GetUniverse()->Quit(-1);
+    }
+
+    start = (char*) (((size_t) reservation + COMMIT_SIZE - 1) & ~(COMMIT_SIZE - 1));
+    top = start;
+    committed = start;
+}
+
+PageAllocator::~PageAllocator() {
+    munmap(reservation, reservationSize);
+    munmap(pageTable, (reservedSize >> PAGE_SIZE_BITS) * sizeof(Page*));
+}
+
+Page* PageAllocator::Allocate(size_t size, size_t alignment) {
+    size_t count = (size + SPACE_PAGE_SIZE - 1) >> PAGE_SIZE_BITS;
+    size_t align = alignment >> PAGE_SIZE_BITS;
+
+    for (map<size_t, size_t>::iterator run = freeRuns.begin();
+         run != freeRuns.end();
+         run++) {
+        size_t runStart = run->first;
+        size_t runEnd   = run->first + run->second;
+        size_t first = (runStart + align - 1) / align * align;
+        if (first + count > runEnd)
+            continue;
+
+        freeRuns.erase(run);
+        if (first > runStart)
+            freeRuns[runStart] = first - runStart;
+        if (first + count < runEnd)
+            freeRuns[first + count] = runEnd - (first + count);
+        takeRun(first, count);
+        return PageOf(start + (first << PAGE_SIZE_BITS));
+    }
+
+    // no free run is large enough, the range handed out grows
+    size_t topIndex = (top - start) >> PAGE_SIZE_BITS;
+    size_t first = (topIndex + align - 1) / align * align;
+    if ((first + count) << PAGE_SIZE_BITS > reservedSize) {
+        cout << "Failed to allocate " << size << " Bytes." << endl;
+        GetUniverse()->Quit(-1);
+    }
+    if (first > topIndex)
+        addFreeRun(topIndex, first - topIndex);
+    top = start + ((first + count) << PAGE_SIZE_BITS);
+
+    if (top > committed) {
+        char* end = start + ((top - start + COMMIT_SIZE - 1) & ~(COMMIT_SIZE - 1));
+        if (end > start + reservedSize)
+            end = start + reservedSize;
+        if (mprotect(committed, end - committed, PROT_READ | PROT_WRITE) != 0) {
+            cout << "Failed to allocate " << size << " Bytes." << endl;
+            GetUniverse()->Quit(-1);
+        }
+        committed = end;
+    }
+
+    takeRun(first, count);
+    return PageOf(start + (first << PAGE_SIZE_BITS));
+}
+
+void PageAllocator::Free(Page* page, size_t size) {
+    size_t first = ((char*) page - start) >> PAGE_SIZE_BITS;
+    size_t count = (size + SPACE_PAGE_SIZE - 1) >> PAGE_SIZE_BITS;
+    assert(pageTable[first] == page);
+
+    // the memory reads as zero when it is touched again
+    madvise(page, count << PAGE_SIZE_BITS, MADV_DONTNEED);
+    for (size_t i = first; i < first + count; i++)
+        pageTable[i] = nullptr;
+    addFreeRun(first, count);
+
+    // a free run at the end is not kept, which keeps the range handed out,
+    // and with it the card table scanned by minor collections, short
+    map<size_t, size_t>::iterator last = --freeRuns.end();
+    if (start + ((last->first + last->second) << PAGE_SIZE_BITS) == top) {
+        top = start + (last->first << PAGE_SIZE_BITS);
+        freeRuns.erase(last);
+    }
+}
+
+// adds the run to the free runs, and merges it with its neighbors
+void PageAllocator::addFreeRun(size_t first, size_t count) {
+    map<size_t, size_t>::iterator next = freeRuns.lower_bound(first);
+    if (next != freeRuns.end() && next->first == first + count) {
+        count += next->second;
+        next = freeRuns.erase(next);
+    }
+    if (next != freeRuns.begin()) {
+        map<size_t, size_t>::iterator previous = next;
+        previous--;
+        if (previous->first + previous->second == first) {
+            previous->second += count;
+            return;
+        }
+    }
+    freeRuns[first] = count;
+}
+
+void PageAllocator::takeRun(size_t first, size_t count) {
+    Page* page = (Page*) (start + (first << PAGE_SIZE_BITS));
+    for (size_t i = first; i < first + count; i++)
+        pageTable[i] = page;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <map>
+#include <stddef.h>
+
+#include "Page.h"
+
+// the range of addresses that is reserved, smaller ranges are tried if the
+// address space is limited
+#define DEFAULT_RESERVED_SIZE ((size_t) 64 * 1024 * 1024 * 1024)
+#define MIN_RESERVED_SIZE     ((size_t) 1024 * 1024 * 1024)
+
+/*
+ * Hands out runs of pages for a PagedSpace and its LargeObjectSpace from one
+ * range of addresses, which is reserved up front. The spaces are contiguous
+ * this way, so a card table over them is a flat array.
+ *
+ * A run starts with the Page header of its space, and the page table maps
+ * every page of a run to that header, so the header is also found for
+ * addresses far into a large object. Freed runs are given back to the
+ * operating system, but stay reserved and are reused first-fit. The memory
+ * of a new run is zero filled.
+ */
+class PageAllocator {
+public:
+    PageAllocator();
+    ~PageAllocator();
+
+    // size is rounded up to whole pages, alignment is a multiple of
+    // SPACE_PAGE_SIZE
+    Page* Allocate(size_t size, size_t alignment = SPACE_PAGE_SIZE);
+    void  Free(Page* page, size_t size);
+
+    // the header of the run containing address, nullptr if it is free
+    inline Page* PageOf(const void* address) const;
+
+    // the part of the range handed out so far
+    char* GetStart() const { return start; }
+    char* GetEnd() const   { return top; }
+    size_t GetReservedSize() const { return reservedSize; }
+
+private:
+    void addFreeRun(size_t first, size_t count);
+    void takeRun(size_t first, size_t count);
+
+    char*  reservation;
+    size_t reservationSize;
+
+    char*  start;
+    size_t reservedSize;
+    // runs are only handed out below top, and memory is only accessible
+    // below committed
+    char*  top;
+    char*  committed;
+
+    Page** pageTable;
+    // free runs below top, by their first page
+    std::map<size_t, size_t> freeRuns;
+};
+
+Page* PageAllocator::PageOf(const void* address) const {
+    return pageTable[((size_t) address - (size_t) start) >> PAGE_SIZE_BITS];
+}
@@ -0,0 +1,168 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "PagedSpace.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+#include "../vm/Universe.h"
+
+size_t  PagedSpace::sizeClassSizes[NUMBER_OF_SIZE_CLASSES];
+uint8_t PagedSpace::sizeClassOf[MAX_SMALL_OBJECT_SIZE / 8 + 1];
+
+/*
+ * Size classes are 8 bytes apart up to 256 bytes, which covers almost all
+ * objects, and grow by a quarter of the next power of two above that.
+ */
+void PagedSpace::initializeSizeClasses() {
+    if (sizeClassSizes[0] != 0)
+        return;
+
+    long cls = 0;
+    size_t size = MIN_CELL_SIZE;
+    while (size <= MAX_SMALL_OBJECT_SIZE) {
+        sizeClassSizes[cls++] = size;
+        if (size < 256)
+            size += 8;
+        else {
+            size_t step = 64;
+            while (step * 8 <= size)
+                step *= 2;
+            size += step;
+        }
+    }
+    assert(cls == NUMBER_OF_SIZE_CLASSES);
+
+    cls = 0;
+    for (size_t i = 0; i <= MAX_SMALL_OBJECT_SIZE / 8; i++) {
+        while (sizeClassSizes[cls] < i * 8)
+            cls++;
+        sizeClassOf[i] = cls;
+    }
+}
+
+PagedSpace::PagedSpace() : largeObjects(&pageAllocator) {
+    initializeSizeClasses();
+    for (long i = 0; i < NUMBER_OF_SIZE_CLASSES; i++) {
+        pages[i] = nullptr;
+        availablePages[i] = nullptr;
+    }
+    usedBytes = 0;
+}
+
+// pages are zero filled, so are their mark bits
+Page* PagedSpace::newPage(long sizeClass) {
+    Page* page = pageAllocator.Allocate(SPACE_PAGE_SIZE);
+    page->cells         = (char*) page + CELLS_OFFSET;
+    page->cellSize      = sizeClassSizes[sizeClass];
+    page->numberOfCells = (SPACE_PAGE_SIZE - CELLS_OFFSET) / page->cellSize;
+    buildFreeList(page);
+
+    page->next = pages[sizeClass];
+    pages[sizeClass] = page;
+    page->nextAvailable = availablePages[sizeClass];
+    availablePages[sizeClass] = page;
+    return page;
+}
+
+AbstractVMObject* PagedSpace::Allocate(size_t size) {
+    if (size > MAX_SMALL_OBJECT_SIZE)
+        return largeObjects.Allocate(size);
+
+    long sizeClass = sizeClassOf[(size + 7) / 8];
+    Page* page = availablePages[sizeClass];
+    if (page == nullptr)
+        page = newPage(sizeClass);
+
+    void* cell = page->freeList;
+    page->freeList = *(void**) cell;
+    page->usedCells++;
+    if (page->freeList == nullptr)
+        availablePages[sizeClass] = page->nextAvailable;
+
+    usedBytes += page->cellSize;
+    memset(cell, 0, size);
+    return (AbstractVMObject*) cell;
+}
+
+// links all unmarked cells into the free list, and clears the marks
+void PagedSpace::buildFreeList(Page* page) {
+    void*  freeList  = nullptr;
+    size_t usedCells = 0;
+    for (size_t i = page->numberOfCells; i-- > 0; ) {
+        if ((page->markBits[i / 64] >> (i % 64)) & 1) {
+            usedCells++;
+        } else {
+            void** cell = (void**) (page->cells + i * page->cellSize);
+            cell[0] = freeList;
+            cell[1] = nullptr;  // the gc field
+            freeList = cell;
+        }
+    }
+    memset(page->markBits, 0, sizeof(page->markBits));
+    page->freeList  = freeList;
+    page->usedCells = usedCells;
+}
+
+size_t PagedSpace::Sweep() {
+    usedBytes = 0;
+
+    for (long sizeClass = 0; sizeClass < NUMBER_OF_SIZE_CLASSES; sizeClass++) {
+        availablePages[sizeClass] = nullptr;
+        Page** link = &pages[sizeClass];
+        while (*link != nullptr) {
+            Page* page = *link;
+            buildFreeList(page);
+
+            // pages without live objects are given back
+            if (page->usedCells == 0) {
+                *link = page->next;
+                pageAllocator.Free(page, SPACE_PAGE_SIZE);
+                continue;
+            }
+
+            usedBytes += page->usedCells * page->cellSize;
+            if (page->freeList != nullptr) {
+                page->nextAvailable = availablePages[sizeClass];
+                availablePages[sizeClass] = page;
+            }
+            link = &page->next;
+        }
+    }
+
+    return usedBytes + largeObjects.Sweep();
+}
+
+void PagedSpace::WalkCells(void (*walk)(AbstractVMObject*)) {
+    for (long sizeClass = 0; sizeClass < NUMBER_OF_SIZE_CLASSES; sizeClass++)
+        for (Page* page = pages[sizeClass]; page != nullptr; page = page->next)
+            for (size_t i = 0; i < page->numberOfCells; i++)
+                walk((AbstractVMObject*) (page->cells + i * page->cellSize));
+    largeObjects.WalkCells(walk);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+#include "Page.h"
+#include "PageAllocator.h"
+#include "LargeObjectSpace.h"
+
+// objects up to this size are allocated in cells of a size class, bigger
+// ones are left to the large object space
+#define MAX_SMALL_OBJECT_SIZE 2048
+#define NUMBER_OF_SIZE_CLASSES 43
+
+/*
+ * Page based segregated-fit allocator for non-moving spaces.
+ *
+ * Small objects are rounded up to one of the size classes and allocated from
+ * the free list of a page that only holds cells of that size. Larger objects
+ * are allocated in a LargeObjectSpace. Collectors mark objects in the mark
+ * bitmap of their page, and Sweep() rebuilds the free lists from the bitmaps,
+ * without touching live objects.
+ *
+ * All pages come from the PageAllocator of the space, so the space covers
+ * one contiguous range of addresses. The gc field of a free cell is zeroed,
+ * which tells the cells holding objects apart when a range is scanned.
+ */
+class PagedSpace {
+public:
+    PagedSpace();
+
+    AbstractVMObject* Allocate(size_t size);
+
+    // sets the mark bit of obj, returns false if it was set already
+    static inline bool Mark(AbstractVMObject* obj);
+    static inline bool IsMarked(AbstractVMObject* obj);
+    // like Mark(), for several threads marking at the same time
+    static inline bool MarkAtomic(AbstractVMObject* obj);
+
+    // frees all unmarked objects, clears the marks and returns the number of
+    // bytes still in use
+    size_t Sweep();
+
+    // calls walk for every cell of the space, including the free ones, which
+    // have a zero gc field
+    void WalkCells(void (*walk)(AbstractVMObject*));
+
+    size_t GetUsedBytes() const { return usedBytes + largeObjects.GetUsedBytes(); }
+    const PageAllocator& GetPageAllocator() const { return pageAllocator; }
+
+    static inline bool IsLargeObject(AbstractVMObject* obj);
+
+private:
+    static inline Page*  pageOf(AbstractVMObject* obj);
+    static inline size_t cellIndex(Page* page, AbstractVMObject* obj);
+
+    Page* newPage(long sizeClass);
+    void  buildFreeList(Page* page);
+
+    static size_t sizeClassSizes[NUMBER_OF_SIZE_CLASSES];
+    static uint8_t sizeClassOf[MAX_SMALL_OBJECT_SIZE / 8 + 1];
+    static void initializeSizeClasses();
+
+    Page* pages[NUMBER_OF_SIZE_CLASSES];
+    Page* availablePages[NUMBER_OF_SIZE_CLASSES];
+    PageAllocator pageAllocator;
+    LargeObjectSpace largeObjects;
+    size_t usedBytes;
+};
+
+Page* PagedSpace::pageOf(AbstractVMObject* obj) {
+    return (Page*) ((size_t) obj & ~(SPACE_PAGE_SIZE - 1));
+}
+
+size_t PagedSpace::cellIndex(Page* page, AbstractVMObject* obj) {
+    return ((size_t) obj - (size_t) page->cells) / page->cellSize;
+}
+
+bool PagedSpace::IsLargeObject(AbstractVMObject* obj) {
+    return pageOf(obj)->numberOfCells == 1;
+}
+
+bool PagedSpace::Mark(AbstractVMObject* obj) {
+    Page* page = pageOf(obj);
+    size_t idx = cellIndex(page, obj);
+    uint64_t bit = (uint64_t) 1 << (idx % 64);
+    uint64_t& word = page->markBits[idx / 64];
+    if (word & bit)
+        return false;
+    word |= bit;
+    return true;
+}
+
+bool PagedSpace::MarkAtomic(AbstractVMObject* obj) {
+    Page* page = pageOf(obj);
+    size_t idx = cellIndex(page, obj);
+    uint64_t bit = (uint64_t) 1 << (idx % 64);
+    uint64_t* word = &page->markBits[idx / 64];
+    // most references go to objects that are marked already
+    if (__atomic_load_n(word, __ATOMIC_RELAXED) & bit)
+        return false;
+    return !(__atomic_fetch_or(word, bit, __ATOMIC_RELAXED) & bit);
+}
+
+bool PagedSpace::IsMarked(AbstractVMObject* obj) {
+    Page* page = pageOf(obj);
+    size_t idx = cellIndex(page, obj);
+    return (page->markBits[idx / 64] >> (idx % 64)) & 1;
+}
@@ -0,0 +1,132 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "ParallelMarker.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "PagedSpace.h"
+#include "MarkDeque.h"
+#include "../vm/Universe.h"
+#include "../vmobjects/AbstractObject.h"
+#include "../vmobjects/IntegerBox.h"
+
+long ParallelMarker::numberOfThreads = DEFAULT_GC_THREADS;
+
+// one deque per marker, kept from one collection to the next
+static vector<MarkDeque*> deques;
+
+// the deque of the marker running on this thread, the VM library is linked
+// at startup, so the initial-exec model works although it is not built as PIC
+static thread_local MarkDeque* ownDeque __attribute__((tls_model("initial-exec")));
+
+// markers that found no work to do
+static std::atomic<long> idleMarkers;
+
+static gc_oop_t mark_object(gc_oop_t oop) {
+    // don't process tagged objects
+    if (IS_IMMEDIATE(oop))
+        return oop;
+
+    AbstractVMObject* obj = AS_OBJ(oop);
+    assert(Universe::IsValidObject(obj));
+
+    if (PagedSpace::MarkAtomic(obj))
+        ownDeque->Push(obj);
+    return oop;
+}
+
+// tries the other deques once, starting after the own one
+static AbstractVMObject* steal(long self) {
+    long n = deques.size();
+    for (long i = 1; i < n; ++i) {
+        AbstractVMObject* obj = deques[(self + i) % n]->Steal();
+        if (obj != nullptr)
+            return obj;
+    }
+    return nullptr;
+}
+
+static bool isWorkLeft() {
+    for (size_t i = 0; i < deques.size(); ++i) {
+        if (!deques[i]->IsEmpty())
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Only the owner pushes to a deque, so the deque of an idle marker stays
+ * empty. Once all markers are idle, no objects are left to walk.
+ */
+static void mark(long self) {
+    ownDeque = deques[self];
+    long numberOfMarkers = deques.size();
+
+    while (true) {
+        AbstractVMObject* obj;
+        while ((obj = ownDeque->Take()) != nullptr)
+            obj->WalkObjects(mark_object);
+
+        obj = steal(self);
+        if (obj != nullptr) {
+            obj->WalkObjects(mark_object);
+            continue;
+        }
+
+        idleMarkers.fetch_add(1);
+        while (true) {
+            if (idleMarkers.load() == numberOfMarkers)
+                return;
+            if (isWorkLeft()) {
+                idleMarkers.fetch_sub(1);
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ParallelMarker::MarkReachableObjects() {
+    while (deques.size() < (size_t) numberOfThreads)
+        deques.push_back(new MarkDeque());
+    for (size_t i = 0; i < deques.size(); ++i)
+        deques[i]->Reset();
+    idleMarkers.store(0);
+
+    // the roots are walked by this thread, the other markers steal from it
+    ownDeque = deques[0];
+    GetUniverse()->WalkGlobals(mark_object);
+
+    vector<std::thread> markers;
+    for (long i = 1; i < numberOfThreads; ++i)
+        markers.push_back(std::thread(mark, i));
+    mark(0);
+    for (size_t i = 0; i < markers.size(); ++i)
+        markers[i].join();
+}
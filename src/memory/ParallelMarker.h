@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+
+#define DEFAULT_GC_THREADS 1
+#define MAX_GC_THREADS 64
+
+/*
+ * Marks the objects reachable from the roots of the universe with several
+ * threads, for the non-moving collectors.
+ *
+ * The roots are pushed to the deque of the thread that started the
+ * collection, and every marker walks the objects of its own deque. Markers
+ * that run out of work steal objects from the deques of the others. Mark
+ * bits are set atomically, so each object is walked by exactly one marker.
+ * Marking is done once all markers are idle and no deque holds objects.
+ */
+class ParallelMarker {
+public:
+    static void MarkReachableObjects();
+
+    // set with -gcthreads:N, with a single thread the collectors mark
+    // sequentially
+    static long numberOfThreads;
+};
@@ -0,0 +1,75 @@
+#include "SelectedHeap.h"
+
+#include <string.h>
+
+#include "../vm/Universe.h"
+
+long gcType = GC_TYPE;
+
+SelectedHeap selectedHeap;
+
+void SelectedHeap::InitializeHeap(long objectSpaceSize) {
+    switch (gcType) {
+        case GENERATIONAL:
+            Heap<GenerationalHeap>::InitializeHeap(objectSpaceSize);
+            break;
+        case COPYING:
+            Heap<CopyingHeap>::InitializeHeap(objectSpaceSize);
+            break;
+        default:
+            Heap<MarkSweepHeap>::InitializeHeap(objectSpaceSize);
+            break;
+    }
+}
+
+void SelectedHeap::DestroyHeap() {
+    Heap<GenerationalHeap>::DestroyHeap();
+    Heap<CopyingHeap>::DestroyHeap();
+    Heap<MarkSweepHeap>::DestroyHeap();
+}
+
+bool SelectedHeap::Select(const char* name) {
+    if (strcmp(name, "generational") == 0)
+        gcType = GENERATIONAL;
+    else if (strcmp(name, "copying") == 0)
+        gcType = COPYING;
+    else if (strcmp(name, "marksweep") == 0)
+        gcType = MARK_SWEEP;
+    else
+        return false;
+    return true;
+}
+
+const char* SelectedHeap::GetName() {
+    switch (gcType) {
+        case GENERATIONAL: return "generational";
+        case COPYING:      return "copying";
+        default:           return "mark-sweep";
+    }
+}
+
+void SelectedHeap::FullGC() {
+    switch (gcType) {
+        case GENERATIONAL: GetHeap<GenerationalHeap>()->FullGC(); break;
+        case COPYING:      GetHeap<CopyingHeap>()->FullGC();      break;
+        default:           GetHeap<MarkSweepHeap>()->FullGC();    break;
+    }
+}
+
+void SelectedHeap::PrintGCStat() const {
+    // the heap might not be set up yet if the VM quits early
+    switch (gcType) {
+        case GENERATIONAL:
+            if (GetHeap<GenerationalHeap>())
+                GetHeap<GenerationalHeap>()->PrintGCStat();
+            break;
+        case COPYING:
+            if (GetHeap<CopyingHeap>())
+                GetHeap<CopyingHeap>()->PrintGCStat();
+            break;
+        default:
+            if (GetHeap<MarkSweepHeap>())
+                GetHeap<MarkSweepHeap>()->PrintGCStat();
+            break;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+
+#include "GenerationalHeap.h"
+#include "CopyingHeap.h"
+#include "MarkSweepHeap.h"
+
+/*
+ * All collectors are compiled into the VM, and one of them is picked at
+ * startup (see -gc: in Universe). gcType holds the selected collector and
+ * does not change afterwards, so the switches below are perfectly predicted.
+ *
+ * SelectedHeap is not a heap itself, it only forwards to the heap of the
+ * selected collector. It is the HEAP_CLS everything outside the memory
+ * subsystem allocates through. The interpreter loop does not go through it,
+ * it is instantiated once per heap class instead.
+ */
+class SelectedHeap {
+public:
+    static void InitializeHeap(long objectSpaceSize);
+    static void DestroyHeap();
+
+    // returns false if name does not denote a known collector
+    static bool Select(const char* name);
+    static const char* GetName();
+
+    inline AbstractVMObject* AllocateObject(size_t size, bool outsideNursery);
+    inline void triggerGC();
+    void FullGC();
+    void PrintGCStat() const;
+};
+
+extern SelectedHeap selectedHeap;
+
+template<>
+inline SelectedHeap* GetHeap<SelectedHeap>() {
+    return &selectedHeap;
+}
+
+AbstractVMObject* SelectedHeap::AllocateObject(size_t size, bool outsideNursery) {
+    switch (gcType) {
+        case GENERATIONAL:
+            if (outsideNursery)
+                return GetHeap<GenerationalHeap>()->AllocateMatureObject(size);
+            return GetHeap<GenerationalHeap>()->AllocateNurseryObject(size);
+        case COPYING:
+            return GetHeap<CopyingHeap>()->AllocateObject(size);
+        default:
+            return GetHeap<MarkSweepHeap>()->AllocateObject(size);
+    }
+}
+
+void SelectedHeap::triggerGC() {
+    switch (gcType) {
+        case GENERATIONAL: GetHeap<GenerationalHeap>()->triggerGC(); break;
+        case COPYING:      GetHeap<CopyingHeap>()->triggerGC();      break;
+        default:           GetHeap<MarkSweepHeap>()->triggerGC();    break;
+    }
+}
@@ -40,6 +40,7 @@ public:
     void AddIfAbsent(const T& ptr);
     void AddAll(const ExtendedList<T>* list);
     void PushBack(const T& ptr);
+    void PopBack();
     void Clear();
     size_t Size() const;
     T Get(long index);
@@ -115,3 +116,8 @@ template<class T>
 void ExtendedList<T>::PushBack(const T& ptr) {
     theList.push_back(ptr);
 }
+
+template<class T>
+void ExtendedList<T>::PopBack() {
+    theList.pop_back();
+}
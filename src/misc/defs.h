@@ -69,29 +69,28 @@
 #define COPYING      2
 #define MARK_SWEEP   3
 
-#if   GC_TYPE == GENERATIONAL
-  class   GenerationalHeap;
-  typedef GenerationalHeap HEAP_CLS;
-  #define write_barrier(obj, value_ptr) ((GetHeap<GenerationalHeap>())->writeBarrier(obj, value_ptr))
-  #define ALLOC_MATURE    , true
-  #define ALLOC_OUTSIDE_NURSERY(X) , (X)
-  #define ALLOC_OUTSIDE_NURSERY_DECL , bool outsideNursery = false
-#elif GC_TYPE == COPYING
-  class   CopyingHeap;
-  typedef CopyingHeap HEAP_CLS;
-  #define write_barrier(obj, value_ptr)
-  #define ALLOC_MATURE
-  #define ALLOC_OUTSIDE_NURSERY(X)
-  #define ALLOC_OUTSIDE_NURSERY_DECL
-#elif GC_TYPE == MARK_SWEEP
-  class   MarkSweepHeap;
-  typedef MarkSweepHeap HEAP_CLS;
-  #define write_barrier(obj, value_ptr)
-  #define ALLOC_MATURE
-  #define ALLOC_OUTSIDE_NURSERY(X)
-  #define ALLOC_OUTSIDE_NURSERY_DECL
+// all collectors are built into the VM, GC_TYPE is the one used unless -gc:
+// selects another one at startup
+#ifndef GC_TYPE
+  #define GC_TYPE GENERATIONAL
 #endif
 
+extern long gcType;
+
+class   GenerationalHeap;
+class   SelectedHeap;
+typedef SelectedHeap HEAP_CLS;
+// The barriers only apply to the generational heap, the heaps of the other
+// collectors are not even allocated. gcType does not change after startup,
+// so the check is perfectly predicted, like the switches of SelectedHeap.
+#define write_barrier(obj, value_ptr) (gcType == GENERATIONAL \
+        ? (GetHeap<GenerationalHeap>())->writeBarrier(obj, value_ptr) : (void) 0)
+#define array_write_barrier(arr, field, value_ptr) (gcType == GENERATIONAL \
+        ? (GetHeap<GenerationalHeap>())->writeBarrierArray(arr, field, value_ptr) : (void) 0)
+#define ALLOC_MATURE    , true
+#define ALLOC_OUTSIDE_NURSERY(X) , (X)
+#define ALLOC_OUTSIDE_NURSERY_DECL , bool outsideNursery = false
+
 //
 // Integer Settings
 //
@@ -99,6 +98,10 @@
   #define USE_TAGGING false
 #endif
 
+#ifndef USE_DOUBLE_TAGGING
+  #define USE_DOUBLE_TAGGING false
+#endif
+
 #ifdef CACHE_INTEGER
   // Sanity check
   #if CACHE_INTEGER && USE_TAGGING
@@ -35,38 +35,28 @@
 
 #include <vm/Universe.h>
 
-_Array::_Array() : PrimitiveContainer() {
-    SetPrimitive("new_",    new Routine<_Array>(this, &_Array::New_,    true));
-    SetPrimitive("at_",     new Routine<_Array>(this, &_Array::At_,     false));
-    SetPrimitive("at_put_", new Routine<_Array>(this, &_Array::At_Put_, false));
-    SetPrimitive("length",  new Routine<_Array>(this, &_Array::Length,  false));
-}
-
-void _Array::At_(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t idx = frame->Pop();
-    VMArray* self = static_cast<VMArray*>(frame->Pop());
-    vm_oop_t elem = self->GetIndexableField(INT_VAL(idx) - 1);
-    frame->Push(elem);
+static vm_oop_t arrAt_(vm_oop_t self, vm_oop_t idx) {
+    return static_cast<VMArray*>(self)->GetIndexableField(INT_VAL(idx) - 1);
 }
 
-void _Array::At_Put_(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t value = frame->Pop();
-    vm_oop_t index = frame->Pop();
-    VMArray* self = static_cast<VMArray*>(frame->GetStackElement(0));
+static vm_oop_t arrAt_Put_(vm_oop_t self, vm_oop_t index, vm_oop_t value) {
     long i = INT_VAL(index);
-    self->SetIndexableField(i - 1, value);
+    static_cast<VMArray*>(self)->SetIndexableField(i - 1, value);
+    return self;
 }
 
-void _Array::Length(VMObject* /*object*/, VMFrame* frame) {
-    VMArray* self = static_cast<VMArray*>(frame->Pop());
-    vm_oop_t new_int = NEW_INT(self->GetNumberOfIndexableFields());
-    frame->Push(new_int);
+static vm_oop_t arrLength(vm_oop_t self) {
+    return NEW_INT(static_cast<VMArray*>(self)->GetNumberOfIndexableFields());
 }
 
-void _Array::New_(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t arg = frame->Pop();
-    frame->Pop();
+static vm_oop_t arrNew_(vm_oop_t /*clazz*/, vm_oop_t arg) {
     long size = INT_VAL(arg);
-    frame->Push(GetUniverse()->NewArray(size));
+    return GetUniverse()->NewArray(size);
 }
 
+_Array::_Array() : PrimitiveContainer() {
+    SetPrimitive("new_",    new DirectRoutine(arrNew_,    true));
+    SetPrimitive("at_",     new DirectRoutine(arrAt_,     false));
+    SetPrimitive("at_put_", new DirectRoutine(arrAt_Put_, false));
+    SetPrimitive("length",  new DirectRoutine(arrLength,  false));
+}
@@ -32,8 +32,4 @@
 class _Array: public PrimitiveContainer {
 public:
     _Array();
-    void New_(VMObject* object, VMFrame* frame);
-    void At_(VMObject* object, VMFrame* frame);
-    void At_Put_(VMObject* object, VMFrame* frame);
-    void Length(VMObject* object, VMFrame* frame);
 };
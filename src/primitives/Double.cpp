@@ -44,9 +44,11 @@
  * This function coerces any right-hand parameter to a double, regardless of its
  * true nature. This is to make sure that all Double operations return Doubles.
  */
-double _Double::coerceDouble(vm_oop_t x) {
+static double coerceDouble(vm_oop_t x) {
     if (IS_TAGGED(x))
         return (double) INT_VAL(x);
+    if (IS_TAGGED_DOUBLE(x))
+        return DOUBLE_VAL(x);
     
     VMClass* cl = ((AbstractVMObject*)x)->GetClass();
     if (cl == load_ptr(doubleClass))
@@ -66,102 +68,95 @@ double _Double::coerceDouble(vm_oop_t x) {
  * right are prepared for the operation.
  */
 #define PREPARE_OPERANDS \
-    double right = coerceDouble(frame->Pop()); \
-    VMDouble* leftObj = static_cast<VMDouble*>(frame->Pop()); \
-    double left = leftObj->GetEmbeddedDouble();
+    double right = coerceDouble(rightObj); \
+    double left = DOUBLE_VAL(leftObj);
 
-void _Double::Plus(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblPlus(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble(left + right));
+    return NEW_DOUBLE(left + right);
 }
 
-void _Double::Minus(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblMinus(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble(left - right));
+    return NEW_DOUBLE(left - right);
 }
 
-void _Double::Star(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblStar(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble(left * right));
+    return NEW_DOUBLE(left * right);
 }
 
-void _Double::Slashslash(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblSlashslash(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble(left / right));
+    return NEW_DOUBLE(left / right);
 }
 
-void _Double::Percent(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblPercent(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble((double)((int64_t)left %
-                    (int64_t)right)));
+    return NEW_DOUBLE((double)((int64_t)left %
+                    (int64_t)right));
 }
 
-void _Double::And(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblAnd(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble((double)((int64_t)left &
-                    (int64_t)right)));
+    return NEW_DOUBLE((double)((int64_t)left &
+                    (int64_t)right));
 }
 
-void _Double::BitwiseXor(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblBitwiseXor(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
-    frame->Push(GetUniverse()->NewDouble((double)((int64_t)left ^
-                    (int64_t)right)));
+    return NEW_DOUBLE((double)((int64_t)left ^
+                    (int64_t)right));
 }
 
 /*
  * This function implements strict (bit-wise) equality and is therefore
  * inaccurate.
  */
-void _Double::Equal(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblEqual(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
     if(left == right)
-    frame->Push(load_ptr(trueObject));
+        return load_ptr(trueObject);
     else
-    frame->Push(load_ptr(falseObject));
+        return load_ptr(falseObject);
 }
 
-void _Double::Lowerthan(VMObject* /*object*/, VMFrame* frame) {
+static vm_oop_t dblLowerthan(vm_oop_t leftObj, vm_oop_t rightObj) {
     PREPARE_OPERANDS;
     if(left < right)
-        frame->Push(load_ptr(trueObject));
+        return load_ptr(trueObject);
     else
-        frame->Push(load_ptr(falseObject));
+        return load_ptr(falseObject);
 }
 
-void _Double::AsString(VMObject* /*object*/, VMFrame* frame) {
-    VMDouble* self = static_cast<VMDouble*>(frame->Pop());
-
-    double dbl = self->GetEmbeddedDouble();
+static vm_oop_t dblAsString(vm_oop_t self) {
+    double dbl = DOUBLE_VAL(self);
     ostringstream Str;
     Str.precision(17);
     Str << dbl;
-    frame->Push( GetUniverse()->NewString( Str.str().c_str() ) );
+    return GetUniverse()->NewString( Str.str().c_str() );
 }
 
-void _Double::Sqrt(VMObject* /*object*/, VMFrame* frame) {
-    VMDouble* self = static_cast<VMDouble*>(frame->Pop());
-    VMDouble* result = GetUniverse()->NewDouble( sqrt(self->GetEmbeddedDouble()) );
-    frame->Push(result);
+static vm_oop_t dblSqrt(vm_oop_t self) {
+    return NEW_DOUBLE( sqrt(DOUBLE_VAL(self)) );
 }
 
-void _Double::Round(VMObject* /*object*/, VMFrame* frame) {
-    VMDouble* self = (VMDouble*)frame->Pop();
-    int64_t rounded = llround(self->GetEmbeddedDouble());
-
-    frame->Push(NEW_INT(rounded));
+static vm_oop_t dblRound(vm_oop_t self) {
+    int64_t rounded = llround(DOUBLE_VAL(self));
+    return NEW_INT(rounded);
 }
 
 _Double::_Double() : PrimitiveContainer() {
-    SetPrimitive("plus",       new Routine<_Double>(this, &_Double::Plus,       false));
-    SetPrimitive("minus",      new Routine<_Double>(this, &_Double::Minus,      false));
-    SetPrimitive("star",       new Routine<_Double>(this, &_Double::Star,       false));
-    SetPrimitive("slashslash", new Routine<_Double>(this, &_Double::Slashslash, false));
-    SetPrimitive("percent",    new Routine<_Double>(this, &_Double::Percent,    false));
-    SetPrimitive("and",        new Routine<_Double>(this, &_Double::And,        false));
-    SetPrimitive("equal",      new Routine<_Double>(this, &_Double::Equal,      false));
-    SetPrimitive("lowerthan",  new Routine<_Double>(this, &_Double::Lowerthan,  false));
-    SetPrimitive("asString",   new Routine<_Double>(this, &_Double::AsString,   false));
-    SetPrimitive("sqrt",       new Routine<_Double>(this, &_Double::Sqrt,       false));
-    SetPrimitive("bitXor_",    new Routine<_Double>(this, &_Double::BitwiseXor, false));
-    SetPrimitive("round",      new Routine<_Double>(this, &_Double::Round,      false));
+    SetPrimitive("plus",       new DirectRoutine(dblPlus,       false));
+    SetPrimitive("minus",      new DirectRoutine(dblMinus,      false));
+    SetPrimitive("star",       new DirectRoutine(dblStar,       false));
+    SetPrimitive("slashslash", new DirectRoutine(dblSlashslash, false));
+    SetPrimitive("percent",    new DirectRoutine(dblPercent,    false));
+    SetPrimitive("and",        new DirectRoutine(dblAnd,        false));
+    SetPrimitive("equal",      new DirectRoutine(dblEqual,      false));
+    SetPrimitive("lowerthan",  new DirectRoutine(dblLowerthan,  false));
+    SetPrimitive("asString",   new DirectRoutine(dblAsString,   false));
+    SetPrimitive("sqrt",       new DirectRoutine(dblSqrt,       false));
+    SetPrimitive("bitXor_",    new DirectRoutine(dblBitwiseXor, false));
+    SetPrimitive("round",      new DirectRoutine(dblRound,      false));
 }
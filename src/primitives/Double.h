@@ -32,19 +32,4 @@
 class _Double: public PrimitiveContainer {
 public:
     _Double();
-    void Plus(VMObject* object, VMFrame* frame);
-    void Minus(VMObject* object, VMFrame* frame);
-    void Star(VMObject* object, VMFrame* frame);
-    void Slashslash(VMObject* object, VMFrame* frame);
-    void Percent(VMObject* object, VMFrame* frame);
-    void And(VMObject* object, VMFrame* frame);
-    void Equal(VMObject* object, VMFrame* frame);
-    void Lowerthan(VMObject* object, VMFrame* frame);
-    void AsString(VMObject* object, VMFrame* frame);
-    void Sqrt(VMObject* object, VMFrame* frame);
-    void BitwiseXor(VMObject* object, VMFrame* frame);
-    void Round(VMObject* object, VMFrame* frame);
-
-private:
-    double coerceDouble(vm_oop_t x);
 };
@@ -42,135 +42,67 @@
 #include "../primitivesCore/Routine.h"
 
 /*
- * This macro performs a coercion check to Double. Depending on
- * the right-hand operand, an Integer operation will have to be resent as a
- * Double operation (this type imposes itselves on the result
- * of an Integer operation).
+ * Depending on the right-hand operand, an Integer operation will have to be
+ * resent as a Double operation (this type imposes itselves on the result of
+ * an Integer operation). The direct primitives fail in that case, and their
+ * fallback routines perform the resend.
  */
-#define CHECK_COERCION(obj,receiver,op) { \
-  VMClass* cl = CLASS_OF(obj);\
-  if(cl == load_ptr(doubleClass)) { \
-    resendAsDouble((op), (receiver), static_cast<VMDouble*>(obj)); \
-    return; \
-  } \
-}
-
-_Integer::_Integer() : PrimitiveContainer() {
-    srand((unsigned) time(nullptr));
-    SetPrimitive("plus",               new Routine<_Integer>(this, &_Integer::Plus,       false));
-    SetPrimitive("minus",              new Routine<_Integer>(this, &_Integer::Minus,      false));
-    SetPrimitive("star",               new Routine<_Integer>(this, &_Integer::Star,       false));
-    SetPrimitive("bitAnd_",            new Routine<_Integer>(this, &_Integer::BitwiseAnd, false));
-    SetPrimitive("bitXor_",            new Routine<_Integer>(this, &_Integer::BitwiseXor, false));
-    SetPrimitive("lowerthanlowerthan", new Routine<_Integer>(this, &_Integer::LeftShift,  false));
-    SetPrimitive("slash",              new Routine<_Integer>(this, &_Integer::Slash,      false));
-    SetPrimitive("slashslash",         new Routine<_Integer>(this, &_Integer::Slashslash, false));
-    SetPrimitive("percent",            new Routine<_Integer>(this, &_Integer::Percent,    false));
-    SetPrimitive("and",                new Routine<_Integer>(this, &_Integer::And,        false));
-    SetPrimitive("equal",              new Routine<_Integer>(this, &_Integer::Equal,      false));
-    SetPrimitive("equalequal",         new Routine<_Integer>(this, &_Integer::EqualEqual, false));
-    SetPrimitive("lowerthan",          new Routine<_Integer>(this, &_Integer::Lowerthan,  false));
-    SetPrimitive("asString",           new Routine<_Integer>(this, &_Integer::AsString,   false));
-    SetPrimitive("sqrt",               new Routine<_Integer>(this, &_Integer::Sqrt,       false));
-    SetPrimitive("atRandom",           new Routine<_Integer>(this, &_Integer::AtRandom,   false));
-    SetPrimitive("fromString_",        new Routine<_Integer>(this, &_Integer::FromString, true));
-}
-
-//
-// private functions for Integer
-//
-
-void _Integer::resendAsDouble(const char* op, vm_oop_t left, VMDouble* right) {
-    VMDouble* leftDouble = GetUniverse()->NewDouble((double)INT_VAL(left));
-    vm_oop_t operands[] = {right};
-
-    leftDouble->Send(op, operands, 1);
+#define CHECK_COERCION(obj) { \
+  if (CLASS_OF(obj) == load_ptr(doubleClass)) \
+    return nullptr; \
 }
 
 //
 // arithmetic operations
 //
 
-void _Integer::Plus(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-
-    CHECK_COERCION(rightObj, leftObj, "+");
-
+static vm_oop_t intPlus(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
     int64_t result = (int64_t)INT_VAL(leftObj) + (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::BitwiseAnd(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-
+static vm_oop_t intBitwiseAnd(vm_oop_t leftObj, vm_oop_t rightObj) {
     int64_t result = (int64_t)INT_VAL(leftObj) & (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::BitwiseXor(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
+static vm_oop_t intBitwiseXor(vm_oop_t leftObj, vm_oop_t rightObj) {
     int64_t result = (int64_t)INT_VAL(leftObj) ^ (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-
-void _Integer::LeftShift(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
+static vm_oop_t intLeftShift(vm_oop_t leftObj, vm_oop_t rightObj) {
     int64_t result = (int64_t)INT_VAL(leftObj) << (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::Minus(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
-    CHECK_COERCION(rightObj, leftObj, "-");
-
+static vm_oop_t intMinus(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
     int64_t result = (int64_t)INT_VAL(leftObj) - (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::Star(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
-    CHECK_COERCION(rightObj, leftObj, "*");
-
+static vm_oop_t intStar(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
     int64_t result = (int64_t)INT_VAL(leftObj) * (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::Slashslash(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
-    CHECK_COERCION(rightObj, leftObj, "/");
-
+static vm_oop_t intSlashslash(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
     double result = (double)INT_VAL(leftObj) / (double)INT_VAL(rightObj);
-    frame->Push(GetUniverse()->NewDouble(result));
+    return NEW_DOUBLE(result);
 }
 
-void _Integer::Slash(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
-    CHECK_COERCION(rightObj, leftObj, "/");
-
+static vm_oop_t intSlash(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
     int64_t result = (int64_t)INT_VAL(leftObj) / (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::Percent(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-
-    CHECK_COERCION(rightObj, leftObj, "%");
+static vm_oop_t intPercent(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
 
     int64_t l = (int64_t)INT_VAL(leftObj);
     int64_t r = (int64_t)INT_VAL(rightObj);
@@ -181,93 +113,141 @@ void _Integer::Percent(VMObject* object, VMFrame* frame) {
         result += r;
     }
 
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::And(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-
-    CHECK_COERCION(rightObj, leftObj, "&");
-
+static vm_oop_t intAnd(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
     int64_t result = (int64_t)INT_VAL(leftObj) & (int64_t)INT_VAL(rightObj);
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
 }
 
-void _Integer::Equal(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-
-    CHECK_COERCION(rightObj, leftObj, "=");
+static vm_oop_t intEqual(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
 
     if (IS_TAGGED(rightObj) || CLASS_OF(rightObj) == load_ptr(integerClass)) {
         if (INT_VAL(leftObj) == INT_VAL(rightObj))
-            frame->Push(load_ptr(trueObject));
+            return load_ptr(trueObject);
         else
-            frame->Push(load_ptr(falseObject));
-    } else if (CLASS_OF(rightObj) == load_ptr(doubleClass)) {
-        assert(false);
+            return load_ptr(falseObject);
     } else {
-        frame->Push(load_ptr(falseObject));
+        return load_ptr(falseObject);
     }
 }
 
-void _Integer::EqualEqual(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-    
+static vm_oop_t intEqualEqual(vm_oop_t leftObj, vm_oop_t rightObj) {
     if (IS_TAGGED(rightObj) || CLASS_OF(rightObj) == load_ptr(integerClass)) {
         if (INT_VAL(leftObj) == INT_VAL(rightObj))
-            frame->Push(load_ptr(trueObject));
+            return load_ptr(trueObject);
         else
-            frame->Push(load_ptr(falseObject));
+            return load_ptr(falseObject);
     } else {
-        frame->Push(load_ptr(falseObject));
+        return load_ptr(falseObject);
     }
 }
 
-void _Integer::Lowerthan(VMObject* object, VMFrame* frame) {
-    vm_oop_t rightObj = frame->Pop();
-    vm_oop_t leftObj  = frame->Pop();
-
-    CHECK_COERCION(rightObj, leftObj, "<");
+static vm_oop_t intLowerthan(vm_oop_t leftObj, vm_oop_t rightObj) {
+    CHECK_COERCION(rightObj);
 
     if (INT_VAL(leftObj) < INT_VAL(rightObj))
-        frame->Push(load_ptr(trueObject));
+        return load_ptr(trueObject);
     else
-        frame->Push(load_ptr(falseObject));
+        return load_ptr(falseObject);
 }
 
-void _Integer::AsString(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t self = frame->Pop();
+static vm_oop_t intAsString(vm_oop_t self) {
     long integer = INT_VAL(self);
     ostringstream Str;
     Str << integer;
-    frame->Push(GetUniverse()->NewString( Str.str()));
+    return GetUniverse()->NewString( Str.str());
 }
 
-void _Integer::Sqrt(VMObject* object, VMFrame* frame) {
-    vm_oop_t self = frame->Pop();
+static vm_oop_t intSqrt(vm_oop_t self) {
     double result = sqrt((double)INT_VAL(self));
 
     if (result == rint(result))
-        frame->Push(NEW_INT((int64_t) result));
+        return NEW_INT((int64_t) result);
     else
-        frame->Push(GetUniverse()->NewDouble(result));
+        return NEW_DOUBLE(result);
 }
 
-void _Integer::AtRandom(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t self = frame->Pop();
+static vm_oop_t intAtRandom(vm_oop_t self) {
     int64_t result = INT_VAL(self) * rand();
-    frame->Push(NEW_INT(result));
+    return NEW_INT(result);
+}
+
+static vm_oop_t intFromString(vm_oop_t /*clazz*/, vm_oop_t str) {
+    int64_t integer = atol(static_cast<VMString*>(str)->GetChars());
+    return NEW_INT(integer);
 }
 
-void _Integer::FromString(VMObject*, VMFrame* frame) {
-    VMString* self = (VMString*) frame->Pop();
-    frame->Pop();
+_Integer::_Integer() : PrimitiveContainer() {
+    srand((unsigned) time(nullptr));
+    SetPrimitive("plus",               new DirectRoutine(intPlus,       false, new Routine<_Integer>(this, &_Integer::Plus,       false)));
+    SetPrimitive("minus",              new DirectRoutine(intMinus,      false, new Routine<_Integer>(this, &_Integer::Minus,      false)));
+    SetPrimitive("star",               new DirectRoutine(intStar,       false, new Routine<_Integer>(this, &_Integer::Star,       false)));
+    SetPrimitive("bitAnd_",            new DirectRoutine(intBitwiseAnd, false));
+    SetPrimitive("bitXor_",            new DirectRoutine(intBitwiseXor, false));
+    SetPrimitive("lowerthanlowerthan", new DirectRoutine(intLeftShift,  false));
+    SetPrimitive("slash",              new DirectRoutine(intSlash,      false, new Routine<_Integer>(this, &_Integer::Slash,      false)));
+    SetPrimitive("slashslash",         new DirectRoutine(intSlashslash, false, new Routine<_Integer>(this, &_Integer::Slashslash, false)));
+    SetPrimitive("percent",            new DirectRoutine(intPercent,    false, new Routine<_Integer>(this, &_Integer::Percent,    false)));
+    SetPrimitive("and",                new DirectRoutine(intAnd,        false, new Routine<_Integer>(this, &_Integer::And,        false)));
+    SetPrimitive("equal",              new DirectRoutine(intEqual,      false, new Routine<_Integer>(this, &_Integer::Equal,      false)));
+    SetPrimitive("equalequal",         new DirectRoutine(intEqualEqual, false));
+    SetPrimitive("lowerthan",          new DirectRoutine(intLowerthan,  false, new Routine<_Integer>(this, &_Integer::Lowerthan,  false)));
+    SetPrimitive("asString",           new DirectRoutine(intAsString,   false));
+    SetPrimitive("sqrt",               new DirectRoutine(intSqrt,       false));
+    SetPrimitive("atRandom",           new DirectRoutine(intAtRandom,   false));
+    SetPrimitive("fromString_",        new DirectRoutine(intFromString, true));
+}
+
+//
+// fallbacks for Double arguments
+//
+
+void _Integer::resendAsDouble(const char* op, VMFrame* frame) {
+    VMDouble* right = static_cast<VMDouble*>(frame->Pop());
+    vm_oop_t left = frame->Pop();
+
+    VMDouble* leftDouble = GetUniverse()->NewDouble((double)INT_VAL(left));
+    vm_oop_t operands[] = {right};
+
+    leftDouble->Send(op, operands, 1);
+}
+
+void _Integer::Plus(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("+", frame);
+}
+
+void _Integer::Minus(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("-", frame);
+}
+
+void _Integer::Star(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("*", frame);
+}
+
+void _Integer::Slashslash(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("/", frame);
+}
 
-    int64_t integer = atol(self->GetChars());
-    vm_oop_t new_int = NEW_INT(integer);
-    frame->Push(new_int);
+void _Integer::Slash(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("/", frame);
 }
 
+void _Integer::Percent(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("%", frame);
+}
+
+void _Integer::And(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("&", frame);
+}
+
+void _Integer::Equal(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("=", frame);
+}
+
+void _Integer::Lowerthan(VMObject* /*object*/, VMFrame* frame) {
+    resendAsDouble("<", frame);
+}
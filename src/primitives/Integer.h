@@ -33,29 +33,22 @@ class _Integer: public PrimitiveContainer {
 
 public:
 
+    // only called for Double arguments, the Integer cases are direct
+    // primitives
     void Plus(VMObject* object, VMFrame* frame);
     void Minus(VMObject* object, VMFrame* frame);
     void Star(VMObject* object, VMFrame* frame);
-    void BitwiseAnd(VMObject* object, VMFrame* frame);
-    void BitwiseXor(VMObject* object, VMFrame* frame);
-    void LeftShift(VMObject* object, VMFrame* frame);
     void Slash(VMObject* object, VMFrame* frame);
     void Slashslash(VMObject* object, VMFrame* frame);
     void Percent(VMObject* object, VMFrame* frame);
     void And(VMObject* object, VMFrame* frame);
     void Equal(VMObject* object, VMFrame* frame);
-    void EqualEqual(VMObject* object, VMFrame* frame);
     void Lowerthan(VMObject* object, VMFrame* frame);
-    void AsString(VMObject* object, VMFrame* frame);
-    void Sqrt(VMObject* object, VMFrame* frame);
-    void AtRandom(VMObject* object, VMFrame* frame);
-
-    void FromString(VMObject* object, VMFrame* frame);
 
     _Integer(void);
 
 private:
 
-    void resendAsDouble(const char* op, vm_oop_t left, VMDouble* right);
+    void resendAsDouble(const char* op, VMFrame* frame);
 
 };
@@ -71,6 +71,8 @@ void _Object::Hashcode(VMObject* /*object*/, VMFrame* frame) {
 
     if (IS_TAGGED(self))
         frame->Push(self);
+    else if (IS_TAGGED_DOUBLE(self))
+        frame->Push(NEW_INT((int64_t) self >> 3));
     else
         frame->Push(NEW_INT(AS_OBJ(self)->GetHash()));
 }
@@ -38,78 +38,60 @@
 #include "String.h"
 #include "../primitivesCore/Routine.h"
 
-_String::_String() : PrimitiveContainer() {
-    SetPrimitive("concatenate_", new Routine<_String>(this, &_String::Concatenate_, false));
-    SetPrimitive("asSymbol",     new Routine<_String>(this, &_String::AsSymbol, false));
-    SetPrimitive("hashcode",     new Routine<_String>(this, &_String::Hashcode, false));
-    SetPrimitive("length",       new Routine<_String>(this, &_String::Length,   false));
-    SetPrimitive("equal",        new Routine<_String>(this, &_String::Equal,    false));
-    SetPrimitive("primSubstringFrom_to_", new Routine<_String>(this, &_String::PrimSubstringFrom_to_, false));
-}
-
-void _String::Concatenate_(VMObject* /*object*/, VMFrame* frame) {
-    VMString* arg  = static_cast<VMString*>(frame->Pop());
-    VMString* self = static_cast<VMString*>(frame->Pop());
-    StdString a = arg->GetChars();
-    StdString s = self->GetChars();
+static vm_oop_t strConcatenate_(vm_oop_t self, vm_oop_t arg) {
+    StdString a = static_cast<VMString*>(arg)->GetChars();
+    StdString s = static_cast<VMString*>(self)->GetChars();
 
     StdString result = s + a;
 
-    frame->Push(GetUniverse()->NewString(result));
+    return GetUniverse()->NewString(result);
 }
 
-void _String::AsSymbol(VMObject* /*object*/, VMFrame* frame) {
-    VMString* self = static_cast<VMString*>(frame->Pop());
-    StdString result = self->GetStdString();
-    frame->Push(GetUniverse()->SymbolFor(result));
+static vm_oop_t strAsSymbol(vm_oop_t self) {
+    StdString result = static_cast<VMString*>(self)->GetStdString();
+    return GetUniverse()->SymbolFor(result);
 }
 
-void _String::Hashcode(VMObject* /*object*/, VMFrame* frame) {
-    VMString* self = static_cast<VMString*>(frame->Pop());
-    frame->Push(NEW_INT(self->GetHash()));
+static vm_oop_t strHashcode(vm_oop_t self) {
+    return NEW_INT(static_cast<VMString*>(self)->GetHash());
 }
 
-void _String::Length(VMObject* /*object*/, VMFrame* frame) {
-    VMString* self = static_cast<VMString*>(frame->Pop());
-
-    size_t len = self->GetStringLength();
-    frame->Push(NEW_INT(len));
+static vm_oop_t strLength(vm_oop_t self) {
+    size_t len = static_cast<VMString*>(self)->GetStringLength();
+    return NEW_INT(len);
 }
 
-void _String::Equal(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t op1 = frame->Pop();
-    VMString* op2 = static_cast<VMString*>(frame->Pop());
-
-    if (IS_TAGGED(op1)) {
-        frame->Push(load_ptr(falseObject));
-        return;
-    }
+static vm_oop_t strEqual(vm_oop_t self, vm_oop_t op1) {
+    if (IS_IMMEDIATE(op1))
+        return load_ptr(falseObject);
 
     VMClass* otherClass = CLASS_OF(op1);
     if(otherClass == load_ptr(stringClass)) {
         StdString s1 = static_cast<VMString*>(op1)->GetStdString();
-        StdString s2 = op2->GetStdString();
+        StdString s2 = static_cast<VMString*>(self)->GetStdString();
 
-        if(s1 == s2) {
-            frame->Push(load_ptr(trueObject));
-            return;
-        }
+        if(s1 == s2)
+            return load_ptr(trueObject);
     }
-    frame->Push(load_ptr(falseObject));
+    return load_ptr(falseObject);
 }
 
-void _String::PrimSubstringFrom_to_(VMObject* /*object*/, VMFrame* frame) {
-    vm_oop_t end   = frame->Pop();
-    vm_oop_t start = frame->Pop();
-
-    VMString* self = static_cast<VMString*>(frame->Pop());
-    StdString str = self->GetStdString();
+static vm_oop_t strPrimSubstringFrom_to_(vm_oop_t self, vm_oop_t start, vm_oop_t end) {
+    StdString str = static_cast<VMString*>(self)->GetStdString();
 
     long s = INT_VAL(start) - 1;
     long e = INT_VAL(end) - 1;
 
     StdString result = str.substr(s, e - s + 1);
 
-    frame->Push( GetUniverse()->NewString(result));
+    return GetUniverse()->NewString(result);
 }
 
+_String::_String() : PrimitiveContainer() {
+    SetPrimitive("concatenate_", new DirectRoutine(strConcatenate_, false));
+    SetPrimitive("asSymbol",     new DirectRoutine(strAsSymbol,     false));
+    SetPrimitive("hashcode",     new DirectRoutine(strHashcode,     false));
+    SetPrimitive("length",       new DirectRoutine(strLength,       false));
+    SetPrimitive("equal",        new DirectRoutine(strEqual,        false));
+    SetPrimitive("primSubstringFrom_to_", new DirectRoutine(strPrimSubstringFrom_to_, false));
+}
@@ -32,10 +32,4 @@
 class _String: public PrimitiveContainer {
 public:
     _String();
-    void Concatenate_(VMObject* object, VMFrame* frame);
-    void AsSymbol(VMObject* object, VMFrame* frame);
-    void Hashcode(VMObject* object, VMFrame* frame);
-    void Length(VMObject* object, VMFrame* frame);
-    void Equal(VMObject* object, VMFrame* frame);
-    void PrimSubstringFrom_to_(VMObject* object, VMFrame* frame);
 };
@@ -52,3 +52,33 @@ public:
     virtual bool isClassSide() { return classSide; }
 
 };
+
+///Implementation for primitives written for the direct calling convention.
+//Invoked through the frame, it pops the receiver and arguments and pushes
+//the result. Primitives that can fail are given a fallback routine that
+//handles the general case.
+class DirectRoutine: public PrimitiveRoutine {
+private:
+    PrimitiveRoutine* const fallback;
+    const bool              classSide;
+
+public:
+    template<class FN>
+    DirectRoutine(FN fn, bool classSide, PrimitiveRoutine* fallback = nullptr)
+    : fallback(fallback), classSide(classSide), PrimitiveRoutine() {
+        SetDirect(fn);
+    }
+
+    virtual void operator()(VMObject* obj, VMFrame* frm) {
+        vm_oop_t result = InvokeDirect((gc_oop_t*) frm->GetStackPointer());
+        if (result == nullptr) {
+            (*fallback)(obj, frm);
+            return;
+        }
+        for (long i = 0; i <= GetDirectArity(); ++i)
+            frm->Pop();
+        frm->Push(result);
+    }
+
+    virtual bool isClassSide() { return classSide; }
+};
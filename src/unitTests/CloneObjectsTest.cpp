@@ -196,6 +196,17 @@ void CloneObjectsTest::testCloneMethod() {
 
     CPPUNIT_ASSERT_EQUAL_MESSAGE("GetHolder() differs!!", orig->GetHolder(), clone->GetHolder());
     CPPUNIT_ASSERT_EQUAL_MESSAGE("GetSignature() differs!!", orig->GetSignature(), clone->GetSignature());
+
+    // the interpreter owns threaded code, a clone has to be threaded again
+    ThreadedOp code[1];
+    void* const targets[1] = { nullptr };
+    orig->threadedCode    = code;
+    orig->threadedTargets = targets;
+    clone = orig->Clone();
+    CPPUNIT_ASSERT(clone->threadedCode == nullptr);
+    CPPUNIT_ASSERT(clone->threadedTargets == nullptr);
+    orig->threadedCode    = nullptr;
+    orig->threadedTargets = nullptr;
 }
 
 void CloneObjectsTest::testCloneClass() {
@@ -0,0 +1,80 @@
+/*
+ * Evaluate.cpp
+ *
+ * Runs SOM code from the unit tests, like the shell runs its statements.
+ */
+
+#include "Evaluate.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#define private public
+
+#include "vm/Universe.h"
+#include "interpreter/Interpreter.h"
+#include "interpreter/bytecodes.h"
+#include "vmobjects/VMClass.h"
+#include "vmobjects/VMFrame.h"
+#include "vmobjects/VMInvokable.h"
+#include "vmobjects/VMMethod.h"
+#include "vmobjects/VMSymbol.h"
+
+void DefineClass(const StdString& source) {
+    StdString statement = source;
+    VMClass* clazz = GetUniverse()->LoadShellClass(statement);
+    CPPUNIT_ASSERT_MESSAGE("can't compile " + source, clazz != nullptr);
+    GetUniverse()->SetGlobal(clazz->GetName(), clazz);
+}
+
+static VMClass* lookupClass(const StdString& className) {
+    VMClass* clazz = static_cast<VMClass*>(
+            GetUniverse()->GetGlobal(GetUniverse()->SymbolFor(className)));
+    CPPUNIT_ASSERT_MESSAGE("no class " + className, clazz != nullptr);
+    return clazz;
+}
+
+vm_oop_t Evaluate(const StdString& className, const StdString& selector) {
+    VMClass* clazz = lookupClass(className);
+    VMInvokable* invokable = clazz->LookupInvokable(GetUniverse()->SymbolFor(selector));
+    CPPUNIT_ASSERT_MESSAGE("no method " + selector, invokable != nullptr);
+
+    // a bootstrap frame of its own, which halts the interpreter once the
+    // method returns to it, like the one of Universe::initialize()
+    VMMethod* bootstrapMethod = GetUniverse()->NewMethod(GetUniverse()->SymbolFor("bootstrap"), 1, 0);
+    bootstrapMethod->SetBytecode(0, BC_HALT);
+    bootstrapMethod->SetNumberOfLocals(0);
+    bootstrapMethod->SetMaximumNumberOfStackElements(2);
+    bootstrapMethod->SetHolder(load_ptr(systemClass));
+
+    Interpreter* interpreter = GetUniverse()->GetInterpreter();
+    VMFrame* frame = interpreter->PushNewFrame(bootstrapMethod);
+    frame->Push(GetUniverse()->NewInstance(clazz));
+    (*invokable)(frame);
+    interpreter->Start();
+
+    vm_oop_t result = interpreter->GetFrame()->Pop();
+    interpreter->popFrame();
+    return result;
+}
+
+VMMethod* LookupMethod(const StdString& className, const StdString& selector) {
+    VMInvokable* invokable = lookupClass(className)->LookupInvokable(
+                                    GetUniverse()->SymbolFor(selector));
+    CPPUNIT_ASSERT_MESSAGE("no method " + selector,
+                           invokable != nullptr && !invokable->IsPrimitive());
+    return static_cast<VMMethod*>(invokable);
+}
+
+long FindSend(VMMethod* method, const StdString& selector) {
+    long numberOfBytecodes = method->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes;
+         i += Bytecode::GetBytecodeLength(method->GetBytecode(i))) {
+        uint8_t bc = method->GetBytecode(i);
+        if (bc != BC_SEND && (bc < BC_SEND_INT_ADD || bc > BC_SEND_BLOCK))
+            continue;
+        VMSymbol* signature = static_cast<VMSymbol*>(method->GetConstant(i));
+        if (signature->GetStdString() == selector)
+            return i;
+    }
+    return -1;
+}
@@ -0,0 +1,25 @@
+#pragma once
+/*
+ * Evaluate.h
+ *
+ * Runs SOM code from the unit tests, like the shell runs its statements.
+ */
+
+#include "misc/defs.h"
+#include "vmobjects/ObjectFormats.h"
+
+// Compiles a class from its source, and makes it a global of its name. The
+// interpreter may move the class, so it is looked up by name afterwards.
+void DefineClass(const StdString& source);
+
+// Sends the unary selector to a new instance of the class defined before,
+// and returns the result once the interpreter ran the method. It may move
+// objects, so pointers held across the call are stale.
+vm_oop_t Evaluate(const StdString& className, const StdString& selector);
+
+// The method of a class defined before, looked up by name like in Evaluate()
+VMMethod* LookupMethod(const StdString& className, const StdString& selector);
+
+// the index of the first send of selector in method, whether quickened or
+// not, or -1 if there is none
+long FindSend(VMMethod* method, const StdString& selector);
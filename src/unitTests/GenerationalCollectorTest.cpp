@@ -0,0 +1,250 @@
+/*
+ * GenerationalCollectorTest.cpp
+ *
+ * Runs minor collections on hand-made object graphs.
+ */
+
+#include "GenerationalCollectorTest.h"
+#include "Evaluate.h"
+
+#define private public
+#define protected public
+
+#include "memory/GenerationalHeap.h"
+#include "memory/GenerationalCollector.h"
+#include "vm/Universe.h"
+#include "vmobjects/VMArray.h"
+#include "vmobjects/VMString.h"
+
+// an array in the mature space, as if promoted by an earlier collection
+static VMArray* newOldArray(long length) {
+    VMArray* arr = new (GetHeap<HEAP_CLS>(), length * sizeof(VMObject*) ALLOC_MATURE) VMArray(length);
+    arr->SetGCField(MASK_OBJECT_IS_OLD);
+    arr->SetClass(load_ptr(arrayClass));
+    return arr;
+}
+
+static void minorCollection(bool tenureAll = false) {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    static_cast<GenerationalCollector*>(heap->gc)->MinorCollection(tenureAll);
+}
+
+static bool isDirty(const void* address) {
+    return GetHeap<GenerationalHeap>()->cardTable.IsDirty(address);
+}
+
+static void cleanCards(AbstractVMObject* obj) {
+    CardTable& cards = GetHeap<GenerationalHeap>()->cardTable;
+    char* end = (char*) obj + obj->GetObjectSize();
+    for (char* card = CardTable::GetCardStart(obj); card < end; card += CARD_SIZE)
+        cards.CleanCard(cards.cardOf(card));
+}
+
+// the indexable fields follow the array, like in VMArray::Clone()
+static gc_oop_t* indexableField(VMArray* arr, long idx) {
+    return (gc_oop_t*) SHIFTED_PTR(arr, sizeof(VMArray)) + idx;
+}
+
+void GenerationalCollectorTest::testFieldVisitedTwice() {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    VMString* young = GetUniverse()->NewString("young");
+    CPPUNIT_ASSERT(heap->isObjectInNursery(young));
+
+    // a small array spanning two dirty cards is walked once for each card
+    long length = CARD_SIZE / sizeof(VMObject*) + 1;
+    VMArray* twice = newOldArray(length);
+    twice->SetIndexableField(0, young);
+    twice->SetIndexableField(length - 1, young);
+    CPPUNIT_ASSERT(!PagedSpace::IsLargeObject(twice));
+    CPPUNIT_ASSERT(CardTable::GetCardStart(indexableField(twice, 0))
+                != CardTable::GetCardStart(indexableField(twice, length - 1)));
+
+    VMArray* once = newOldArray(1);
+    once->SetIndexableField(0, young);
+
+    minorCollection();
+
+    vm_oop_t survivor = once->GetIndexableField(0);
+    CPPUNIT_ASSERT(survivor != young);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("survivor copied twice", survivor, twice->GetIndexableField(0));
+    CPPUNIT_ASSERT_EQUAL(survivor, twice->GetIndexableField(length - 1));
+    CPPUNIT_ASSERT(heap->isObjectInToSpace(AS_OBJ(survivor)));
+    CPPUNIT_ASSERT_EQUAL(StdString("young"), static_cast<VMString*>(survivor)->GetStdString());
+}
+
+void GenerationalCollectorTest::testBarrierMarksCards() {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    VMString* young = GetUniverse()->NewString("young");
+    long length = 4 * CARD_SIZE / sizeof(VMObject*);
+    VMArray* arr = newOldArray(length);
+    CPPUNIT_ASSERT(PagedSpace::IsLargeObject(arr));
+    cleanCards(arr);
+    long hits = heap->writeBarrierHits;
+
+    // old objects do not need to be remembered
+    arr->SetIndexableField(length - 1, load_ptr(nilObject));
+    CPPUNIT_ASSERT(!isDirty(indexableField(arr, length - 1)));
+    CPPUNIT_ASSERT_EQUAL(hits, heap->writeBarrierHits);
+
+    // an element store only marks the card of the element
+    arr->SetIndexableField(length - 1, young);
+    CPPUNIT_ASSERT(isDirty(indexableField(arr, length - 1)));
+    CPPUNIT_ASSERT(!isDirty(arr));
+    CPPUNIT_ASSERT(!isDirty(indexableField(arr, length / 2)));
+    CPPUNIT_ASSERT_EQUAL(hits + 1, heap->writeBarrierHits);
+
+    // other stores mark the card of the header
+    cleanCards(arr);
+    arr->SetField(arr->GetNumberOfFields() + length / 2, young);
+    CPPUNIT_ASSERT(isDirty(arr));
+    CPPUNIT_ASSERT(!isDirty(indexableField(arr, length / 2)));
+    CPPUNIT_ASSERT_EQUAL(hits + 2, heap->writeBarrierHits);
+
+    // a collection would miss the young elements on the clean cards
+    arr->SetIndexableField(length - 1, load_ptr(nilObject));
+    arr->SetField(arr->GetNumberOfFields() + length / 2, load_ptr(nilObject));
+}
+
+void GenerationalCollectorTest::testCardKeepsSurvivor() {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    VMArray* arr = newOldArray(1);
+    arr->SetIndexableField(0, GetUniverse()->NewString("survivor"));
+
+    // the card stays dirty as long as the element is young
+    for (long i = 0; i < GenerationalHeap::maxTenuringAge; i++) {
+        minorCollection();
+        vm_oop_t survivor = arr->GetIndexableField(0);
+        CPPUNIT_ASSERT(heap->isObjectInToSpace(AS_OBJ(survivor)));
+        CPPUNIT_ASSERT(isDirty(indexableField(arr, 0)));
+        CPPUNIT_ASSERT_EQUAL(StdString("survivor"), static_cast<VMString*>(survivor)->GetStdString());
+    }
+
+    minorCollection(true);
+    vm_oop_t promoted = arr->GetIndexableField(0);
+    CPPUNIT_ASSERT(!heap->isObjectInNursery(promoted));
+    CPPUNIT_ASSERT(!isDirty(indexableField(arr, 0)));
+    CPPUNIT_ASSERT_EQUAL(StdString("survivor"), static_cast<VMString*>(promoted)->GetStdString());
+}
+
+void GenerationalCollectorTest::testLargeArrayCard() {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    long length = 4 * CARD_SIZE / sizeof(VMObject*);
+    VMArray* arr = newOldArray(length);
+    cleanCards(arr);
+    arr->SetIndexableField(length - 1, GetUniverse()->NewString("element"));
+
+    minorCollection();
+
+    // only the card of the element is scanned, and stays dirty
+    vm_oop_t survivor = arr->GetIndexableField(length - 1);
+    CPPUNIT_ASSERT(heap->isObjectInToSpace(AS_OBJ(survivor)));
+    CPPUNIT_ASSERT_EQUAL(StdString("element"), static_cast<VMString*>(survivor)->GetStdString());
+    CPPUNIT_ASSERT(isDirty(indexableField(arr, length - 1)));
+    CPPUNIT_ASSERT(!isDirty(arr));
+}
+
+// builds and drops lists, while some of them survive a few rounds
+static const char* resizeWorkload =
+    "ResizeWorkload = ("
+    "    run = ("
+    "        | list keep sum |"
+    "        keep := Array new: 10."
+    "        sum := 0."
+    "        1 to: 200 do: [:round |"
+    "            list := nil."
+    "            1 to: 1000 do: [:i | | cell |"
+    "                cell := Array new: 2. cell at: 1 put: list. cell at: 2 put: i."
+    "                list := cell ]."
+    "            keep at: round % 10 + 1 put: list."
+    "            [ list notNil ] whileTrue: ["
+    "                sum := sum + (list at: 2). list := list at: 1 ] ]."
+    "        ^ sum"
+    "    )"
+    ")";
+
+void GenerationalCollectorTest::testResizeWithSurvivors() {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    GenerationalCollector* collector = static_cast<GenerationalCollector*>(heap->gc);
+    size_t initialSize = heap->nurserySize;
+    size_t smallSize = 256 * 1024;
+    CPPUNIT_ASSERT(initialSize != smallSize);
+
+    // young objects referred to by an old one, which a global keeps alive in
+    // case the collection is a major one
+    VMArray* holder = newOldArray(2);
+    VMArray* nested = GetUniverse()->NewArray(1);
+    nested->SetIndexableField(0, GetUniverse()->NewString("nested"));
+    holder->SetIndexableField(0, GetUniverse()->NewString("survivor"));
+    holder->SetIndexableField(1, nested);
+    GetUniverse()->SetGlobal(GetUniverse()->SymbolFor("ResizeHolder"), holder);
+
+    collector->pendingNurserySize = smallSize;
+    collector->Collect();
+    CPPUNIT_ASSERT_EQUAL(smallSize, heap->nurserySize);
+
+    // the survivors were promoted before the old nursery was freed
+    vm_oop_t survivor = holder->GetIndexableField(0);
+    nested = static_cast<VMArray*>(holder->GetIndexableField(1));
+    CPPUNIT_ASSERT(!heap->isObjectInNursery(survivor));
+    CPPUNIT_ASSERT(!heap->isObjectInNursery(nested));
+    CPPUNIT_ASSERT_EQUAL(StdString("survivor"), static_cast<VMString*>(survivor)->GetStdString());
+    CPPUNIT_ASSERT_EQUAL(StdString("nested"),
+            static_cast<VMString*>(nested->GetIndexableField(0))->GetStdString());
+
+    // many collections in the new nursery
+    DefineClass(resizeWorkload);
+    vm_oop_t sum = Evaluate("ResizeWorkload", "run");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 200 * 500500, (int64_t) INT_VAL(sum));
+    CPPUNIT_ASSERT_EQUAL(StdString("survivor"),
+            static_cast<VMString*>(holder->GetIndexableField(0))->GetStdString());
+
+    collector->pendingNurserySize = initialSize;
+    collector->Collect();
+    CPPUNIT_ASSERT_EQUAL(initialSize, heap->nurserySize);
+}
+
+// the nursery grows when minor collections take too long, and shrinks back
+// when they are cheap and hardly anything survives them
+void GenerationalCollectorTest::testAdaptNurserySize() {
+    GenerationalHeap* heap = GetHeap<GenerationalHeap>();
+    GenerationalCollector* collector = static_cast<GenerationalCollector*>(heap->gc);
+    size_t nurserySize = heap->nurserySize;
+    double overhead = collector->minorSizing.overhead;
+    double survivalRate = collector->survivalRate;
+    size_t maxHeapSize = HeapSizing::maxHeapSize;
+    HeapSizing::maxHeapSize = 0;
+
+    collector->minorSizing.overhead = 0.5;
+    collector->pendingNurserySize = 0;
+    collector->adaptNurserySize();
+    CPPUNIT_ASSERT_EQUAL(nurserySize * 2, collector->pendingNurserySize);
+
+    // not beyond half of the maximum heap size
+    HeapSizing::maxHeapSize = nurserySize * 3;
+    collector->pendingNurserySize = 0;
+    collector->adaptNurserySize();
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, collector->pendingNurserySize);
+    HeapSizing::maxHeapSize = 0;
+
+    // many survivors keep the nursery large, even if collecting it is cheap
+    heap->nurserySize = heap->initialNurserySize * 4;
+    collector->minorSizing.overhead = 0.0;
+    collector->survivalRate = 0.5;
+    collector->adaptNurserySize();
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, collector->pendingNurserySize);
+
+    collector->survivalRate = 0.01;
+    collector->adaptNurserySize();
+    CPPUNIT_ASSERT_EQUAL(heap->initialNurserySize * 2, collector->pendingNurserySize);
+
+    // but not below the initial size
+    heap->nurserySize = heap->initialNurserySize;
+    collector->pendingNurserySize = 0;
+    collector->adaptNurserySize();
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, collector->pendingNurserySize);
+
+    heap->nurserySize = nurserySize;
+    collector->minorSizing.overhead = overhead;
+    collector->survivalRate = survivalRate;
+    HeapSizing::maxHeapSize = maxHeapSize;
+}
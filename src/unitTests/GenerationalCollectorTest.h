@@ -0,0 +1,31 @@
+#pragma once
+/*
+ * GenerationalCollectorTest.h
+ *
+ * Runs minor collections on hand-made object graphs.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class GenerationalCollectorTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (GenerationalCollectorTest);
+    CPPUNIT_TEST (testFieldVisitedTwice);
+    CPPUNIT_TEST (testBarrierMarksCards);
+    CPPUNIT_TEST (testCardKeepsSurvivor);
+    CPPUNIT_TEST (testLargeArrayCard);
+    CPPUNIT_TEST (testResizeWithSurvivors);
+    CPPUNIT_TEST (testAdaptNurserySize);CPPUNIT_TEST_SUITE_END();
+
+public:
+    inline void setUp(void) {
+    }
+    inline void tearDown(void) {
+    }
+private:
+    void testFieldVisitedTwice();
+    void testBarrierMarksCards();
+    void testCardKeepsSurvivor();
+    void testLargeArrayCard();
+    void testResizeWithSurvivors();
+    void testAdaptNurserySize();
+};
@@ -0,0 +1,122 @@
+/*
+ * HeapSizingTest.cpp
+ *
+ * Checks how the sizing policy of the heaps follows the measured GC overhead.
+ */
+
+#include "HeapSizingTest.h"
+
+#define private public
+
+#include "memory/HeapSizing.h"
+#include "misc/Timer.h"
+
+#define MB (1024 * 1024)
+
+void HeapSizingTest::setUp() {
+    maxHeapSize      = HeapSizing::maxHeapSize;
+    targetGCOverhead = HeapSizing::targetGCOverhead;
+    HeapSizing::maxHeapSize      = 0;
+    HeapSizing::targetGCOverhead = DEFAULT_TARGET_GC_OVERHEAD;
+}
+
+void HeapSizingTest::tearDown() {
+    HeapSizing::maxHeapSize      = maxHeapSize;
+    HeapSizing::targetGCOverhead = targetGCOverhead;
+}
+
+// the headroom doubles with every collection over the target, up to the maximum
+void HeapSizingTest::testGrowth() {
+    HeapSizing sizing(0);
+    sizing.overhead = 0.5;
+    CPPUNIT_ASSERT(sizing.IsOverTarget());
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 3 * MB,  sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 5 * MB,  sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 9 * MB,  sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 17 * MB, sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 17 * MB, sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL(MAX_HEADROOM, sizing.headroom);
+}
+
+// and halves below a quarter of the target, down to the minimum
+void HeapSizingTest::testShrinking() {
+    HeapSizing sizing(0);
+    sizing.overhead = 0.0;
+    CPPUNIT_ASSERT(sizing.IsUnderTarget());
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 6 * MB, sizing.NextLimit(4 * MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 5 * MB, sizing.NextLimit(4 * MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 5 * MB, sizing.NextLimit(4 * MB));
+    CPPUNIT_ASSERT_EQUAL(MIN_HEADROOM, sizing.headroom);
+}
+
+void HeapSizingTest::testWithinTarget() {
+    HeapSizing sizing(0);
+    sizing.overhead = 0.02;
+    CPPUNIT_ASSERT(!sizing.IsOverTarget());
+    CPPUNIT_ASSERT(!sizing.IsUnderTarget());
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 2 * MB, sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 8 * MB, sizing.NextLimit(4 * MB));
+    CPPUNIT_ASSERT_EQUAL(INITIAL_HEADROOM, sizing.headroom);
+
+    // a higher target turns the same overhead into a reason to shrink
+    HeapSizing::targetGCOverhead = 10;
+    CPPUNIT_ASSERT(sizing.IsUnderTarget());
+}
+
+void HeapSizingTest::testMinimumSize() {
+    HeapSizing sizing(4 * MB);
+    sizing.overhead = 0.02;
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 4 * MB, sizing.NextLimit(0));
+    CPPUNIT_ASSERT_EQUAL((size_t) 4 * MB, sizing.NextLimit(MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 6 * MB, sizing.NextLimit(3 * MB));
+}
+
+void HeapSizingTest::testMaxHeapSize() {
+    HeapSizing sizing(0);
+    sizing.overhead = 0.5;
+    HeapSizing::maxHeapSize = 10 * MB;
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 9 * MB,  sizing.NextLimit(3 * MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 10 * MB, sizing.NextLimit(3 * MB));
+    CPPUNIT_ASSERT_EQUAL((size_t) 10 * MB, sizing.NextLimit(10 * MB));
+}
+
+// the policy measures process time, so waiting has to keep the processor busy
+static void busyWait(int64_t microseconds) {
+    int64_t end = get_microseconds() + microseconds;
+    while (get_microseconds() < end)
+        ;
+}
+
+// a slow collection raises the overhead, the mutator time after it lowers it again
+void HeapSizingTest::testOverheadDecays() {
+    HeapSizing sizing(0);
+    sizing.lastCollectionEnd = get_microseconds();
+
+    sizing.CollectionStarted();
+    busyWait(20000);
+    sizing.CollectionFinished();
+    double afterCollection = sizing.GetGCOverhead();
+    CPPUNIT_ASSERT(afterCollection > 0.5);
+    CPPUNIT_ASSERT(afterCollection <= 1.0);
+    CPPUNIT_ASSERT(sizing.IsOverTarget());
+
+    busyWait(200000);
+    sizing.CollectionStarted();
+    sizing.CollectionFinished();
+    double afterIdle = sizing.GetGCOverhead();
+    CPPUNIT_ASSERT(afterIdle < afterCollection * OVERHEAD_DECAY);
+    CPPUNIT_ASSERT(afterIdle < 0.2);
+
+    // with more cheap collections the slow one is forgotten
+    for (int i = 0; i < 20; i++) {
+        busyWait(10000);
+        sizing.CollectionStarted();
+        sizing.CollectionFinished();
+    }
+    CPPUNIT_ASSERT(sizing.IsUnderTarget());
+}
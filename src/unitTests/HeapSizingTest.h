@@ -0,0 +1,32 @@
+#pragma once
+/*
+ * HeapSizingTest.h
+ *
+ * Checks how the sizing policy of the heaps follows the measured GC overhead.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class HeapSizingTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (HeapSizingTest);
+    CPPUNIT_TEST (testGrowth);
+    CPPUNIT_TEST (testShrinking);
+    CPPUNIT_TEST (testWithinTarget);
+    CPPUNIT_TEST (testMinimumSize);
+    CPPUNIT_TEST (testMaxHeapSize);
+    CPPUNIT_TEST (testOverheadDecays);CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp(void);
+    void tearDown(void);
+private:
+    void testGrowth();
+    void testShrinking();
+    void testWithinTarget();
+    void testMinimumSize();
+    void testMaxHeapSize();
+    void testOverheadDecays();
+
+    size_t maxHeapSize;
+    long   targetGCOverhead;
+};
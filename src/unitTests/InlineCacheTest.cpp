@@ -0,0 +1,165 @@
+/*
+ * InlineCacheTest.cpp
+ *
+ * The states of an inline cache, and the caches of send sites in methods
+ * run by the interpreter.
+ */
+
+#include "InlineCacheTest.h"
+#include "Evaluate.h"
+
+#define private public
+#define protected public
+
+#include "vm/Universe.h"
+#include "vmobjects/InlineCache.h"
+#include "vmobjects/VMArray.h"
+#include "vmobjects/VMClass.h"
+#include "vmobjects/VMMethod.h"
+#include "vmobjects/VMSymbol.h"
+
+// every site sees its own receivers, the classes are defined only once
+static const char* cacheSites =
+    "CacheSites = ("
+    "    monoClassOf: x = ( ^ x class )"
+    "    polyClassOf: x = ( ^ x class )"
+    "    megaClassOf: x = ( ^ x class )"
+    "    mono = ( | r | 1 to: 10 do: [:i | r := self monoClassOf: i ]. ^ r )"
+    "    poly = ( | r |"
+    "        r := Array new: 3."
+    "        r at: 1 put: (self polyClassOf: 1)."
+    "        r at: 2 put: (self polyClassOf: 'a')."
+    "        r at: 3 put: (self polyClassOf: #a)."
+    "        ^ r )"
+    "    mega = ( | r |"
+    "        r := Array new: 6."
+    "        r at: 1 put: (self megaClassOf: 1)."
+    "        r at: 2 put: (self megaClassOf: 'a')."
+    "        r at: 3 put: (self megaClassOf: #a)."
+    "        r at: 4 put: (self megaClassOf: nil)."
+    "        r at: 5 put: (self megaClassOf: true)."
+    "        r at: 6 put: (self megaClassOf: (Array new: 1))."
+    "        ^ r )"
+    ")";
+
+void InlineCacheTest::setUp() {
+    if (!GetUniverse()->HasGlobal(GetUniverse()->SymbolFor("CacheSites")))
+        DefineClass(cacheSites);
+}
+
+static VMInvokable* lookup(GCClass* clazz, const char* selector) {
+    return load_ptr(clazz)->LookupInvokable(GetUniverse()->SymbolFor(selector));
+}
+
+static InlineCache* cacheOf(const char* selector) {
+    VMMethod* method = LookupMethod("CacheSites", selector);
+    long site = FindSend(method, "class");
+    CPPUNIT_ASSERT(site >= 0);
+    InlineCache* cache = method->GetInlineCache(site);
+    CPPUNIT_ASSERT(cache != nullptr);
+    return cache;
+}
+
+static VMClass* elementOf(vm_oop_t result, long idx) {
+    return static_cast<VMClass*>(static_cast<VMArray*>(result)->GetIndexableField(idx));
+}
+
+void InlineCacheTest::testStates() {
+    GCClass* classes[] = { integerClass, stringClass, symbolClass, nilClass, arrayClass };
+    const char* selectors[] = { "global:", "hasGlobal:", "load:", "exit:", "printString:" };
+    VMArray* holder = GetUniverse()->NewArray(0);
+
+    InlineCache cache;
+    cache.Clear();
+    CPPUNIT_ASSERT_EQUAL(InlineCache::EMPTY, cache.GetState());
+    CPPUNIT_ASSERT(cache.Lookup(load_ptr(integerClass)) == nullptr);
+
+    cache.Update(holder, load_ptr(classes[0]), lookup(systemClass, selectors[0]));
+    CPPUNIT_ASSERT_EQUAL(InlineCache::MONOMORPHIC, cache.GetState());
+
+    for (long i = 1; i < INLINE_CACHE_SIZE; i++) {
+        cache.Update(holder, load_ptr(classes[i]), lookup(systemClass, selectors[i]));
+        CPPUNIT_ASSERT_EQUAL(InlineCache::POLYMORPHIC, cache.GetState());
+    }
+    for (long i = 0; i < INLINE_CACHE_SIZE; i++)
+        CPPUNIT_ASSERT(cache.Lookup(load_ptr(classes[i])) == lookup(systemClass, selectors[i]));
+
+    // one more class than it has entries for
+    cache.Update(holder, load_ptr(classes[4]), lookup(systemClass, selectors[4]));
+    CPPUNIT_ASSERT_EQUAL(InlineCache::MEGAMORPHIC, cache.GetState());
+    CPPUNIT_ASSERT(cache.Lookup(load_ptr(classes[4])) == nullptr);
+    CPPUNIT_ASSERT(cache.Lookup(load_ptr(classes[0])) == lookup(systemClass, selectors[0]));
+
+    // invalidated caches start over with the next update
+    InlineCache::InvalidateAll();
+    CPPUNIT_ASSERT_EQUAL(InlineCache::EMPTY, cache.GetState());
+    CPPUNIT_ASSERT(cache.Lookup(load_ptr(classes[0])) == nullptr);
+    cache.Update(holder, load_ptr(classes[4]), lookup(systemClass, selectors[4]));
+    CPPUNIT_ASSERT_EQUAL(InlineCache::MONOMORPHIC, cache.GetState());
+    CPPUNIT_ASSERT(cache.Lookup(load_ptr(classes[4])) == lookup(systemClass, selectors[4]));
+}
+
+void InlineCacheTest::testMonomorphicSite() {
+    vm_oop_t result = Evaluate("CacheSites", "mono");
+    CPPUNIT_ASSERT(result == load_ptr(integerClass));
+
+    InlineCache* cache = cacheOf("monoClassOf:");
+    CPPUNIT_ASSERT_EQUAL(InlineCache::MONOMORPHIC, cache->GetState());
+    CPPUNIT_ASSERT(cache->Lookup(load_ptr(integerClass)) == lookup(integerClass, "class"));
+
+    // the site fills up again after the caches are invalidated
+    InlineCache::InvalidateAll();
+    CPPUNIT_ASSERT_EQUAL(InlineCache::EMPTY, cacheOf("monoClassOf:")->GetState());
+    result = Evaluate("CacheSites", "mono");
+    CPPUNIT_ASSERT(result == load_ptr(integerClass));
+    CPPUNIT_ASSERT_EQUAL(InlineCache::MONOMORPHIC, cacheOf("monoClassOf:")->GetState());
+}
+
+void InlineCacheTest::testPolymorphicSite() {
+    vm_oop_t result = Evaluate("CacheSites", "poly");
+    CPPUNIT_ASSERT(elementOf(result, 0) == load_ptr(integerClass));
+    CPPUNIT_ASSERT(elementOf(result, 1) == load_ptr(stringClass));
+    CPPUNIT_ASSERT(elementOf(result, 2) == load_ptr(symbolClass));
+
+    InlineCache* cache = cacheOf("polyClassOf:");
+    CPPUNIT_ASSERT_EQUAL(InlineCache::POLYMORPHIC, cache->GetState());
+    CPPUNIT_ASSERT(cache->Lookup(load_ptr(integerClass)) != nullptr);
+    CPPUNIT_ASSERT(cache->Lookup(load_ptr(stringClass)) != nullptr);
+    CPPUNIT_ASSERT(cache->Lookup(load_ptr(symbolClass)) != nullptr);
+    CPPUNIT_ASSERT(cache->Lookup(load_ptr(arrayClass)) == nullptr);
+}
+
+void InlineCacheTest::testMegamorphicSite() {
+    vm_oop_t result = Evaluate("CacheSites", "mega");
+    CPPUNIT_ASSERT(elementOf(result, 0) == load_ptr(integerClass));
+    CPPUNIT_ASSERT(elementOf(result, 1) == load_ptr(stringClass));
+    CPPUNIT_ASSERT(elementOf(result, 2) == load_ptr(symbolClass));
+    CPPUNIT_ASSERT(elementOf(result, 3) == load_ptr(nilClass));
+    CPPUNIT_ASSERT(elementOf(result, 4) == load_ptr(trueClass));
+    CPPUNIT_ASSERT(elementOf(result, 5) == load_ptr(arrayClass));
+
+    // sends to the classes that did not fit are still looked up
+    InlineCache* cache = cacheOf("megaClassOf:");
+    CPPUNIT_ASSERT_EQUAL(InlineCache::MEGAMORPHIC, cache->GetState());
+    CPPUNIT_ASSERT(cache->Lookup(load_ptr(arrayClass)) == nullptr);
+    result = Evaluate("CacheSites", "mega");
+    CPPUNIT_ASSERT(elementOf(result, 5) == load_ptr(arrayClass));
+}
+
+/*
+ * A method added to a subclass shadows the inherited one the site has
+ * cached for the subclass already.
+ */
+void InlineCacheTest::testShadowingMethod() {
+    DefineClass("CacheBase = ( answer = ( ^ 1 ) )");
+    DefineClass("CacheSub = CacheBase ( )");
+    DefineClass("CacheDonor = ( answer = ( ^ 2 ) )");
+    DefineClass("CacheShadow = ( answerOf: x = ( ^ x answer ) run = ( ^ self answerOf: CacheSub new ) )");
+
+    CPPUNIT_ASSERT_EQUAL((int64_t) 1, (int64_t) INT_VAL(Evaluate("CacheShadow", "run")));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 1, (int64_t) INT_VAL(Evaluate("CacheShadow", "run")));
+
+    VMClass* sub = static_cast<VMClass*>(GetUniverse()->GetGlobal(GetUniverse()->SymbolFor("CacheSub")));
+    sub->AddInstanceInvokable(LookupMethod("CacheDonor", "answer"));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 2, (int64_t) INT_VAL(Evaluate("CacheShadow", "run")));
+}
@@ -0,0 +1,29 @@
+#pragma once
+/*
+ * InlineCacheTest.h
+ *
+ * The states of an inline cache, and the caches of send sites in methods
+ * run by the interpreter.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class InlineCacheTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (InlineCacheTest);
+    CPPUNIT_TEST (testStates);
+    CPPUNIT_TEST (testMonomorphicSite);
+    CPPUNIT_TEST (testPolymorphicSite);
+    CPPUNIT_TEST (testMegamorphicSite);
+    CPPUNIT_TEST (testShadowingMethod);CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp(void);
+    inline void tearDown(void) {
+    }
+private:
+    void testStates();
+    void testMonomorphicSite();
+    void testPolymorphicSite();
+    void testMegamorphicSite();
+    void testShadowingMethod();
+};
@@ -0,0 +1,101 @@
+/*
+ * InliningTest.cpp
+ *
+ * Checks which messages with literal blocks the parser compiles to jumps.
+ */
+
+#include "InliningTest.h"
+#include "Evaluate.h"
+
+#define private public
+#define protected public
+
+#include "compiler/MethodGenerationContext.h"
+#include "interpreter/bytecodes.h"
+#include "vm/Universe.h"
+#include "vmobjects/VMInteger.h"
+#include "vmobjects/VMClass.h"
+#include "vmobjects/VMMethod.h"
+#include "vmobjects/VMSymbol.h"
+
+// compiles body as the method test: of a new class
+static VMMethod* compileTestMethod(const char* body) {
+    StdString source = StdString("InliningTestClass = ( test: n = ( ") + body + " ) )";
+    VMClass* clazz = GetUniverse()->LoadShellClass(source);
+    CPPUNIT_ASSERT(clazz != nullptr);
+    return static_cast<VMMethod*>(clazz->LookupInvokable(GetUniverse()->SymbolFor("test:")));
+}
+
+static bool sends(VMMethod* method, const char* selector) {
+    VMSymbol* sym = GetUniverse()->SymbolFor(selector);
+    long numberOfBytecodes = method->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(method->GetBytecode(i))) {
+        if (method->GetBytecode(i) == BC_SEND && method->GetConstant(i) == sym)
+            return true;
+    }
+    return false;
+}
+
+static bool pushesBlock(VMMethod* method) {
+    long numberOfBytecodes = method->GetNumberOfBytecodes();
+    for (long i = 0; i < numberOfBytecodes; i += Bytecode::GetBytecodeLength(method->GetBytecode(i))) {
+        if (method->GetBytecode(i) == BC_PUSH_BLOCK)
+            return true;
+    }
+    return false;
+}
+
+void InliningTest::testToDoOnIntegerLiteral() {
+    VMMethod* method = compileTestMethod("| s | s := 0. 1 to: n do: [ :i | s := s + i ]. ^ s");
+    CPPUNIT_ASSERT_MESSAGE("to:do: on an Integer literal was not inlined", !sends(method, "to:do:"));
+    CPPUNIT_ASSERT_MESSAGE("block of an inlined to:do: still created", !pushesBlock(method));
+}
+
+void InliningTest::testToDoOnVariable() {
+    VMMethod* method = compileTestMethod("| s | s := 0. n to: 10 do: [ :i | s := s + i ]. ^ s");
+    CPPUNIT_ASSERT_MESSAGE("to:do: on a variable must be sent", sends(method, "to:do:"));
+    CPPUNIT_ASSERT_MESSAGE("block of a sent to:do: missing", pushesBlock(method));
+}
+
+void InliningTest::testToDoOnDoubleLiteral() {
+    VMMethod* method = compileTestMethod("1.5 to: n do: [ :i | i ]");
+    CPPUNIT_ASSERT_MESSAGE("to:do: on a Double literal must be sent", sends(method, "to:do:"));
+}
+
+void InliningTest::testToByDoOnExpression() {
+    VMMethod* method = compileTestMethod("(n + 1) to: 10 by: 2 do: [ :i | i ]");
+    CPPUNIT_ASSERT_MESSAGE("to:by:do: on an expression must be sent", sends(method, "to:by:do:"));
+
+    method = compileTestMethod("-3 to: n by: 2 do: [ :i | i ]");
+    CPPUNIT_ASSERT_MESSAGE("to:by:do: on a negative Integer literal was not inlined", !sends(method, "to:by:do:"));
+}
+
+void InliningTest::testTimesRepeat() {
+    VMMethod* method = compileTestMethod("3 timesRepeat: [ n ]");
+    CPPUNIT_ASSERT_MESSAGE("timesRepeat: on an Integer literal was not inlined", !sends(method, "timesRepeat:"));
+
+    method = compileTestMethod("n timesRepeat: [ n ]");
+    CPPUNIT_ASSERT_MESSAGE("timesRepeat: on a variable must be sent", sends(method, "timesRepeat:"));
+}
+
+void InliningTest::testWhileTrue() {
+    VMMethod* method = compileTestMethod("| i | i := 0. [ i < n ] whileTrue: [ i := i + 1 ]. ^ i");
+    CPPUNIT_ASSERT_MESSAGE("whileTrue: on literal blocks was not inlined", !sends(method, "whileTrue:"));
+    CPPUNIT_ASSERT_MESSAGE("blocks of an inlined whileTrue: still created", !pushesBlock(method));
+}
+
+// an inlined loop takes three locals and those of its block, and locals are
+// addressed by a byte
+void InliningTest::testManyLoops() {
+    StdString body = "| s | s := 0. ";
+    for (int i = 0; i < 30; i++)
+        body += "1 to: 10 do: [ :i | | a b c d e f g | a := i. s := s + a ]. ";
+    body += "^ s";
+    VMMethod* method = compileTestMethod(body.c_str());
+    CPPUNIT_ASSERT(method->GetNumberOfLocals() <= MAX_NUMBER_OF_LOCALS);
+    CPPUNIT_ASSERT_MESSAGE("to:do: without room for its locals must be sent", sends(method, "to:do:"));
+
+    DefineClass("ManyLoops = ( run = ( " + body + " ) )");
+    vm_oop_t sum = Evaluate("ManyLoops", "run");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 30 * 55, (int64_t) INT_VAL(sum));
+}
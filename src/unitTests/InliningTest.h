@@ -0,0 +1,33 @@
+#pragma once
+/*
+ * InliningTest.h
+ *
+ * Checks which messages with literal blocks the parser compiles to jumps.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class InliningTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (InliningTest);
+    CPPUNIT_TEST (testToDoOnIntegerLiteral);
+    CPPUNIT_TEST (testToDoOnVariable);
+    CPPUNIT_TEST (testToDoOnDoubleLiteral);
+    CPPUNIT_TEST (testToByDoOnExpression);
+    CPPUNIT_TEST (testTimesRepeat);
+    CPPUNIT_TEST (testWhileTrue);
+    CPPUNIT_TEST (testManyLoops);CPPUNIT_TEST_SUITE_END();
+
+public:
+    inline void setUp(void) {
+    }
+    inline void tearDown(void) {
+    }
+private:
+    void testToDoOnIntegerLiteral();
+    void testToDoOnVariable();
+    void testToDoOnDoubleLiteral();
+    void testToByDoOnExpression();
+    void testTimesRepeat();
+    void testWhileTrue();
+    void testManyLoops();
+};
@@ -0,0 +1,155 @@
+/*
+ * LargeObjectSpaceTest.cpp
+ *
+ * Allocation, sweeping and reuse of the runs of pages that hold large objects.
+ */
+
+#include "LargeObjectSpaceTest.h"
+#include "Evaluate.h"
+
+#include <set>
+
+#define private public
+#define protected public
+
+#include "memory/LargeObjectSpace.h"
+#include "memory/PagedSpace.h"
+#include "vm/Universe.h"
+#include "vmobjects/VMInteger.h"
+
+#define OBJECT_SIZE  (3 * SPACE_PAGE_SIZE + 24)
+#define HUGE_SIZE    ((size_t) 5 * 1024 * 1024)
+
+static Page* headerOf(void* obj) {
+    return (Page*) ((size_t) obj & ~(SPACE_PAGE_SIZE - 1));
+}
+
+void LargeObjectSpaceTest::testAllocate() {
+    PageAllocator allocator;
+    LargeObjectSpace space(&allocator);
+    char* obj = (char*) space.Allocate(OBJECT_SIZE);
+
+    // the object follows the header of its run, which starts on a page
+    Page* page = headerOf(obj);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, (size_t) page % SPACE_PAGE_SIZE);
+    CPPUNIT_ASSERT_EQUAL((char*) page + CELLS_OFFSET, obj);
+    CPPUNIT_ASSERT_EQUAL(obj, page->cells);
+    CPPUNIT_ASSERT_EQUAL((size_t) OBJECT_SIZE, page->cellSize);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, page->numberOfCells);
+    CPPUNIT_ASSERT(allocator.PageOf(obj + OBJECT_SIZE - 1) == page);
+    CPPUNIT_ASSERT(PagedSpace::IsLargeObject((AbstractVMObject*) obj));
+    CPPUNIT_ASSERT_EQUAL((size_t) OBJECT_SIZE, space.GetUsedBytes());
+
+    for (size_t i = 0; i < OBJECT_SIZE; i++)
+        CPPUNIT_ASSERT_EQUAL((int) 0, (int) obj[i]);
+    CPPUNIT_ASSERT(!PagedSpace::IsMarked((AbstractVMObject*) obj));
+}
+
+// runs of huge pages are aligned for them
+void LargeObjectSpaceTest::testHugeRun() {
+    PageAllocator allocator;
+    LargeObjectSpace space(&allocator);
+    space.Allocate(OBJECT_SIZE);
+    char* obj = (char*) space.Allocate(HUGE_SIZE);
+
+    Page* page = headerOf(obj);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, (size_t) page % HUGE_PAGE_SIZE);
+    CPPUNIT_ASSERT(allocator.PageOf(obj + HUGE_SIZE - 1) == page);
+    CPPUNIT_ASSERT_EQUAL((int) 0, (int) obj[HUGE_SIZE - 1]);
+    obj[HUGE_SIZE - 1] = 1;
+    CPPUNIT_ASSERT_EQUAL(HUGE_SIZE + OBJECT_SIZE, space.GetUsedBytes());
+}
+
+void LargeObjectSpaceTest::testSweep() {
+    PageAllocator allocator;
+    LargeObjectSpace space(&allocator);
+    AbstractVMObject* live  = space.Allocate(OBJECT_SIZE);
+    AbstractVMObject* dead  = space.Allocate(OBJECT_SIZE);
+    AbstractVMObject* huge  = space.Allocate(HUGE_SIZE);
+    ((char*) live)[OBJECT_SIZE - 1] = 1;
+
+    CPPUNIT_ASSERT(PagedSpace::Mark(live));
+    CPPUNIT_ASSERT(!PagedSpace::Mark(live));
+    CPPUNIT_ASSERT(PagedSpace::Mark(huge));
+
+    CPPUNIT_ASSERT_EQUAL(OBJECT_SIZE + HUGE_SIZE, space.Sweep());
+    CPPUNIT_ASSERT_EQUAL(OBJECT_SIZE + HUGE_SIZE, space.GetUsedBytes());
+    CPPUNIT_ASSERT(allocator.PageOf(dead) == nullptr);
+    CPPUNIT_ASSERT(allocator.PageOf(live) == headerOf(live));
+    CPPUNIT_ASSERT_EQUAL((char) 1, ((char*) live)[OBJECT_SIZE - 1]);
+
+    // the marks are cleared, so the next sweep frees everything
+    CPPUNIT_ASSERT(!PagedSpace::IsMarked(live));
+    CPPUNIT_ASSERT(!PagedSpace::IsMarked(huge));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, space.Sweep());
+    CPPUNIT_ASSERT(allocator.PageOf(live) == nullptr);
+    CPPUNIT_ASSERT(allocator.PageOf(huge) == nullptr);
+}
+
+static std::set<AbstractVMObject*> walked;
+
+static void collectCell(AbstractVMObject* obj) {
+    walked.insert(obj);
+}
+
+void LargeObjectSpaceTest::testWalkCells() {
+    PageAllocator allocator;
+    LargeObjectSpace space(&allocator);
+    std::set<AbstractVMObject*> objects;
+    for (int i = 0; i < 10; i++)
+        objects.insert(space.Allocate(OBJECT_SIZE + i * 1024));
+
+    walked.clear();
+    space.WalkCells(collectCell);
+    CPPUNIT_ASSERT(walked == objects);
+}
+
+void LargeObjectSpaceTest::testReuse() {
+    PageAllocator allocator;
+    LargeObjectSpace space(&allocator);
+    // a free run at the end would be given back, this one stays in between
+    char* dead = (char*) space.Allocate(OBJECT_SIZE);
+    AbstractVMObject* live = space.Allocate(OBJECT_SIZE);
+    dead[0] = 1;
+
+    PagedSpace::Mark(live);
+    space.Sweep();
+
+    // the run of the dead object is handed out again, zero filled
+    char* end = allocator.GetEnd();
+    char* reused = (char*) space.Allocate(OBJECT_SIZE);
+    CPPUNIT_ASSERT(reused == dead);
+    CPPUNIT_ASSERT_EQUAL((char) 0, reused[0]);
+    CPPUNIT_ASSERT_EQUAL(end, allocator.GetEnd());
+}
+
+// arrays too large for the nursery or for copying, next to garbage of the
+// same size
+static const char* largeArrays =
+    "LargeArrays = ("
+    "    run = ( | keep garbage sum |"
+    "        keep := Array new: 3."
+    "        1 to: 3 do: [:i | | a |"
+    "            a := Array new: 20000 * i."
+    "            1 to: a length do: [:j | a at: j put: j ]."
+    "            keep at: i put: a ]."
+    "        1 to: 50 do: [:i |"
+    "            garbage := Array new: 10000."
+    "            garbage at: 10000 put: i ]."
+    "        system fullGC."
+    "        1 to: 20 do: [:i | garbage := Array new: 300000 ]."
+    "        system fullGC."
+    "        sum := 0."
+    "        keep do: [:a | a do: [:e | sum := sum + e ] ]."
+    "        ^ sum"
+    "    )"
+    ")";
+
+void LargeObjectSpaceTest::testLargeArrays() {
+    DefineClass(largeArrays);
+    vm_oop_t sum = Evaluate("LargeArrays", "run");
+    int64_t expected = 0;
+    for (int64_t i = 1; i <= 3; i++)
+        expected += 20000 * i * (20000 * i + 1) / 2;
+    CPPUNIT_ASSERT_EQUAL(expected, (int64_t) INT_VAL(sum));
+}
@@ -0,0 +1,31 @@
+#pragma once
+/*
+ * LargeObjectSpaceTest.h
+ *
+ * Allocation, sweeping and reuse of the runs of pages that hold large objects.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LargeObjectSpaceTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (LargeObjectSpaceTest);
+    CPPUNIT_TEST (testAllocate);
+    CPPUNIT_TEST (testHugeRun);
+    CPPUNIT_TEST (testSweep);
+    CPPUNIT_TEST (testWalkCells);
+    CPPUNIT_TEST (testReuse);
+    CPPUNIT_TEST (testLargeArrays);CPPUNIT_TEST_SUITE_END();
+
+public:
+    inline void setUp(void) {
+    }
+    inline void tearDown(void) {
+    }
+private:
+    void testAllocate();
+    void testHugeRun();
+    void testSweep();
+    void testWalkCells();
+    void testReuse();
+    void testLargeArrays();
+};
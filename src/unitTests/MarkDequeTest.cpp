@@ -0,0 +1,104 @@
+/*
+ * MarkDequeTest.cpp
+ *
+ * The work-stealing deque of the parallel marker, with one owner pushing and
+ * taking objects while other threads steal them.
+ */
+
+#include "MarkDequeTest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "memory/MarkDeque.h"
+
+#define NUMBER_OF_OBJECTS 200000
+#define NUMBER_OF_THIEVES 3
+
+// the deque never looks at the objects, any aligned address will do
+static AbstractVMObject* fakeObject(long i) {
+    return (AbstractVMObject*) (i << 4);
+}
+
+static long indexOf(AbstractVMObject* obj) {
+    return (long) obj >> 4;
+}
+
+void MarkDequeTest::testPushTake() {
+    MarkDeque deque;
+    CPPUNIT_ASSERT(deque.IsEmpty());
+    CPPUNIT_ASSERT(deque.Take() == nullptr);
+
+    // more than fit into the initial buffer, the owner takes the last first
+    long count = 3 * INITIAL_MARK_DEQUE_SIZE;
+    for (long i = 1; i <= count; i++)
+        deque.Push(fakeObject(i));
+    CPPUNIT_ASSERT(!deque.IsEmpty());
+    for (long i = count; i >= 1; i--)
+        CPPUNIT_ASSERT_EQUAL(i, indexOf(deque.Take()));
+
+    CPPUNIT_ASSERT(deque.IsEmpty());
+    CPPUNIT_ASSERT(deque.Take() == nullptr);
+    deque.Reset();
+}
+
+void MarkDequeTest::testSteal() {
+    MarkDeque deque;
+    CPPUNIT_ASSERT(deque.Steal() == nullptr);
+
+    // thieves take the oldest objects, from the other end
+    for (long i = 1; i <= 4; i++)
+        deque.Push(fakeObject(i));
+    CPPUNIT_ASSERT_EQUAL(1L, indexOf(deque.Steal()));
+    CPPUNIT_ASSERT_EQUAL(4L, indexOf(deque.Take()));
+    CPPUNIT_ASSERT_EQUAL(2L, indexOf(deque.Steal()));
+    CPPUNIT_ASSERT_EQUAL(3L, indexOf(deque.Take()));
+    CPPUNIT_ASSERT(deque.Steal() == nullptr);
+    CPPUNIT_ASSERT(deque.Take() == nullptr);
+}
+
+/*
+ * The owner pushes all objects, taking some of them in between, while the
+ * thieves steal until the owner is done and the deque is empty. Every
+ * object has to come out exactly once, also while the buffer grows and
+ * when owner and thieves race for the last object.
+ */
+void MarkDequeTest::testConcurrentSteal() {
+    MarkDeque deque;
+    std::vector<std::atomic<long>> seen(NUMBER_OF_OBJECTS + 1);
+    for (long i = 0; i <= NUMBER_OF_OBJECTS; i++)
+        seen[i].store(0);
+    std::atomic<bool> ownerDone(false);
+
+    std::vector<std::thread> thieves;
+    for (long t = 0; t < NUMBER_OF_THIEVES; t++)
+        thieves.push_back(std::thread([&]() {
+            while (!ownerDone.load() || !deque.IsEmpty()) {
+                AbstractVMObject* obj = deque.Steal();
+                if (obj != nullptr)
+                    seen[indexOf(obj)].fetch_add(1);
+            }
+        }));
+
+    for (long i = 1; i <= NUMBER_OF_OBJECTS; i++) {
+        deque.Push(fakeObject(i));
+        if (i % 3 == 0) {
+            AbstractVMObject* obj = deque.Take();
+            if (obj != nullptr)
+                seen[indexOf(obj)].fetch_add(1);
+        }
+    }
+    AbstractVMObject* obj;
+    while ((obj = deque.Take()) != nullptr)
+        seen[indexOf(obj)].fetch_add(1);
+    ownerDone.store(true);
+
+    for (size_t t = 0; t < thieves.size(); t++)
+        thieves[t].join();
+
+    for (long i = 1; i <= NUMBER_OF_OBJECTS; i++)
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("object taken more or less than once",
+                                     1L, seen[i].load());
+    CPPUNIT_ASSERT(deque.IsEmpty());
+}
@@ -0,0 +1,26 @@
+#pragma once
+/*
+ * MarkDequeTest.h
+ *
+ * The work-stealing deque of the parallel marker, with one owner pushing and
+ * taking objects while other threads steal them.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class MarkDequeTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (MarkDequeTest);
+    CPPUNIT_TEST (testPushTake);
+    CPPUNIT_TEST (testSteal);
+    CPPUNIT_TEST (testConcurrentSteal);CPPUNIT_TEST_SUITE_END();
+
+public:
+    inline void setUp(void) {
+    }
+    inline void tearDown(void) {
+    }
+private:
+    void testPushTake();
+    void testSteal();
+    void testConcurrentSteal();
+};
@@ -0,0 +1,117 @@
+/*
+ * PagedSpaceTest.cpp
+ *
+ * Allocation, sweeping and reuse of cells in the non-moving spaces.
+ */
+
+#include "PagedSpaceTest.h"
+
+#include <set>
+#include <string.h>
+
+#define private public
+#define protected public
+
+#include "memory/PagedSpace.h"
+
+#define NUMBER_OF_OBJECTS 5000
+
+void PagedSpaceTest::testAllocate() {
+    PagedSpace space;
+    char* first  = (char*) space.Allocate(24);
+    char* second = (char*) space.Allocate(24);
+    char* other  = (char*) space.Allocate(200);
+
+    // objects of a size class share a page, other sizes get pages of their own
+    CPPUNIT_ASSERT(second >= first + 24);
+    CPPUNIT_ASSERT(PagedSpace::pageOf((AbstractVMObject*) first)
+                == PagedSpace::pageOf((AbstractVMObject*) second));
+    CPPUNIT_ASSERT(PagedSpace::pageOf((AbstractVMObject*) first)
+                != PagedSpace::pageOf((AbstractVMObject*) other));
+    CPPUNIT_ASSERT(!PagedSpace::IsLargeObject((AbstractVMObject*) first));
+    CPPUNIT_ASSERT_EQUAL((size_t) 24 + 24 + 200, space.GetUsedBytes());
+
+    // objects are zero filled
+    for (size_t i = 0; i < 200; i++)
+        CPPUNIT_ASSERT_EQUAL((int) 0, (int) other[i]);
+}
+
+void PagedSpaceTest::testSweep() {
+    PagedSpace space;
+    AbstractVMObject* objects[NUMBER_OF_OBJECTS];
+    for (long i = 0; i < NUMBER_OF_OBJECTS; i++) {
+        objects[i] = space.Allocate(32);
+        // the gc field, as set by a constructor
+        ((size_t*) objects[i])[1] = 2;
+    }
+
+    for (long i = 0; i < NUMBER_OF_OBJECTS; i += 2)
+        CPPUNIT_ASSERT(PagedSpace::Mark(objects[i]));
+    CPPUNIT_ASSERT(!PagedSpace::Mark(objects[0]));
+    CPPUNIT_ASSERT(!PagedSpace::IsMarked(objects[1]));
+
+    CPPUNIT_ASSERT_EQUAL((size_t) NUMBER_OF_OBJECTS / 2 * 32, space.Sweep());
+    for (long i = 0; i < NUMBER_OF_OBJECTS; i++) {
+        CPPUNIT_ASSERT(!PagedSpace::IsMarked(objects[i]));
+        // live objects are not touched, free cells lose their gc field
+        CPPUNIT_ASSERT_EQUAL((size_t) (i % 2 == 0 ? 2 : 0), ((size_t*) objects[i])[1]);
+    }
+
+    // pages without marked objects are given back
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, space.Sweep());
+    CPPUNIT_ASSERT_EQUAL(space.GetPageAllocator().GetStart(),
+                         space.GetPageAllocator().GetEnd());
+}
+
+void PagedSpaceTest::testReuse() {
+    PagedSpace space;
+    AbstractVMObject* objects[NUMBER_OF_OBJECTS];
+    for (long i = 0; i < NUMBER_OF_OBJECTS; i++)
+        objects[i] = space.Allocate(48);
+
+    std::set<AbstractVMObject*> freed;
+    for (long i = 0; i < NUMBER_OF_OBJECTS; i++) {
+        if (i % 3 == 0)
+            freed.insert(objects[i]);
+        else
+            PagedSpace::Mark(objects[i]);
+    }
+    space.Sweep();
+
+    // the freed cells are handed out again before any new page
+    char* end = space.GetPageAllocator().GetEnd();
+    for (size_t i = 0; i < freed.size(); i++) {
+        AbstractVMObject* obj = space.Allocate(48);
+        CPPUNIT_ASSERT(freed.find(obj) != freed.end());
+        CPPUNIT_ASSERT_EQUAL((size_t) 0, ((size_t*) obj)[1]);
+    }
+    CPPUNIT_ASSERT_EQUAL(end, space.GetPageAllocator().GetEnd());
+
+    AbstractVMObject* fresh = space.Allocate(48);
+    CPPUNIT_ASSERT(freed.find(fresh) == freed.end());
+}
+
+void PagedSpaceTest::testLargeObjects() {
+    PagedSpace space;
+    size_t size = 10 * SPACE_PAGE_SIZE;
+    char* large = (char*) space.Allocate(size);
+    char* dead  = (char*) space.Allocate(MAX_SMALL_OBJECT_SIZE + 8);
+    CPPUNIT_ASSERT(PagedSpace::IsLargeObject((AbstractVMObject*) large));
+    CPPUNIT_ASSERT(PagedSpace::IsLargeObject((AbstractVMObject*) dead));
+    CPPUNIT_ASSERT_EQUAL(size + MAX_SMALL_OBJECT_SIZE + 8, space.GetUsedBytes());
+
+    // the whole object is accessible, and its run starts with the page header
+    memset(large, 1, size);
+    CPPUNIT_ASSERT(space.GetPageAllocator().PageOf(large + size - 1)
+                == PagedSpace::pageOf((AbstractVMObject*) large));
+
+    CPPUNIT_ASSERT(PagedSpace::Mark((AbstractVMObject*) large));
+    CPPUNIT_ASSERT_EQUAL(size, space.Sweep());
+    CPPUNIT_ASSERT(space.GetPageAllocator().PageOf(dead) == nullptr);
+    CPPUNIT_ASSERT_EQUAL((char) 1, large[size - 1]);
+
+    // the pages of the dead object are reused
+    char* reused = (char*) space.Allocate(MAX_SMALL_OBJECT_SIZE + 8);
+    CPPUNIT_ASSERT(reused == dead);
+    CPPUNIT_ASSERT_EQUAL((char) 0, reused[0]);
+}
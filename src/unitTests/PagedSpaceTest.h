@@ -0,0 +1,27 @@
+#pragma once
+/*
+ * PagedSpaceTest.h
+ *
+ * Allocation, sweeping and reuse of cells in the non-moving spaces.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class PagedSpaceTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (PagedSpaceTest);
+    CPPUNIT_TEST (testAllocate);
+    CPPUNIT_TEST (testSweep);
+    CPPUNIT_TEST (testReuse);
+    CPPUNIT_TEST (testLargeObjects);CPPUNIT_TEST_SUITE_END();
+
+public:
+    inline void setUp(void) {
+    }
+    inline void tearDown(void) {
+    }
+private:
+    void testAllocate();
+    void testSweep();
+    void testReuse();
+    void testLargeObjects();
+};
@@ -0,0 +1,124 @@
+/*
+ * ParallelMarkerTest.cpp
+ *
+ * Full collections of the generational heap, with several marker threads.
+ */
+
+#include "ParallelMarkerTest.h"
+
+#include <sstream>
+
+#define private public
+#define protected public
+
+#include "memory/GenerationalHeap.h"
+#include "memory/GenerationalCollector.h"
+#include "memory/ParallelMarker.h"
+#include "vm/Universe.h"
+#include "vmobjects/VMArray.h"
+#include "vmobjects/VMString.h"
+
+#define NUMBER_OF_MARKERS 4
+#define DEPTH 100000
+#define WIDTH 50000
+
+void ParallelMarkerTest::setUp() {
+    numberOfThreads = ParallelMarker::numberOfThreads;
+    ParallelMarker::numberOfThreads = NUMBER_OF_MARKERS;
+}
+
+void ParallelMarkerTest::tearDown() {
+    ParallelMarker::numberOfThreads = numberOfThreads;
+}
+
+static VMArray* newOldArray(long length) {
+    VMArray* arr = new (GetHeap<HEAP_CLS>(), length * sizeof(VMObject*) ALLOC_MATURE) VMArray(length);
+    arr->SetGCField(MASK_OBJECT_IS_OLD);
+    arr->SetClass(load_ptr(arrayClass));
+    return arr;
+}
+
+static StdString nameOf(long i) {
+    stringstream name;
+    name << "object " << i;
+    return name.str();
+}
+
+// a minor collection promoting all young objects, followed by a major one
+static void fullCollection() {
+    GenerationalCollector* collector =
+        static_cast<GenerationalCollector*>(GetHeap<GenerationalHeap>()->gc);
+    collector->majorCollectionThreshold = 0;
+    collector->Collect();
+}
+
+// the cell of a swept object is on a free list, with a zero gc field
+static bool isFreed(AbstractVMObject* obj) {
+    return obj->GetGCField() == 0;
+}
+
+/*
+ * A long list of old arrays, whose elements are young strings that are only
+ * promoted by the collection. Most of the list can only be marked one object
+ * after the other, which keeps the other markers stealing.
+ */
+void ParallelMarkerTest::testDeepGraph() {
+    VMArray* root = newOldArray(2);
+    VMArray* garbage = newOldArray(2);
+    VMArray* node = root;
+    for (long i = 0; i < DEPTH; i++) {
+        VMArray* next = newOldArray(2);
+        node->SetIndexableField(0, next);
+        node->SetIndexableField(1, GetUniverse()->NewString(nameOf(i)));
+        node = next;
+    }
+    node->SetIndexableField(0, load_ptr(nilObject));
+    node->SetIndexableField(1, load_ptr(nilObject));
+    garbage->SetIndexableField(0, GetUniverse()->NewString("garbage"));
+    GetUniverse()->SetGlobal(GetUniverse()->SymbolFor("ParallelMarkerDeep"), root);
+
+    fullCollection();
+
+    node = root;
+    for (long i = 0; i < DEPTH; i++) {
+        CPPUNIT_ASSERT(!isFreed(node));
+        vm_oop_t name = node->GetIndexableField(1);
+        CPPUNIT_ASSERT(!isFreed(AS_OBJ(name)));
+        CPPUNIT_ASSERT_EQUAL(nameOf(i), static_cast<VMString*>(name)->GetStdString());
+        node = static_cast<VMArray*>(node->GetIndexableField(0));
+    }
+    CPPUNIT_ASSERT(!isFreed(node));
+    CPPUNIT_ASSERT(isFreed(garbage));
+
+    GetUniverse()->SetGlobal(GetUniverse()->SymbolFor("ParallelMarkerDeep"), load_ptr(nilObject));
+}
+
+/*
+ * A large array of many small ones, all of different lengths. Its elements
+ * are spread over the deques of all markers.
+ */
+void ParallelMarkerTest::testWideGraph() {
+    VMArray* root = newOldArray(WIDTH);
+    for (long i = 0; i < WIDTH; i++) {
+        VMArray* element = newOldArray(i % 7 + 1);
+        element->SetIndexableField(i % 7, GetUniverse()->NewString(nameOf(i)));
+        root->SetIndexableField(i, element);
+    }
+    VMArray* garbage = newOldArray(WIDTH);
+    VMArray* garbageElement = newOldArray(1);
+    garbage->SetIndexableField(0, garbageElement);
+    GetUniverse()->SetGlobal(GetUniverse()->SymbolFor("ParallelMarkerWide"), root);
+
+    fullCollection();
+
+    for (long i = 0; i < WIDTH; i++) {
+        VMArray* element = static_cast<VMArray*>(root->GetIndexableField(i));
+        CPPUNIT_ASSERT(!isFreed(element));
+        CPPUNIT_ASSERT_EQUAL(i % 7 + 1, element->GetNumberOfIndexableFields());
+        vm_oop_t name = element->GetIndexableField(i % 7);
+        CPPUNIT_ASSERT_EQUAL(nameOf(i), static_cast<VMString*>(name)->GetStdString());
+    }
+    CPPUNIT_ASSERT(isFreed(garbageElement));
+
+    GetUniverse()->SetGlobal(GetUniverse()->SymbolFor("ParallelMarkerWide"), load_ptr(nilObject));
+}
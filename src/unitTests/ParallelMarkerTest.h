@@ -0,0 +1,23 @@
+#pragma once
+/*
+ * ParallelMarkerTest.h
+ *
+ * Full collections of the generational heap, with several marker threads.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ParallelMarkerTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (ParallelMarkerTest);
+    CPPUNIT_TEST (testDeepGraph);
+    CPPUNIT_TEST (testWideGraph);CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp(void);
+    void tearDown(void);
+private:
+    void testDeepGraph();
+    void testWideGraph();
+
+    long numberOfThreads;
+};
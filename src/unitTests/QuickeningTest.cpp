@@ -0,0 +1,123 @@
+/*
+ * QuickeningTest.cpp
+ *
+ * Sends rewritten into specialized bytecodes by the interpreter, and their
+ * fallback to normal sends when the guards fail.
+ */
+
+#include "QuickeningTest.h"
+#include "Evaluate.h"
+
+#include "interpreter/bytecodes.h"
+#include "vm/Universe.h"
+#include "vmobjects/IntegerBox.h"
+#include "vmobjects/VMArray.h"
+#include "vmobjects/VMDouble.h"
+#include "vmobjects/VMMethod.h"
+
+static const char* quickSites =
+    "QuickSites = ("
+    "    add: a to: b = ( ^ a + b )"
+    "    sub: a from: b = ( ^ b - a )"
+    "    mul: a by: b = ( ^ a * b )"
+    "    less: a than: b = ( ^ a < b )"
+    "    equal: a to: b = ( ^ a = b )"
+    "    getX: p = ( ^ p x )"
+    "    apply: blk = ( ^ blk value )"
+    "    ints = ( | r |"
+    "        r := Array new: 5."
+    "        1 to: 3 do: [:i |"
+    "            r at: 1 put: (self add: 3 to: 4)."
+    "            r at: 2 put: (self sub: 3 from: 10)."
+    "            r at: 3 put: (self mul: 6 by: 7)."
+    "            r at: 4 put: (self less: 3 than: 4)."
+    "            r at: 5 put: (self equal: 5 to: 6) ]."
+    "        ^ r )"
+    "    doubles = ( | r |"
+    "        r := Array new: 3."
+    "        r at: 1 put: (self add: 1.5 to: 2.25)."
+    "        r at: 2 put: (self add: 1 to: 2.5)."
+    "        r at: 3 put: (self less: 2.5 than: 1.5)."
+    "        ^ r )"
+    "    points = ( | p | p := QuickPoint new. p x: 7. ^ (self getX: p) + (self getX: p) )"
+    "    others = ( ^ self getX: QuickOther new )"
+    "    blocks = ( ^ (self apply: [ 5 ]) + (self apply: [ 6 ]) )"
+    "    values = ( ^ self apply: 7 )"
+    ")";
+
+void QuickeningTest::setUp() {
+    if (GetUniverse()->HasGlobal(GetUniverse()->SymbolFor("QuickSites")))
+        return;
+    DefineClass("QuickPoint = ( | x | x = ( ^ x ) x: value = ( x := value ) )");
+    DefineClass("QuickOther = ( x = ( ^ 42 ) )");
+    DefineClass(quickSites);
+}
+
+static uint8_t bytecodeOf(const char* method, const char* selector) {
+    VMMethod* meth = LookupMethod("QuickSites", method);
+    long site = FindSend(meth, selector);
+    CPPUNIT_ASSERT(site >= 0);
+    return meth->GetBytecode(site);
+}
+
+static vm_oop_t elementOf(vm_oop_t result, long idx) {
+    return static_cast<VMArray*>(result)->GetIndexableField(idx);
+}
+
+static int64_t intValue(vm_oop_t value) {
+    CPPUNIT_ASSERT(CLASS_OF(value) == load_ptr(integerClass));
+    return INT_VAL(value);
+}
+
+static double doubleValue(vm_oop_t value) {
+    CPPUNIT_ASSERT(CLASS_OF(value) == load_ptr(doubleClass));
+    return DOUBLE_VAL(value);
+}
+
+void QuickeningTest::testIntegerSends() {
+    vm_oop_t result = Evaluate("QuickSites", "ints");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 7,  intValue(elementOf(result, 0)));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 7,  intValue(elementOf(result, 1)));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 42, intValue(elementOf(result, 2)));
+    CPPUNIT_ASSERT(elementOf(result, 3) == load_ptr(trueObject));
+    CPPUNIT_ASSERT(elementOf(result, 4) == load_ptr(falseObject));
+
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_INT_ADD, (int) bytecodeOf("add:to:", "+"));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_INT_SUB, (int) bytecodeOf("sub:from:", "-"));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_INT_MUL, (int) bytecodeOf("mul:by:", "*"));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_INT_LT,  (int) bytecodeOf("less:than:", "<"));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_INT_EQ,  (int) bytecodeOf("equal:to:", "="));
+}
+
+// other receivers and arguments take the normal send
+void QuickeningTest::testIntegerGuard() {
+    Evaluate("QuickSites", "ints");
+    vm_oop_t result = Evaluate("QuickSites", "doubles");
+    CPPUNIT_ASSERT_EQUAL(3.75, doubleValue(elementOf(result, 0)));
+    CPPUNIT_ASSERT_EQUAL(3.5,  doubleValue(elementOf(result, 1)));
+    CPPUNIT_ASSERT(elementOf(result, 2) == load_ptr(falseObject));
+
+    // and the integers still take the quickened one
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_INT_ADD, (int) bytecodeOf("add:to:", "+"));
+    result = Evaluate("QuickSites", "ints");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 7, intValue(elementOf(result, 0)));
+}
+
+void QuickeningTest::testFieldGetter() {
+    CPPUNIT_ASSERT_EQUAL((int64_t) 14, intValue(Evaluate("QuickSites", "points")));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_FIELD_GET, (int) bytecodeOf("getX:", "x"));
+
+    // a receiver without the getter reverts the site to a normal send
+    CPPUNIT_ASSERT_EQUAL((int64_t) 42, intValue(Evaluate("QuickSites", "others")));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND, (int) bytecodeOf("getX:", "x"));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 14, intValue(Evaluate("QuickSites", "points")));
+}
+
+void QuickeningTest::testBlockValue() {
+    CPPUNIT_ASSERT_EQUAL((int64_t) 11, intValue(Evaluate("QuickSites", "blocks")));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND_BLOCK, (int) bytecodeOf("apply:", "value"));
+
+    CPPUNIT_ASSERT_EQUAL((int64_t) 7, intValue(Evaluate("QuickSites", "values")));
+    CPPUNIT_ASSERT_EQUAL((int) BC_SEND, (int) bytecodeOf("apply:", "value"));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 11, intValue(Evaluate("QuickSites", "blocks")));
+}
@@ -0,0 +1,27 @@
+#pragma once
+/*
+ * QuickeningTest.h
+ *
+ * Sends rewritten into specialized bytecodes by the interpreter, and their
+ * fallback to normal sends when the guards fail.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class QuickeningTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (QuickeningTest);
+    CPPUNIT_TEST (testIntegerSends);
+    CPPUNIT_TEST (testIntegerGuard);
+    CPPUNIT_TEST (testFieldGetter);
+    CPPUNIT_TEST (testBlockValue);CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp(void);
+    inline void tearDown(void) {
+    }
+private:
+    void testIntegerSends();
+    void testIntegerGuard();
+    void testFieldGetter();
+    void testBlockValue();
+};
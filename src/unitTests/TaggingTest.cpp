@@ -0,0 +1,109 @@
+/*
+ * TaggingTest.cpp
+ *
+ * Immediate integers and doubles, and the boxed values used for the ones
+ * that do not fit into an oop, with or without USE_TAGGING and
+ * USE_DOUBLE_TAGGING.
+ */
+
+#include "TaggingTest.h"
+#include "Evaluate.h"
+
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+#include "vm/Universe.h"
+#include "vmobjects/IntegerBox.h"
+#include "vmobjects/VMArray.h"
+#include "vmobjects/VMDouble.h"
+#include "vmobjects/VMInteger.h"
+
+static bool sameBits(double a, double b) {
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+void TaggingTest::testCanTagDouble() {
+    CPPUNIT_ASSERT(canTagDouble(0.0));
+    CPPUNIT_ASSERT(canTagDouble(-0.0));
+    CPPUNIT_ASSERT(canTagDouble(1.0));
+    CPPUNIT_ASSERT(canTagDouble(-3.75));
+
+    // the exponents at both ends of the range
+    CPPUNIT_ASSERT(canTagDouble(ldexp(1.0, -126)));
+    CPPUNIT_ASSERT(!canTagDouble(ldexp(1.0, -127)));
+    CPPUNIT_ASSERT(canTagDouble(ldexp(1.9, 128)));
+    CPPUNIT_ASSERT(!canTagDouble(ldexp(1.0, 129)));
+
+    CPPUNIT_ASSERT(!canTagDouble(std::numeric_limits<double>::infinity()));
+    CPPUNIT_ASSERT(!canTagDouble(std::numeric_limits<double>::quiet_NaN()));
+    CPPUNIT_ASSERT(!canTagDouble(std::numeric_limits<double>::denorm_min()));
+
+    double values[] = { 0.0, -0.0, 1.0, -3.75, 0.1, ldexp(1.0, -126), -ldexp(1.9, 128) };
+    for (size_t i = 0; i < sizeof(values) / sizeof(double); i++) {
+        vm_oop_t tagged = tagDouble(values[i]);
+        CPPUNIT_ASSERT_EQUAL((int64_t) DOUBLE_TAG, (int64_t) tagged & 7);
+        CPPUNIT_ASSERT(sameBits(values[i], untagDouble(tagged)));
+    }
+}
+
+// immediate where possible, and boxed otherwise
+void TaggingTest::testDoubleRoundTrip() {
+    double values[] = { 0.0, -0.0, 1.5, -2.25, 0.1, 1e10, 1e-300, -1e300,
+                        std::numeric_limits<double>::infinity(),
+                        std::numeric_limits<double>::denorm_min() };
+    for (size_t i = 0; i < sizeof(values) / sizeof(double); i++) {
+        vm_oop_t value = NEW_DOUBLE(values[i]);
+        CPPUNIT_ASSERT_EQUAL((bool) (USE_DOUBLE_TAGGING && canTagDouble(values[i])),
+                             (bool) IS_TAGGED_DOUBLE(value));
+        CPPUNIT_ASSERT(CLASS_OF(value) == load_ptr(doubleClass));
+        CPPUNIT_ASSERT(sameBits(values[i], DOUBLE_VAL(value)));
+    }
+
+    vm_oop_t nan = NEW_DOUBLE(std::numeric_limits<double>::quiet_NaN());
+    CPPUNIT_ASSERT(!IS_TAGGED_DOUBLE(nan));
+    CPPUNIT_ASSERT(isnan(DOUBLE_VAL(nan)));
+}
+
+void TaggingTest::testIntegerRoundTrip() {
+    int64_t values[] = { 0, 1, -1, 42, VMTAGGEDINTEGER_MAX, VMTAGGEDINTEGER_MIN,
+                         (int64_t) VMTAGGEDINTEGER_MAX + 1, (int64_t) VMTAGGEDINTEGER_MIN - 1,
+                         std::numeric_limits<int64_t>::max(),
+                         std::numeric_limits<int64_t>::min() };
+    for (size_t i = 0; i < sizeof(values) / sizeof(int64_t); i++) {
+        vm_oop_t value = NEW_INT(values[i]);
+        bool fits = values[i] >= VMTAGGEDINTEGER_MIN && values[i] <= VMTAGGEDINTEGER_MAX;
+        CPPUNIT_ASSERT_EQUAL((bool) (USE_TAGGING && fits), (bool) IS_TAGGED(value));
+        CPPUNIT_ASSERT(CLASS_OF(value) == load_ptr(integerClass));
+        CPPUNIT_ASSERT_EQUAL(values[i], (int64_t) INT_VAL(value));
+    }
+}
+
+// tagged and boxed values mixed in the fields of an array
+static const char* taggedValues =
+    "TaggedValues = ("
+    "    run = ( | a x n sum |"
+    "        a := Array new: 104."
+    "        1 to: 100 do: [:i | a at: i put: i * 0.5 ]."
+    "        x := 1.5. 1 to: 50 do: [:i | x := x * 1024.0 ]. a at: 101 put: x."
+    "        x := 1.5. 1 to: 50 do: [:i | x := x // 1024.0 ]. a at: 102 put: x."
+    "        n := 1. 1 to: 62 do: [:i | n := n * 2 ]. a at: 103 put: n."
+    "        a at: 104 put: 0 - n."
+    "        system fullGC."
+    "        sum := 0.0."
+    "        1 to: 100 do: [:i | sum := sum + (a at: i) ]."
+    "        a at: 1 put: sum."
+    "        ^ a )"
+    ")";
+
+void TaggingTest::testSurviveCollection() {
+    DefineClass(taggedValues);
+    VMArray* result = static_cast<VMArray*>(Evaluate("TaggedValues", "run"));
+
+    CPPUNIT_ASSERT_EQUAL(2525.0, (double) DOUBLE_VAL(result->GetIndexableField(0)));
+    CPPUNIT_ASSERT_EQUAL(49.5, (double) DOUBLE_VAL(result->GetIndexableField(98)));
+    CPPUNIT_ASSERT(sameBits(ldexp(1.5, 500),  DOUBLE_VAL(result->GetIndexableField(100))));
+    CPPUNIT_ASSERT(sameBits(ldexp(1.5, -500), DOUBLE_VAL(result->GetIndexableField(101))));
+    CPPUNIT_ASSERT_EQUAL((int64_t) 1 << 62,    (int64_t) INT_VAL(result->GetIndexableField(102)));
+    CPPUNIT_ASSERT_EQUAL(-((int64_t) 1 << 62), (int64_t) INT_VAL(result->GetIndexableField(103)));
+}
@@ -0,0 +1,29 @@
+#pragma once
+/*
+ * TaggingTest.h
+ *
+ * Immediate integers and doubles, and the boxed values used for the ones
+ * that do not fit into an oop, with or without USE_TAGGING and
+ * USE_DOUBLE_TAGGING.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TaggingTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (TaggingTest);
+    CPPUNIT_TEST (testCanTagDouble);
+    CPPUNIT_TEST (testDoubleRoundTrip);
+    CPPUNIT_TEST (testIntegerRoundTrip);
+    CPPUNIT_TEST (testSurviveCollection);CPPUNIT_TEST_SUITE_END();
+
+public:
+    inline void setUp(void) {
+    }
+    inline void tearDown(void) {
+    }
+private:
+    void testCanTagDouble();
+    void testDoubleRoundTrip();
+    void testIntegerRoundTrip();
+    void testSurviveCollection();
+};
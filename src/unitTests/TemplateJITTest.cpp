@@ -0,0 +1,111 @@
+/*
+ * TemplateJITTest.cpp
+ *
+ * Runs hot methods with -jit, so that they are compiled and continue in
+ * compiled code.
+ */
+
+#include "TemplateJITTest.h"
+#include "Evaluate.h"
+
+#define private public
+#define protected public
+
+#include "interpreter/TemplateJIT.h"
+#include "vm/Universe.h"
+#include "vmobjects/VMDouble.h"
+#include "vmobjects/VMMethod.h"
+
+// all loops run longer than JIT_THRESHOLD iterations
+static const char* jitMethods =
+    "JitMethods = ("
+    "    | count total value |"
+    "    sumTo: n = ( | i sum |"
+    "        i := 1. sum := 0."
+    "        [ i < (n + 1) ] whileTrue: [ sum := sum + i. i := i + 1 ]."
+    "        ^ sum )"
+    "    loops = ( ^ (self sumTo: 5000) - (self sumTo: 10) )"
+    "    fields = ("
+    "        count := 0. total := 0."
+    "        1 to: 5000 do: [:i | count := count + 1. total := total + (i * 2) ]."
+    "        ^ total - count )"
+    "    allocate = ( | list n |"
+    "        n := 0."
+    "        1 to: 20000 do: [:i | list := Array new: 8. list at: 1 put: i. n := n + (list at: 1) ]."
+    "        ^ n )"
+    "    add: a to: b = ( ^ a + b )"
+    "    guards = ( | s |"
+    "        s := 0."
+    "        1 to: 3000 do: [:i | s := self add: s to: i ]."
+    "        ^ self add: s to: 0.5 )"
+    "    value = ( ^ value )"
+    "    value: v = ( value := v )"
+    "    seven = ( ^ 7 )"
+    "    first: a second: b = ( ^ a )"
+    "    sends = ( | s |"
+    "        s := 0."
+    "        1 to: 3000 do: [:i | self value: i. s := s + self value + self seven + (self first: i second: s) ]."
+    "        ^ s )"
+    "    fib: n = ( n < 2 ifTrue: [ ^ n ]. ^ (self fib: n - 1) + (self fib: n - 2) )"
+    "    recursion = ( ^ self fib: 20 )"
+    ")";
+
+void TemplateJITTest::setUp() {
+    useJIT = TemplateJIT::IsSupported();
+    if (!GetUniverse()->HasGlobal(GetUniverse()->SymbolFor("JitMethods")))
+        DefineClass(jitMethods);
+}
+
+void TemplateJITTest::tearDown() {
+    useJIT = false;
+}
+
+static bool isCompiled(const char* selector) {
+    return LookupMethod("JitMethods", selector)->compiledCode != nullptr;
+}
+
+void TemplateJITTest::testLoops() {
+    vm_oop_t result = Evaluate("JitMethods", "loops");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 12502500 - 55, (int64_t) INT_VAL(result));
+    if (useJIT)
+        CPPUNIT_ASSERT(isCompiled("sumTo:"));
+}
+
+void TemplateJITTest::testFields() {
+    vm_oop_t result = Evaluate("JitMethods", "fields");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 25005000 - 5000, (int64_t) INT_VAL(result));
+    if (useJIT)
+        CPPUNIT_ASSERT(isCompiled("fields"));
+}
+
+// compiled code leaves to the interpreter for the pending collections
+void TemplateJITTest::testAllocation() {
+    vm_oop_t result = Evaluate("JitMethods", "allocate");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 200010000, (int64_t) INT_VAL(result));
+    if (useJIT)
+        CPPUNIT_ASSERT(isCompiled("allocate"));
+}
+
+// a quickened send of compiled code whose guard fails leaves to the interpreter
+void TemplateJITTest::testFailingGuard() {
+    vm_oop_t result = Evaluate("JitMethods", "guards");
+    CPPUNIT_ASSERT(CLASS_OF(result) == load_ptr(doubleClass));
+    CPPUNIT_ASSERT_EQUAL(4501500.5, (double) DOUBLE_VAL(result));
+    if (useJIT)
+        CPPUNIT_ASSERT(isCompiled("add:to:"));
+}
+
+// compiled code runs monomorphic sends of trivial methods itself
+void TemplateJITTest::testMonomorphicSends() {
+    vm_oop_t result = Evaluate("JitMethods", "sends");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 9024000, (int64_t) INT_VAL(result));
+    if (useJIT)
+        CPPUNIT_ASSERT(isCompiled("sends"));
+}
+
+void TemplateJITTest::testRecursion() {
+    vm_oop_t result = Evaluate("JitMethods", "recursion");
+    CPPUNIT_ASSERT_EQUAL((int64_t) 6765, (int64_t) INT_VAL(result));
+    if (useJIT)
+        CPPUNIT_ASSERT(isCompiled("fib:"));
+}
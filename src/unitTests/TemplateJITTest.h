@@ -0,0 +1,30 @@
+#pragma once
+/*
+ * TemplateJITTest.h
+ *
+ * Runs hot methods with -jit, so that they are compiled and continue in
+ * compiled code.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class TemplateJITTest: public CPPUNIT_NS::TestCase {
+    CPPUNIT_TEST_SUITE (TemplateJITTest);
+    CPPUNIT_TEST (testLoops);
+    CPPUNIT_TEST (testFields);
+    CPPUNIT_TEST (testAllocation);
+    CPPUNIT_TEST (testFailingGuard);
+    CPPUNIT_TEST (testMonomorphicSends);
+    CPPUNIT_TEST (testRecursion);CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp(void);
+    void tearDown(void);
+private:
+    void testLoops();
+    void testFields();
+    void testAllocation();
+    void testFailingGuard();
+    void testMonomorphicSends();
+    void testRecursion();
+};
@@ -158,6 +158,25 @@ void WalkObjectsTest::testWalkFrame() {
             (long) walkedObjects.size() + 1);  // + 1 for the class field that's still in there
 }
 
+void WalkObjectsTest::testWalkStackFrame() {
+    walkedObjects.clear();
+    Interpreter* interpreter = GetUniverse()->GetInterpreter();
+    VMSymbol* methodSymbol = GetUniverse()->NewSymbol("frameMethod");
+    VMMethod* method = GetUniverse()->NewMethod(methodSymbol, 0, 0);
+    VMFrame* stackFrame = interpreter->PushNewFrame(method);
+    VMFrame* frame = GetUniverse()->NewFrame(stackFrame, method);
+    frame->WalkObjects(collectMembers);
+
+    // frames on the frame stack are walked by the interpreter, not through
+    // the frames that refer to them
+    CPPUNIT_ASSERT(interpreter->IsStackFrame(stackFrame));
+    CPPUNIT_ASSERT(!interpreter->IsStackFrame(frame));
+    CPPUNIT_ASSERT(!WalkerHasFound(_store_ptr(stackFrame)));
+    CPPUNIT_ASSERT(WalkerHasFound(_store_ptr(frame->GetMethod())));
+
+    interpreter->popFrame();
+}
+
 void WalkObjectsTest::testWalkMethod() {
     walkedObjects.clear();
     VMSymbol* methodSymbol = GetUniverse()->NewSymbol("myMethod");
@@ -37,6 +37,7 @@ class WalkObjectsTest: public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST (testWalkDouble);
     CPPUNIT_TEST (testWalkEvaluationPrimitive);
     CPPUNIT_TEST (testWalkFrame);
+    CPPUNIT_TEST (testWalkStackFrame);
     CPPUNIT_TEST (testWalkInteger);
     CPPUNIT_TEST (testWalkString);
     CPPUNIT_TEST (testWalkMethod);
@@ -57,6 +58,7 @@ private:
     void testWalkDouble();
     void testWalkEvaluationPrimitive();
     void testWalkFrame();
+    void testWalkStackFrame();
     void testWalkInteger();
     void testWalkString();
     void testWalkMethod();
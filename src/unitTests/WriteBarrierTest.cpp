@@ -7,13 +7,14 @@
 #include "../src/vmobjects/VMMethod.h"
 #include "../src/vmobjects/VMFrame.h"
 #include "../src/vmobjects/VMEvaluationPrimitive.h"
+#include "../src/memory/CardTable.h"
 
 #if GC_TYPE==GENERATIONAL
 
 #define TEST_WB_CALLED(msg, hld, ref) \
         CPPUNIT_ASSERT_MESSAGE(msg, \
-                        GetHeap<HEAP_CLS>()->writeBarrierCalledOn.find(make_pair(hld, ref)) != \
-                        GetHeap<HEAP_CLS>()->writeBarrierCalledOn.end());
+                        GetHeap<GenerationalHeap>()->writeBarrierCalledOn.find(make_pair(hld, ref)) != \
+                        GetHeap<GenerationalHeap>()->writeBarrierCalledOn.end());
 
 void WriteBarrierTest::testWriteArray() {
     if (!DEBUG) {
@@ -21,7 +22,7 @@ void WriteBarrierTest::testWriteArray() {
     }
     
     //reset set...
-    GetHeap<HEAP_CLS>()->writeBarrierCalledOn.clear();
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
     VMArray* arr = GetUniverse()->NewArray(3);
     VMInteger* newInt = GetUniverse()->NewInteger(12345);
     VMString* str = GetUniverse()->NewString("asdfghjkl");
@@ -51,7 +52,7 @@ void WriteBarrierTest::testWriteBlock() {
     }
     
     //reset set...
-    GetHeap<HEAP_CLS>()->writeBarrierCalledOn.clear();
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
 
     VMSymbol* methodSymbol = GetUniverse()->NewSymbol("someMethod");
     VMMethod* method = GetUniverse()->NewMethod(methodSymbol, 0, 0);
@@ -79,7 +80,7 @@ void WriteBarrierTest::testWriteFrame() {
     }
     
     // reset set...
-    GetHeap<HEAP_CLS>()->writeBarrierCalledOn.clear();
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
 
     VMFrame* frame = GetUniverse()->GetInterpreter()->GetFrame()->Clone();
     frame->SetContext(frame->Clone());
@@ -98,7 +99,7 @@ void WriteBarrierTest::testWriteMethod() {
     }
     
     // reset set...
-    GetHeap<HEAP_CLS>()->writeBarrierCalledOn.clear();
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
     VMMethod* method = GetUniverse()->GetInterpreter()->GetFrame()->GetMethod()->Clone();
     method->SetHolder(load_ptr(integerClass));
     TEST_WB_CALLED("VMMethod failed to call writeBarrier on SetHolder", method, load_ptr(integerClass));
@@ -112,7 +113,7 @@ void WriteBarrierTest::testWriteEvaluationPrimitive() {
     }
     
     //reset set...
-    GetHeap<HEAP_CLS>()->writeBarrierCalledOn.clear();
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
     VMEvaluationPrimitive* evPrim = new (GetHeap<HEAP_CLS>()) VMEvaluationPrimitive(1);
     TEST_WB_CALLED("VMEvaluationPrimitive failed to call writeBarrier when creating", evPrim, evPrim->GetClass());
     TEST_WB_CALLED("VMEvaluationPrimitive failed to call writeBarrier when creating", evPrim, load_ptr(evPrim->numberOfArguments));
@@ -124,7 +125,7 @@ void WriteBarrierTest::testWriteClass() {
     }
     
     //reset set...
-    GetHeap<HEAP_CLS>()->writeBarrierCalledOn.clear();
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
     VMClass* cl = load_ptr(integerClass)->Clone();
     //now test all methods that change members
     cl->SetSuperClass(load_ptr(integerClass));
@@ -143,5 +144,42 @@ void WriteBarrierTest::testWriteClass() {
     TEST_WB_CALLED("VMClass failed to call writeBarrier on SetInstanceInvokables", cl,
             newName);
 }
-#endif
 
+void WriteBarrierTest::testCardMarking() {
+    PageAllocator space;
+    char* start = (char*) space.Allocate(4 * SPACE_PAGE_SIZE);
+    CardTable cards(space);
+    size_t numberOfCards = cards.GetNumberOfCards();
+    CPPUNIT_ASSERT_EQUAL(4 * SPACE_PAGE_SIZE / CARD_SIZE, numberOfCards);
+
+    cards.MarkCard(start + CARD_SIZE + 8);
+    cards.MarkCard(start + 2 * CARD_SIZE - 8);
+    cards.MarkCard(start);
+    CPPUNIT_ASSERT(cards.IsDirty(start + CARD_SIZE));
+    CPPUNIT_ASSERT(!cards.IsDirty(start + 2 * CARD_SIZE));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, cards.NextDirtyCard(0, numberOfCards));
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, cards.NextDirtyCard(1, numberOfCards));
+    CPPUNIT_ASSERT_EQUAL(numberOfCards, cards.NextDirtyCard(2, numberOfCards));
+
+    // clean cards are skipped up to the next dirty one, however far it is
+    size_t farCard = 3 * SPACE_PAGE_SIZE / CARD_SIZE + 3;
+    cards.CleanCard(1);
+    cards.MarkCard(cards.GetCardStart(farCard) + 1);
+    CPPUNIT_ASSERT_EQUAL(farCard, cards.NextDirtyCard(1, numberOfCards));
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, cards.NextDirtyCard(1, 5));
+}
+
+void WriteBarrierTest::testOtherHeapSelected() {
+    VMArray* arr = GetUniverse()->NewArray(1);
+    VMString* str = GetUniverse()->NewString("not remembered");
+    GetHeap<GenerationalHeap>()->writeBarrierCalledOn.clear();
+
+    // the generational heap does not exist if another collector is selected
+    gcType = MARK_SWEEP;
+    arr->SetIndexableField(0, str);
+    arr->SetClass(load_ptr(arrayClass));
+    gcType = GENERATIONAL;
+
+    CPPUNIT_ASSERT(GetHeap<GenerationalHeap>()->writeBarrierCalledOn.empty());
+}
+#endif
@@ -13,7 +13,9 @@ class WriteBarrierTest: public CPPUNIT_NS::TestCase {
     CPPUNIT_TEST (testWriteBlock);
     CPPUNIT_TEST (testWriteFrame);
     CPPUNIT_TEST (testWriteEvaluationPrimitive);
-    CPPUNIT_TEST (testWriteMethod);CPPUNIT_TEST_SUITE_END();
+    CPPUNIT_TEST (testWriteMethod);
+    CPPUNIT_TEST (testCardMarking);
+    CPPUNIT_TEST (testOtherHeapSelected);CPPUNIT_TEST_SUITE_END();
 
 public:
     inline void setUp(void) {
@@ -28,5 +30,7 @@ private:
     void testWriteFrame();
     void testWriteMethod();
     void testWriteEvaluationPrimitive();
+    void testCardMarking();
+    void testOtherHeapSelected();
 
 };
@@ -18,11 +18,33 @@
 #include "WalkObjectsTest.h"
 #include "CloneObjectsTest.h"
 #include "WriteBarrierTest.h"
+#include "InliningTest.h"
+#include "GenerationalCollectorTest.h"
+#include "PagedSpaceTest.h"
+#include "MarkDequeTest.h"
+#include "InlineCacheTest.h"
+#include "QuickeningTest.h"
+#include "TemplateJITTest.h"
+#include "TaggingTest.h"
+#include "HeapSizingTest.h"
+#include "LargeObjectSpaceTest.h"
+#include "ParallelMarkerTest.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION (WalkObjectsTest);
 CPPUNIT_TEST_SUITE_REGISTRATION (CloneObjectsTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (InliningTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (PagedSpaceTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (MarkDequeTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (InlineCacheTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (QuickeningTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (TemplateJITTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (TaggingTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (HeapSizingTest);
+CPPUNIT_TEST_SUITE_REGISTRATION (LargeObjectSpaceTest);
 #if GC_TYPE==GENERATIONAL
 CPPUNIT_TEST_SUITE_REGISTRATION(WriteBarrierTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(GenerationalCollectorTest);
+CPPUNIT_TEST_SUITE_REGISTRATION(ParallelMarkerTest);
 #endif
 
 int main(int ac, char **av) {
@@ -0,0 +1,502 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <unordered_map>
+
+#include "Image.h"
+#include "Universe.h"
+
+#include <vmobjects/VMObject.h>
+#include <vmobjects/VMClass.h>
+#include <vmobjects/VMMethod.h>
+#include <vmobjects/VMFrame.h>
+#include <vmobjects/VMBlock.h>
+#include <vmobjects/VMPrimitive.h>
+#include <vmobjects/VMEvaluationPrimitive.h>
+#include <vmobjects/VMString.h>
+#include <vmobjects/VMSymbol.h>
+#include <vmobjects/InlineCache.h>
+#include <vmobjects/IntegerBox.h>
+
+#include <primitivesCore/Routine.h>
+
+#define IMAGE_MAGIC   "SOM++IMG"
+#define IMAGE_VERSION 6
+
+#define IMAGE_FLAG_TAGGING        1
+#define IMAGE_FLAG_CACHED_INTEGER 2
+#define IMAGE_FLAG_DOUBLE_TAGGING 4
+
+// how a copied object has to be patched apart from its references
+enum ImageObjectKind {
+    IMAGE_PLAIN,
+    IMAGE_STRING,
+    IMAGE_SYMBOL,
+    IMAGE_METHOD,
+    IMAGE_PRIMITIVE,
+    IMAGE_EVALUATION_PRIMITIVE
+};
+
+struct ImageHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;
+    // distance between code and vtables, identifies the binary
+    int64_t  codeOffset;
+    uint64_t numberOfObjects;
+};
+
+// followed by the object's contents and its encoded references
+struct ImageObject {
+    uint32_t kind;
+    uint32_t size;
+    uint64_t address;
+    // relative to the vtable of VMObject
+    int64_t  vtableOffset;
+    uint64_t numberOfReferences;
+};
+
+#if CACHE_INTEGER
+extern gc_oop_t prebuildInts[];
+#endif
+
+static void walkRoots(walk_heap_fn walk) {
+    nilObject      = static_cast<GCObject*>(walk(nilObject));
+    trueObject     = static_cast<GCObject*>(walk(trueObject));
+    falseObject    = static_cast<GCObject*>(walk(falseObject));
+
+    objectClass    = static_cast<GCClass*>(walk(objectClass));
+    classClass     = static_cast<GCClass*>(walk(classClass));
+    metaClassClass = static_cast<GCClass*>(walk(metaClassClass));
+
+    nilClass       = static_cast<GCClass*>(walk(nilClass));
+    integerClass   = static_cast<GCClass*>(walk(integerClass));
+    arrayClass     = static_cast<GCClass*>(walk(arrayClass));
+    methodClass    = static_cast<GCClass*>(walk(methodClass));
+    symbolClass    = static_cast<GCClass*>(walk(symbolClass));
+    primitiveClass = static_cast<GCClass*>(walk(primitiveClass));
+    stringClass    = static_cast<GCClass*>(walk(stringClass));
+    systemClass    = static_cast<GCClass*>(walk(systemClass));
+    blockClass     = static_cast<GCClass*>(walk(blockClass));
+    doubleClass    = static_cast<GCClass*>(walk(doubleClass));
+
+    trueClass      = static_cast<GCClass*>(walk(trueClass));
+    falseClass     = static_cast<GCClass*>(walk(falseClass));
+
+    symbolIfTrue   = static_cast<GCSymbol*>(walk(symbolIfTrue));
+    symbolIfFalse  = static_cast<GCSymbol*>(walk(symbolIfFalse));
+
+#if USE_TAGGING || USE_DOUBLE_TAGGING
+    GlobalBox::WalkGlobals(walk);
+#endif
+#if CACHE_INTEGER
+    for (long i = 0; i <= INT_CACHE_MAX_VALUE - INT_CACHE_MIN_VALUE; i++)
+        prebuildInts[i] = walk(prebuildInts[i]);
+#endif
+}
+
+static void* vtableOf(const void* obj) {
+    return *(void**) obj;
+}
+
+static int64_t codeOffset(const void* vtableOfObject) {
+    return (char*) (void*) &walkRoots - (char*) vtableOfObject;
+}
+
+static uint32_t imageFlags() {
+    return (USE_TAGGING ? IMAGE_FLAG_TAGGING : 0)
+         | (CACHE_INTEGER ? IMAGE_FLAG_CACHED_INTEGER : 0)
+         | (USE_DOUBLE_TAGGING ? IMAGE_FLAG_DOUBLE_TAGGING : 0);
+}
+
+//
+// writing
+//
+
+// objects in image order, and the reverse mapping
+static vector<AbstractVMObject*> objects;
+static unordered_map<AbstractVMObject*, uint64_t> objectIndices;
+
+// the encoded references recorded by the last walk
+static vector<uint64_t> references;
+
+// nil and immediates are stored as they are, objects as (index + 1) << 2
+static uint64_t encodeReference(gc_oop_t oop) {
+    if (oop == nullptr || IS_IMMEDIATE(oop))
+        return (uint64_t) oop;
+
+    AbstractVMObject* obj = AS_OBJ(oop);
+    unordered_map<AbstractVMObject*, uint64_t>::iterator it = objectIndices.find(obj);
+    if (it != objectIndices.end())
+        return (it->second + 1) << 2;
+
+    uint64_t index = objects.size();
+    objects.push_back(obj);
+    objectIndices[obj] = index;
+    return (index + 1) << 2;
+}
+
+static gc_oop_t recordReference(gc_oop_t oop) {
+    references.push_back(encodeReference(oop));
+    return oop;
+}
+
+static ImageObjectKind kindOf(AbstractVMObject* obj) {
+    if (dynamic_cast<VMEvaluationPrimitive*>(obj))
+        return IMAGE_EVALUATION_PRIMITIVE;
+    if (dynamic_cast<VMPrimitive*>(obj))
+        return IMAGE_PRIMITIVE;
+    if (dynamic_cast<VMMethod*>(obj))
+        return IMAGE_METHOD;
+    if (dynamic_cast<VMSymbol*>(obj))
+        return IMAGE_SYMBOL;
+    if (dynamic_cast<VMString*>(obj))
+        return IMAGE_STRING;
+    if (dynamic_cast<VMFrame*>(obj) || dynamic_cast<VMBlock*>(obj)) {
+        cout << "Can't write " << obj->AsDebugString()
+             << " to an image, only the bootstrapped heap can be saved" << endl;
+        GetUniverse()->Quit(ERR_FAIL);
+    }
+    return IMAGE_PLAIN;
+}
+
+static void writeSection(FILE* file, const vector<uint64_t>& section) {
+    uint64_t size = section.size();
+    fwrite(&size, sizeof(uint64_t), 1, file);
+    fwrite(section.data(), sizeof(uint64_t), size, file);
+}
+
+void Image::Write(const StdString& fileName) {
+    Universe* universe = GetUniverse();
+
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if (file == nullptr) {
+        cout << "Can't write image " << fileName << endl;
+        GetUniverse()->Quit(ERR_FAIL);
+    }
+
+    // stale inline caches are cleared when walked, so none are saved
+    InlineCache::InvalidateAll();
+
+    references.clear();
+    walkRoots(recordReference);
+    vector<uint64_t> roots;
+    roots.swap(references);
+
+    vector<uint64_t> globals;
+    vector<uint64_t> primitiveClasses;
+    for (vector<GlobalCell*>::iterator it = universe->globals.begin();
+         it != universe->globals.end(); ++it) {
+        globals.push_back(encodeReference((*it)->name));
+        globals.push_back(encodeReference((*it)->value));
+
+        // classes with primitives get them bound again when loading
+        vm_oop_t value = load_ptr((*it)->value);
+        if (IS_IMMEDIATE(value) || CLASS_OF(value)->GetClass() != load_ptr(metaClassClass))
+            continue;
+        VMClass* cls = static_cast<VMClass*>(value);
+        if (cls->HasPrimitives() || cls->GetClass()->HasPrimitives())
+            primitiveClasses.push_back(encodeReference((*it)->value));
+    }
+
+    vector<uint64_t> blockClasses;
+    for (map<long, GCClass*>::iterator it = universe->blockClassesByNoOfArgs.begin();
+         it != universe->blockClassesByNoOfArgs.end(); ++it) {
+        blockClasses.push_back(it->first);
+        blockClasses.push_back(encodeReference(it->second));
+    }
+
+    references.clear();
+    universe->symbolsMap.WalkObjects(recordReference);
+    vector<uint64_t> symbols;
+    symbols.swap(references);
+
+    ImageHeader header;
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.version         = IMAGE_VERSION;
+    header.flags           = imageFlags();
+    header.codeOffset      = codeOffset(vtableOf(load_ptr(nilObject)));
+    header.numberOfObjects = 0;
+    fwrite(&header, sizeof(ImageHeader), 1, file);
+
+    void* vtableOfObject = vtableOf(load_ptr(nilObject));
+
+    // walking an object might add further objects to the end of the list
+    for (size_t i = 0; i < objects.size(); ++i) {
+        AbstractVMObject* obj = objects[i];
+
+        ImageObject record;
+        record.kind = kindOf(obj);
+
+        references.clear();
+        obj->WalkObjects(recordReference);
+
+        record.size               = PADDED_SIZE(obj->GetObjectSize());
+        record.address            = (uint64_t) obj;
+        record.vtableOffset       = (char*) vtableOf(obj) - (char*) vtableOfObject;
+        record.numberOfReferences = references.size();
+
+        fwrite(&record, sizeof(ImageObject), 1, file);
+        fwrite(obj, 1, record.size, file);
+        fwrite(references.data(), sizeof(uint64_t), references.size(), file);
+    }
+
+    writeSection(file, roots);
+    writeSection(file, globals);
+    writeSection(file, blockClasses);
+    writeSection(file, symbols);
+    writeSection(file, primitiveClasses);
+
+    header.numberOfObjects = objects.size();
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(ImageHeader), 1, file);
+
+    if (ferror(file) || fclose(file) != 0) {
+        cout << "Can't write image " << fileName << endl;
+        GetUniverse()->Quit(ERR_FAIL);
+    }
+
+    cout << "Wrote " << objects.size() << " objects to image " << fileName << endl;
+
+    objects.clear();
+    objectIndices.clear();
+    references.clear();
+}
+
+//
+// loading
+//
+
+// the heap copies of the image's objects, in image order
+static vector<AbstractVMObject*> copies;
+
+// the image being loaded, for error messages
+static StdString imageName;
+
+// the next encoded reference to be replayed, and where the references that
+// may be replayed end
+static const uint64_t* cursor;
+static const char* cursorEnd;
+
+static __attribute__((noreturn)) void invalidImage(const char* reason) {
+    GetUniverse()->ErrorExit(("Can't load image " + imageName + ": " + reason).c_str());
+}
+
+// the image is not trusted, a damaged one must not make the VM read outside
+// of the mapped file or of the copies
+static gc_oop_t decodeReference(uint64_t reference) {
+    if (reference == 0 || IS_IMMEDIATE(reference))
+        return (gc_oop_t) reference;
+    if (reference & 3)
+        invalidImage("immediate values are not supported by this VM");
+    uint64_t index = (reference >> 2) - 1;
+    if (index >= copies.size())
+        invalidImage("reference to an unknown object");
+    return (gc_oop_t) copies[index];
+}
+
+static uint64_t nextReference() {
+    if ((const char*) (cursor + 1) > cursorEnd)
+        invalidImage("file too short");
+    return *cursor++;
+}
+
+static gc_oop_t replayReference(gc_oop_t) {
+    return decodeReference(nextReference());
+}
+
+// the sections refer to symbols and classes, never to nil or immediates
+static gc_oop_t replayObject() {
+    uint64_t reference = nextReference();
+    if (reference == 0 || (reference & 3))
+        invalidImage("object expected");
+    return decodeReference(reference);
+}
+
+template<class T>
+static inline void relocatePointer(T*& ptr, ptrdiff_t delta) {
+    if (ptr != nullptr)
+        ptr = (T*) ((char*) ptr + delta);
+}
+
+void Image::relocate(AbstractVMObject* copy, uint32_t kind, ptrdiff_t delta) {
+    switch (kind) {
+        case IMAGE_STRING:
+            relocatePointer(static_cast<VMString*>(copy)->chars, delta);
+            break;
+        case IMAGE_SYMBOL:
+            // the cells of globals are created again from the globals section
+            relocatePointer(static_cast<VMString*>(copy)->chars, delta);
+            static_cast<VMSymbol*>(copy)->globalCell = nullptr;
+            break;
+        case IMAGE_METHOD: {
+            VMMethod* method = static_cast<VMMethod*>(copy);
+            relocatePointer(method->indexableFields,    delta);
+            relocatePointer(method->bytecodes,          delta);
+            relocatePointer(method->inlineCacheIndices, delta);
+            relocatePointer(method->inlineCaches,       delta);
+            method->threadedCode    = nullptr;
+            method->threadedTargets = nullptr;
+            method->compiledCode    = nullptr;
+            method->hotness         = 0;
+            break;
+        }
+        case IMAGE_PRIMITIVE: {
+            // bound to the real routine once the primitive classes are loaded
+            VMPrimitive* prim = static_cast<VMPrimitive*>(copy);
+            prim->SetRoutine(new Routine<VMPrimitive>(prim, &VMPrimitive::EmptyRoutine, false));
+            prim->SetEmpty(true);
+            break;
+        }
+        case IMAGE_EVALUATION_PRIMITIVE: {
+            VMEvaluationPrimitive* prim = static_cast<VMEvaluationPrimitive*>(copy);
+            prim->SetRoutine(new Routine<VMEvaluationPrimitive>(prim, &VMEvaluationPrimitive::evaluationRoutine, false));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void Image::Load(const StdString& fileName) {
+    Universe* universe = GetUniverse();
+    imageName = fileName;
+
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat fileInfo;
+    if (fd < 0 || fstat(fd, &fileInfo) != 0)
+        invalidImage("file not found");
+
+    size_t imageSize = fileInfo.st_size;
+    if (imageSize < sizeof(ImageHeader))
+        invalidImage("file too short");
+
+    const char* image = (const char*) mmap(nullptr, imageSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+        invalidImage("mmap failed");
+
+    const char* end = image + imageSize;
+
+    // every object allocated so far has the vtable of VMObject at hand
+    void* vtableOfObject = vtableOf(new (GetHeap<HEAP_CLS>()) VMObject);
+
+    const ImageHeader* header = (const ImageHeader*) image;
+    if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0)
+        invalidImage("not an image");
+    if (header->version != IMAGE_VERSION || header->flags != imageFlags()
+            || header->codeOffset != codeOffset(vtableOfObject))
+        invalidImage("written by a different VM");
+
+    const char* position = image + sizeof(ImageHeader);
+    long oldBits = gcType == GENERATIONAL ? MASK_OBJECT_IS_OLD : 0;
+
+    // copy all objects into the heap first, references are fixed below
+    vector<const ImageObject*> records;
+    copies.clear();
+    for (uint64_t i = 0; i < header->numberOfObjects; ++i) {
+        const ImageObject* record = (const ImageObject*) position;
+        if (sizeof(ImageObject) > (size_t) (end - position))
+            invalidImage("file too short");
+        position += sizeof(ImageObject);
+        if (record->size % sizeof(uint64_t) != 0 || record->kind > IMAGE_EVALUATION_PRIMITIVE)
+            invalidImage("object layout does not match");
+        size_t remaining = end - position;
+        if (record->size > remaining
+                || record->numberOfReferences > (remaining - record->size) / sizeof(uint64_t))
+            invalidImage("file too short");
+
+        AbstractVMObject* copy = GetHeap<HEAP_CLS>()->AllocateObject(record->size, true);
+        memcpy(copy, position, record->size);
+        *(void**) copy = (char*) vtableOfObject + record->vtableOffset;
+        copy->SetGCField(oldBits);
+        relocate(copy, record->kind, (char*) copy - (char*) record->address);
+
+        position += record->size + record->numberOfReferences * sizeof(uint64_t);
+        records.push_back(record);
+        copies.push_back(copy);
+    }
+
+    for (size_t i = 0; i < copies.size(); ++i) {
+        const uint64_t* refs = (const uint64_t*) (records[i] + 1) + records[i]->size / sizeof(uint64_t);
+        cursor = refs;
+        cursorEnd = (const char*) (refs + records[i]->numberOfReferences);
+        copies[i]->WalkObjects(replayReference);
+        if (cursor != refs + records[i]->numberOfReferences)
+            invalidImage("object layout does not match");
+    }
+
+    // the method dictionaries are not part of the image
+    for (size_t i = 0; i < copies.size(); ++i) {
+        VMClass* cls = dynamic_cast<VMClass*>(copies[i]);
+        if (cls != nullptr && cls->GetInstanceInvokables() != nullptr)
+            cls->SetInstanceInvokables(cls->GetInstanceInvokables());
+    }
+
+    cursor = (const uint64_t*) position;
+    cursorEnd = end;
+    uint64_t numberOfRoots = nextReference();
+    const uint64_t* roots = cursor;
+    walkRoots(replayReference);
+    if (cursor != roots + numberOfRoots)
+        invalidImage("roots do not match");
+
+    // globals and block classes are stored as pairs
+    for (uint64_t n = nextReference() / 2; n > 0; --n) {
+        VMSymbol* name = load_ptr(static_cast<GCSymbol*>(replayObject()));
+        universe->SetGlobal(name, load_ptr(replayReference(nullptr)));
+    }
+
+    universe->blockClassesByNoOfArgs.clear();
+    for (uint64_t n = nextReference() / 2; n > 0; --n) {
+        long numberOfArguments = nextReference();
+        universe->blockClassesByNoOfArgs[numberOfArguments] =
+                static_cast<GCClass*>(replayObject());
+    }
+
+    universe->symbolsMap.Clear();
+    for (uint64_t n = nextReference(); n > 0; --n)
+        universe->symbolsMap.Insert(load_ptr(static_cast<GCSymbol*>(replayObject())));
+
+    vector<VMClass*> primitiveClasses;
+    for (uint64_t n = nextReference(); n > 0; --n)
+        primitiveClasses.push_back(load_ptr(static_cast<GCClass*>(replayObject())));
+
+    if ((const char*) cursor != end)
+        invalidImage("unexpected file size");
+
+    munmap((void*) image, imageSize);
+    copies.clear();
+
+    for (size_t i = 0; i < primitiveClasses.size(); ++i)
+        primitiveClasses[i]->LoadPrimitives(universe->classPath);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <cstddef>
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+/*
+ * A heap image holds everything that is reachable from the VM's globals after
+ * bootstrapping. Starting from an image replaces compiling the core library.
+ *
+ * Every object is stored with its raw contents, followed by the references
+ * WalkObjects reports for it, encoded as object indices. Load() copies the
+ * objects out of the mapped file into the heap and replays WalkObjects on the
+ * copies to fix the references, so the image does not depend on where objects
+ * end up. An image is only valid for the VM binary that wrote it.
+ */
+class Image {
+public:
+    static void Write(const StdString& fileName);
+    static void Load(const StdString& fileName);
+
+private:
+    static void relocate(AbstractVMObject* copy, uint32_t kind, ptrdiff_t delta);
+};
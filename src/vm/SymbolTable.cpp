@@ -0,0 +1,94 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#include "SymbolTable.h"
+
+#include <vmobjects/VMSymbol.h>
+
+SymbolTable::SymbolTable() : slots(nullptr), numberOfSymbols(0), capacity(0) {
+}
+
+SymbolTable::~SymbolTable() {
+    delete[] slots;
+}
+
+VMSymbol* SymbolTable::Lookup(const char* str) const {
+    if (numberOfSymbols == 0)
+        return nullptr;
+
+    size_t hash = VMSymbol::HashChars(str);
+    size_t mask = capacity - 1;
+    for (size_t i = hash & mask; slots[i] != nullptr; i = (i + 1) & mask) {
+        VMSymbol* symbol = load_ptr(slots[i]);
+        if (symbol->selectorHash == hash && strcmp(symbol->GetChars(), str) == 0)
+            return symbol;
+    }
+    return nullptr;
+}
+
+void SymbolTable::Insert(VMSymbol* symbol) {
+    // at most half of the slots are in use
+    if (2 * (numberOfSymbols + 1) > capacity)
+        grow();
+
+    size_t mask = capacity - 1;
+    size_t i = symbol->selectorHash & mask;
+    while (slots[i] != nullptr)
+        i = (i + 1) & mask;
+
+    slots[i] = _store_ptr(symbol);
+    numberOfSymbols++;
+}
+
+void SymbolTable::Clear() {
+    for (size_t i = 0; i < capacity; ++i)
+        slots[i] = nullptr;
+    numberOfSymbols = 0;
+}
+
+void SymbolTable::grow() {
+    GCSymbol** old = slots;
+    size_t oldCapacity = capacity;
+
+    capacity = capacity == 0 ? 1024 : 2 * capacity;
+    slots = new GCSymbol*[capacity]();
+    numberOfSymbols = 0;
+
+    for (size_t i = 0; i < oldCapacity; ++i) {
+        if (old[i] != nullptr)
+            Insert(load_ptr(old[i]));
+    }
+    delete[] old;
+}
+
+void SymbolTable::WalkObjects(walk_heap_fn walk) {
+    for (size_t i = 0; i < capacity; ++i) {
+        if (slots[i] != nullptr)
+            slots[i] = static_cast<GCSymbol*>(walk(slots[i]));
+    }
+}
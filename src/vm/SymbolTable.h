@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "../misc/defs.h"
+#include "../vmobjects/ObjectFormats.h"
+
+/*
+ * The interned symbols, in an open-addressing table keyed by the hash of
+ * their characters. As the hash survives moving a symbol, a collection only
+ * has to update the entries in place.
+ */
+class SymbolTable {
+public:
+    SymbolTable();
+    ~SymbolTable();
+
+    // the symbol with the given characters, or nullptr if there is none yet
+    VMSymbol* Lookup(const char* str) const;
+    void      Insert(VMSymbol* symbol);
+    void      Clear();
+
+    void      WalkObjects(walk_heap_fn);
+
+private:
+    void grow();
+
+    GCSymbol** slots;
+    size_t     numberOfSymbols;
+    size_t     capacity;
+};
@@ -32,6 +32,7 @@
 
 #include "Universe.h"
 #include "Shell.h"
+#include "Image.h"
 
 #include <vmobjects/VMSymbol.h>
 #include <vmobjects/VMObject.h>
@@ -46,11 +47,14 @@
 #include <vmobjects/VMEvaluationPrimitive.h>
 
 #include <interpreter/bytecodes.h>
+#include <interpreter/TemplateJIT.h>
 
 #include <compiler/Disassembler.h>
 #include <compiler/SourcecodeCompiler.h>
 
 #include "../vmobjects/IntegerBox.h"
+#include "../memory/SelectedHeap.h"
+#include "../memory/ParallelMarker.h"
 
 #if CACHE_INTEGER
 gc_oop_t prebuildInts[INT_CACHE_MAX_VALUE - INT_CACHE_MIN_VALUE + 1];
@@ -62,6 +66,8 @@ gc_oop_t prebuildInts[INT_CACHE_MAX_VALUE - INT_CACHE_MIN_VALUE + 1];
 
 short dumpBytecodes;
 short gcVerbosity;
+bool  profileBytecodes;
+bool  useJIT;
 
 Universe* Universe::theUniverse = nullptr;
 
@@ -102,6 +108,10 @@ void Universe::Start(long argc, char** argv) {
 __attribute__((noreturn)) void Universe::Quit(long err) {
     cout << "Time spent in GC: [" << Timer::GCTimer->GetTotalTime() << "] msec"
             << endl;
+    if (gcVerbosity > 0)
+        GetHeap<HEAP_CLS>()->PrintGCStat();
+    if (profileBytecodes && theUniverse && theUniverse->interpreter)
+        theUniverse->interpreter->PrintBytecodeCounts();
 #ifdef GENERATE_INTEGER_HISTOGRAM
     std::string file_name_hist = std::string(bm_name);
     file_name_hist.append("_integer_histogram.csv");
@@ -150,10 +160,27 @@ __attribute__((noreturn)) void Universe::ErrorExit(const char* err) {
     Quit(ERR_FAIL);
 }
 
+// parses sizes such as 512KB or 16MB, returns 0 if the size is malformed
+static long parseSize(const char* arg) {
+    long size = 0;
+    char unit[3];
+    if (sscanf(arg, "%ld%2s", &size, unit) != 2 || size <= 0)
+        return 0;
+    if (strcmp(unit, "KB") == 0)
+        return size * 1024;
+    if (strcmp(unit, "MB") == 0)
+        return size * 1024 * 1024;
+    if (strcmp(unit, "GB") == 0)
+        return size * 1024 * 1024 * 1024;
+    return 0;
+}
+
 vector<StdString> Universe::handleArguments(long argc, char** argv) {
     vector<StdString> vmArgs = vector<StdString>();
     dumpBytecodes = 0;
     gcVerbosity   = 0;
+    profileBytecodes = false;
+    useJIT = false;
 
     for (long i = 1; i < argc; ++i) {
 
@@ -161,21 +188,64 @@ vector<StdString> Universe::handleArguments(long argc, char** argv) {
             if ((argc == i + 1) || classPath.size() > 0)
                 printUsageAndExit(argv[0]);
             setupClassPath(StdString(argv[++i]));
+        } else if (strcmp(argv[i], "-image") == 0) {
+            if (argc == i + 1)
+                printUsageAndExit(argv[0]);
+            imageFile = argv[++i];
+        } else if (strcmp(argv[i], "-snapshot") == 0) {
+            if (argc == i + 1)
+                printUsageAndExit(argv[0]);
+            snapshotFile = argv[++i];
+        } else if (strncmp(argv[i], "-gc:", 4) == 0) {
+            if (!SelectedHeap::Select(argv[i] + 4))
+                printUsageAndExit(argv[0]);
+        } else if (strncmp(argv[i], "-gcthreads:", 11) == 0) {
+            long threads = 0;
+            if (sscanf(argv[i], "-gcthreads:%ld", &threads) != 1 || threads < 1
+                    || threads > MAX_GC_THREADS)
+                printUsageAndExit(argv[0]);
+            ParallelMarker::numberOfThreads = threads;
         } else if (strncmp(argv[i], "-d", 2) == 0) {
             ++dumpBytecodes;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            profileBytecodes = true;
+        } else if (strcmp(argv[i], "-jit") == 0) {
+            if (TemplateJIT::IsSupported())
+                useJIT = true;
+            else
+                cout << "No JIT compiler for this platform, ignoring -jit" << endl;
         } else if (strncmp(argv[i], "-g", 2) == 0) {
             ++gcVerbosity;
-        } else if (strncmp(argv[i], "-H", 2) == 0) {
-            long heap_size = 0;
-            char unit[3];
-            if (sscanf(argv[i], "-H%ld%2s", &heap_size, unit) == 2) {
-                if (strcmp(unit, "KB") == 0)
-                    heapSize = heap_size * 1024;
-                else if (strcmp(unit, "MB") == 0)
-                    heapSize = heap_size * 1024 * 1024;
-            } else
+        } else if (strncmp(argv[i], "-H", 2) == 0
+                || strncmp(argv[i], "-Xms", 4) == 0) {
+            heapSize = parseSize(argv[i] + (argv[i][1] == 'H' ? 2 : 4));
+            if (heapSize == 0)
                 printUsageAndExit(argv[0]);
-
+        } else if (strncmp(argv[i], "-Xmx", 4) == 0) {
+            HeapSizing::maxHeapSize = parseSize(argv[i] + 4);
+            if (HeapSizing::maxHeapSize == 0)
+                printUsageAndExit(argv[0]);
+        } else if (strncmp(argv[i], "-Xmn", 4) == 0) {
+            HeapSizing::nurserySize = parseSize(argv[i] + 4);
+            if (HeapSizing::nurserySize == 0)
+                printUsageAndExit(argv[0]);
+        } else if (strncmp(argv[i], "-GT", 3) == 0) {
+            long overhead = 0;
+            if (sscanf(argv[i], "-GT%ld", &overhead) != 1 || overhead < 1
+                    || overhead > 100)
+                printUsageAndExit(argv[0]);
+            HeapSizing::targetGCOverhead = overhead;
+        } else if (strncmp(argv[i], "-SR", 3) == 0) {
+            long ratio = 0;
+            if (sscanf(argv[i], "-SR%ld", &ratio) != 1 || ratio < 1)
+                printUsageAndExit(argv[0]);
+            GenerationalHeap::survivorRatio = ratio;
+        } else if (strncmp(argv[i], "-TA", 3) == 0) {
+            long age = -1;
+            if (sscanf(argv[i], "-TA%ld", &age) != 1 || age < 0
+                    || age > MAX_OBJECT_AGE)
+                printUsageAndExit(argv[0]);
+            GenerationalHeap::maxTenuringAge = age;
         } else if ((strncmp(argv[i], "-h", 2) == 0)
                 || (strncmp(argv[i], "--help", 6) == 0)) {
             printUsageAndExit(argv[0]);
@@ -196,6 +266,9 @@ vector<StdString> Universe::handleArguments(long argc, char** argv) {
     }
     addClassPath(StdString("."));
 
+    if (HeapSizing::maxHeapSize != 0 && (size_t) heapSize > HeapSizing::maxHeapSize)
+        printUsageAndExit(argv[0]);
+
     return vmArgs;
 }
 
@@ -254,14 +327,40 @@ void Universe::printUsageAndExit(char* executable) const {
     cout << "    -cp <directories separated by " << pathSeparator << ">"
          << endl;
     cout << "        set search path for application classes" << endl;
+    cout << "    -image <file> start from a heap image instead of loading "
+         << "the core library" << endl;
+    cout << "    -snapshot <file> write the bootstrapped heap to an image and "
+         << "exit," << endl
+         << "        classes given as arguments are loaded first" << endl;
     cout << "    -d  enable disassembling (twice for tracing)" << endl;
+    cout << "    -p  count executed bytecodes, print them when VM shuts down"
+         << endl;
+    cout << "    -jit compile frequently executed methods to machine code"
+         << endl;
     cout << "    -g  enable garbage collection details:" << endl
          << "        1x - print statistics when VM shuts down" << endl
          << "        2x - print statistics upon each collection" << endl
          << "        3x - print statistics and dump heap upon each " << endl
          << "collection" << endl;
+    cout << "    -gc:<generational|copying|marksweep> select the garbage "
+         << "collector (default: " << SelectedHeap::GetName() << ")" << endl;
+    cout << "    -gcthreads:N mark with N threads in full collections "
+         << "(generational and marksweep GC, 1-" << MAX_GC_THREADS
+         << ", default: " << DEFAULT_GC_THREADS << ")" << endl;
     cout << "    -HxMB set the heap size to x MB (default: 1 MB)" << endl;
     cout << "    -HxKB set the heap size to x KB (default: 1 MB)" << endl;
+    cout << "    -Xms<size> same as -H, sizes are given in KB, MB or GB" << endl;
+    cout << "    -Xmx<size> set the maximum heap size (default: no limit)"
+         << endl;
+    cout << "    -Xmn<size> set a fixed nursery size (generational GC, "
+         << "default: the heap size, adapted at runtime)" << endl;
+    cout << "    -GTx aim at spending at most x percent of the time in GC "
+         << "(default: " << DEFAULT_TARGET_GC_OVERHEAD << ")" << endl;
+    cout << "    -SRx set the ratio of eden to one survivor space to x "
+         << "(generational GC, default: " << DEFAULT_SURVIVOR_RATIO << ")" << endl;
+    cout << "    -TAx promote objects after surviving x minor collections "
+         << "(generational GC, 0-" << MAX_OBJECT_AGE << ", default: "
+         << DEFAULT_MAX_TENURING_AGE << ")" << endl;
     cout << "    -h  show this help" << endl;
 
     Quit(ERR_SUCCESS);
@@ -285,7 +384,28 @@ void Universe::initialize(long _argc, char** _argv) {
     if (argv.size() > 0)
         bm_name = argv[0];
 
-    Heap<HEAP_CLS>::InitializeHeap(heapSize);
+    cout << "\tgarbage collector: " << SelectedHeap::GetName() << endl;
+    if (ParallelMarker::numberOfThreads > 1)
+        cout << "\tmarking with " << ParallelMarker::numberOfThreads
+             << " threads" << endl;
+
+    if (USE_TAGGING)
+        cout << "\twith tagged integers" << endl;
+    else
+        cout << "\tnot tagging integers" << endl;
+
+    if (USE_DOUBLE_TAGGING)
+        cout << "\twith tagged doubles" << endl;
+
+    if (CACHE_INTEGER)
+        cout << "\tcaching integers from " << INT_CACHE_MIN_VALUE
+             << " to " << INT_CACHE_MAX_VALUE << endl;
+    else
+        cout << "\tnot caching integers" << endl;
+
+    cout << "--------------------------------------" << endl;
+
+    HEAP_CLS::InitializeHeap(heapSize);
 
     interpreter = new Interpreter();
 
@@ -297,21 +417,30 @@ void Universe::initialize(long _argc, char** _argv) {
     }
 #endif
 
-    InitializeGlobals();
+    if (imageFile.empty()) {
+        InitializeGlobals();
 
-    VMObject* systemObject = NewInstance(load_ptr(systemClass));
+        SetGlobal(SymbolForChars("nil"),    load_ptr(nilObject));
+        SetGlobal(SymbolForChars("true"),   load_ptr(trueObject));
+        SetGlobal(SymbolForChars("false"),  load_ptr(falseObject));
+        SetGlobal(SymbolForChars("system"), NewInstance(load_ptr(systemClass)));
+        SetGlobal(SymbolForChars("System"), load_ptr(systemClass));
+        SetGlobal(SymbolForChars("Block"),  load_ptr(blockClass));
 
-    SetGlobal(SymbolForChars("nil"),    load_ptr(nilObject));
-    SetGlobal(SymbolForChars("true"),   load_ptr(trueObject));
-    SetGlobal(SymbolForChars("false"),  load_ptr(falseObject));
-    SetGlobal(SymbolForChars("system"), systemObject);
-    SetGlobal(SymbolForChars("System"), load_ptr(systemClass));
-    SetGlobal(SymbolForChars("Block"),  load_ptr(blockClass));
+        symbolIfTrue  = _store_ptr(SymbolForChars("ifTrue:"));
+        symbolIfFalse = _store_ptr(SymbolForChars("ifFalse:"));
+    } else
+        Image::Load(imageFile);
 
-    symbolIfTrue  = _store_ptr(SymbolForChars("ifTrue:"));
-    symbolIfFalse = _store_ptr(SymbolForChars("ifFalse:"));
+    if (!snapshotFile.empty()) {
+        for (vector<StdString>::iterator i = argv.begin(); i != argv.end(); ++i)
+            LoadClass(SymbolFor(*i));
+        Image::Write(snapshotFile);
+        Quit(ERR_SUCCESS);
+    }
+
+    vm_oop_t systemObject = GetGlobal(SymbolForChars("system"));
 
-    
 
     VMMethod* bootstrapMethod = NewMethod(SymbolForChars("bootstrap"), 1, 0);
     bootstrapMethod->SetBytecode(0, BC_HALT);
@@ -352,8 +481,11 @@ Universe::~Universe() {
     if (interpreter)
         delete (interpreter);
 
+    for (vector<GlobalCell*>::iterator it = globals.begin(); it != globals.end(); ++it)
+        delete *it;
+
     // check done inside
-    Heap<HEAP_CLS>::DestroyHeap();
+    HEAP_CLS::DestroyHeap();
 }
 
 #if !DEBUG
@@ -377,7 +509,7 @@ Universe::~Universe() {
     void* vt_symbol;
 
     bool Universe::IsValidObject(vm_oop_t obj) {
-        if (IS_TAGGED(obj))
+        if (IS_IMMEDIATE(obj))
             return true;
 
         if (obj == INVALID_VM_POINTER
@@ -454,7 +586,7 @@ Universe::~Universe() {
         VMPrimitive* prm = new (GetHeap<HEAP_CLS>()) VMPrimitive(className);
         vt_primitive  = *(void**) prm;
         
-        VMString* str = new (GetHeap<HEAP_CLS>()) VMString("");
+        VMString* str = new (GetHeap<HEAP_CLS>(), PADDED_SIZE(1)) VMString("");
         vt_string     = *(void**) str;
         vt_symbol     = *(void**) className;
     }
@@ -468,7 +600,11 @@ void Universe::InitializeGlobals() {
     //
     //allocate nil object
     //
-    VMObject* nil = new (GetHeap<HEAP_CLS>()) VMObject;
+    // arrays too large for the nursery are old from the start, and filled
+    // with nil without passing the write barrier, so nil has to be old too
+    VMObject* nil = new (GetHeap<HEAP_CLS>(), 0 ALLOC_MATURE) VMObject;
+    if (gcType == GENERATIONAL)
+        nil->SetGCField(MASK_OBJECT_IS_OLD);
     nilObject = _store_ptr(nil);
     nil->SetClass((VMClass*) nil);
 
@@ -507,6 +643,9 @@ void Universe::InitializeGlobals() {
 #if USE_TAGGING
     GlobalBox::updateIntegerBox(NewInteger(1));
 #endif
+#if USE_DOUBLE_TAGGING
+    GlobalBox::updateDoubleBox(NewDouble(0.0));
+#endif
 
     LoadSystemClass(load_ptr(objectClass));
     LoadSystemClass(load_ptr(classClass));
@@ -567,23 +706,12 @@ VMClass* Universe::GetBlockClassWithArgs(long numberOfArguments) {
 }
 
 vm_oop_t Universe::GetGlobal(VMSymbol* name) {
-    # warning is _store_ptr correct here? it relies on _store_ptr not to be really changed...
-    auto it = globals.find(_store_ptr(name));
-    if (it == globals.end()) {
-        return nullptr;
-    } else {
-        return load_ptr(it->second);
-    }
+    GlobalCell* cell = name->GetGlobalCell();
+    return cell == nullptr ? nullptr : load_ptr(cell->value);
 }
 
 bool Universe::HasGlobal(VMSymbol* name) {
-    # warning is _store_ptr correct here? it relies on _store_ptr not to be really changed...
-    auto it = globals.find(_store_ptr(name));
-    if (it == globals.end()) {
-        return false;
-    } else {
-        return true;
-    }
+    return name->GetGlobalCell() != nullptr;
 }
 
 void Universe::InitializeSystemClass(VMClass* systemClass,
@@ -684,10 +812,12 @@ void Universe::WalkGlobals(walk_heap_fn walk) {
     trueObject  = static_cast<GCObject*>(walk(trueObject));
     falseObject = static_cast<GCObject*>(walk(falseObject));
 
-#if USE_TAGGING
+#if USE_TAGGING || USE_DOUBLE_TAGGING
     GlobalBox::WalkGlobals(walk);
 #endif
 
+    MethodCache::WalkObjects(walk);
+
     objectClass    = static_cast<GCClass*>(walk(objectClass));
     classClass     = static_cast<GCClass*>(walk(classClass));
     metaClassClass = static_cast<GCClass*>(walk(metaClassClass));
@@ -715,26 +845,15 @@ void Universe::WalkGlobals(walk_heap_fn walk) {
 #endif
 #endif
 
-    // walk all entries in globals map
-    map<GCSymbol*, gc_oop_t> globs = globals;
-    globals.clear();
-    map<GCSymbol*, gc_oop_t>::iterator iter;
-    for (iter = globs.begin(); iter != globs.end(); iter++) {
-        assert(iter->second != nullptr);
+    // walk all global cells, the names carry the cells along when moved
+    for (vector<GlobalCell*>::iterator iter = globals.begin(); iter != globals.end(); iter++) {
+        assert((*iter)->value != nullptr);
 
-        GCSymbol* key = static_cast<GCSymbol*>(walk(iter->first));
-        gc_oop_t val = walk(iter->second);
-        globals[key] = val;
+        (*iter)->name  = static_cast<GCSymbol*>(walk((*iter)->name));
+        (*iter)->value = walk((*iter)->value);
     }
     
-    // walk all entries in symbols map
-    map<StdString, GCSymbol*>::iterator symbolIter;
-    for (symbolIter = symbolsMap.begin();
-         symbolIter != symbolsMap.end();
-         symbolIter++) {
-        //insert overwrites old entries inside the internal map
-        symbolIter->second = static_cast<GCSymbol*>(walk(symbolIter->second));
-    }
+    symbolsMap.WalkObjects(walk);
 
     map<long, GCClass*>::iterator bcIter;
     for (bcIter = blockClassesByNoOfArgs.begin();
@@ -743,23 +862,28 @@ void Universe::WalkGlobals(walk_heap_fn walk) {
         bcIter->second = static_cast<GCClass*>(walk(bcIter->second));
     }
 
-    //reassign ifTrue ifFalse Symbols
-    symbolIfTrue  = symbolsMap["ifTrue:"];
-    symbolIfFalse = symbolsMap["ifFalse:"];
+    symbolIfTrue  = static_cast<GCSymbol*>(walk(symbolIfTrue));
+    symbolIfFalse = static_cast<GCSymbol*>(walk(symbolIfFalse));
     
     interpreter->WalkGlobals(walk);
 }
 
 VMSymbol* Universe::SymbolFor(const StdString& str) {
-    map<string,GCSymbol*>::iterator it = symbolsMap.find(str);
-    return (it == symbolsMap.end()) ? NewSymbol(str) : load_ptr(it->second);
+    return SymbolForChars(str.c_str());
 }
 
 VMSymbol* Universe::SymbolForChars(const char* str) {
-    return SymbolFor(str);
+    VMSymbol* symbol = symbolsMap.Lookup(str);
+    return symbol == nullptr ? NewSymbol(str) : symbol;
 }
 
 void Universe::SetGlobal(VMSymbol* name, vm_oop_t val) {
-# warning is _store_ptr correct here? it relies on _store_ptr not to be really changed...
-    globals[_store_ptr(name)] = _store_ptr(val);
+    GlobalCell* cell = name->GetGlobalCell();
+    if (cell == nullptr) {
+        cell = new GlobalCell;
+        cell->name = _store_ptr(name);
+        name->globalCell = cell;
+        globals.push_back(cell);
+    }
+    cell->value = _store_ptr(val);
 }
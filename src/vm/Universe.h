@@ -41,12 +41,16 @@
 #include "../memory/Heap.h"
 
 #include "UniverseFactory.h"
+#include "SymbolTable.h"
 
 class SourcecodeCompiler;
+struct GlobalCell;
 
 // for runtime debug
 extern short dumpBytecodes;
 extern short gcVerbosity;
+extern bool  profileBytecodes;
+extern bool  useJIT;
 
 //global VMObjects
 extern GCObject* nilObject;
@@ -78,14 +82,15 @@ using namespace std;
 class Universe {
     
     friend class UniverseFactory;
+    friend class Image;
     
 public:
     inline Universe* operator->();
 
     //static methods
     static void Start(long argc, char** argv);
-    static void Quit(long);
-    static void ErrorExit(const char*);
+    static void Quit(long) __attribute__((noreturn));
+    static void ErrorExit(const char*) __attribute__((noreturn));
 
     Interpreter* GetInterpreter() {
         return interpreter;
@@ -105,7 +110,7 @@ public:
     VMBlock* NewBlock(VMMethod* method, VMFrame* context, long arguments) { return factory.NewBlock(method, context, arguments); };
     VMClass* NewClass(VMClass* classOfClass) const { return factory.NewClass(classOfClass); };
     VMFrame* NewFrame(VMFrame* previousFrame, VMMethod* method) const { return factory.NewFrame(previousFrame, method); };
-    VMMethod* NewMethod(VMSymbol* signature, size_t numberOfBytecodes, size_t numberOfConstants) const { return factory.NewMethod(signature, numberOfBytecodes, numberOfConstants); };
+    VMMethod* NewMethod(VMSymbol* signature, size_t numberOfBytecodes, size_t numberOfConstants, size_t numberOfInlineCaches = 0) const { return factory.NewMethod(signature, numberOfBytecodes, numberOfConstants, numberOfInlineCaches); };
     VMObject* NewInstance(VMClass* classOfInstance) const { return factory.NewInstance(classOfInstance); };
     VMInteger* NewInteger(int64_t value) const { return factory.NewInteger(value); };
     VMDouble* NewDouble(double value) const { return factory.NewDouble(value); };
@@ -162,12 +167,17 @@ private:
     void initialize(long, char**);
 
     long heapSize;
+
+    // heap image to start from, and where to write one after bootstrapping
+    StdString imageFile;
+    StdString snapshotFile;
     
-    map<GCSymbol*, gc_oop_t> globals;
+    // in order of definition, the name of a global leads to its cell
+    vector<GlobalCell*> globals;
     map<long, GCClass*> blockClassesByNoOfArgs;
     vector<StdString> classPath;
     
-    map<string, GCSymbol*> symbolsMap;
+    SymbolTable symbolsMap;
 
 
     Interpreter* interpreter;
@@ -29,16 +29,13 @@ UniverseFactory::UniverseFactory(Universe* universe) {
 VMArray* UniverseFactory::NewArray(long size) const {
     long additionalBytes = size * sizeof(VMObject*);
     
-    bool outsideNursery;
-    
-#if GC_TYPE == GENERATIONAL
     // if the array is too big for the nursery, we will directly allocate a
     // mature object
-    outsideNursery = additionalBytes + sizeof(VMArray) > GetHeap<HEAP_CLS>()->GetMaxNurseryObjectSize();
-#endif
+    bool outsideNursery = gcType == GENERATIONAL &&
+            additionalBytes + sizeof(VMArray) > GetHeap<GenerationalHeap>()->GetMaxNurseryObjectSize();
     
     VMArray* result = new (GetHeap<HEAP_CLS>(), additionalBytes ALLOC_OUTSIDE_NURSERY(outsideNursery)) VMArray(size);
-    if ((GC_TYPE == GENERATIONAL) && outsideNursery)
+    if (outsideNursery)
         result->SetGCField(MASK_OBJECT_IS_OLD);
     
     result->SetClass(load_ptr(arrayClass));
@@ -178,15 +175,18 @@ VMClass* UniverseFactory::NewMetaclassClass() const {
 }
 
 VMMethod* UniverseFactory::NewMethod( VMSymbol* signature,
-                              size_t numberOfBytecodes, size_t numberOfConstants) const {
-    //Method needs space for the bytecodes and the pointers to the constants
-    long additionalBytes = PADDED_SIZE(numberOfBytecodes + numberOfConstants*sizeof(VMObject*));
+                              size_t numberOfBytecodes, size_t numberOfConstants,
+                              size_t numberOfInlineCaches) const {
+    //Method needs space for the bytecodes, the pointers to the constants,
+    //and the inline caches of its send sites
+    long additionalBytes = VMMethod::GetAdditionalSpace(numberOfBytecodes,
+            numberOfConstants, numberOfInlineCaches);
     //#if GC_TYPE==GENERATIONAL
     //    VMMethod* result = new (GetHeap<HEAP_CLS>(),additionalBytes, true)
     //                VMMethod(numberOfBytecodes, numberOfConstants);
     //#else
     VMMethod* result = new (GetHeap<HEAP_CLS>(),additionalBytes)
-    VMMethod(numberOfBytecodes, numberOfConstants);
+    VMMethod(numberOfBytecodes, numberOfConstants, numberOfInlineCaches);
     //#endif
     result->SetClass(load_ptr(methodClass));
     
@@ -213,8 +213,7 @@ VMSymbol* UniverseFactory::NewSymbol(const StdString& str) {
 
 VMSymbol* UniverseFactory::NewSymbol(const char* str) {
     VMSymbol* result = new (GetHeap<HEAP_CLS>(), PADDED_SIZE(strlen(str)+1)) VMSymbol(str);
-# warning is _store_ptr sufficient here?
-    universe->symbolsMap[str] = _store_ptr(result);
+    universe->symbolsMap.Insert(result);
     
     LOG_ALLOCATION("VMSymbol", result->GetObjectSize());
     return result;
@@ -17,7 +17,7 @@ public:
     VMBlock* NewBlock(VMMethod*, VMFrame*, long);
     VMClass* NewClass(VMClass*) const;
     VMFrame* NewFrame(VMFrame*, VMMethod*) const;
-    VMMethod* NewMethod(VMSymbol*, size_t, size_t) const;
+    VMMethod* NewMethod(VMSymbol*, size_t, size_t, size_t numberOfInlineCaches = 0) const;
     VMObject* NewInstance(VMClass*) const;
     VMInteger* NewInteger(int64_t) const;
     VMDouble* NewDouble(double) const;
@@ -12,9 +12,7 @@
 
 
 #include <misc/defs.h>
-#include <memory/GenerationalHeap.h>
-#include <memory/CopyingHeap.h>
-#include <memory/MarkSweepHeap.h>
+#include <memory/SelectedHeap.h>
 
 #include "ObjectFormats.h"
 #include "VMObjectBase.h"
@@ -80,16 +78,7 @@ public:
         // if outsideNursery flag is set or object is too big for nursery, we
         // allocate a mature object
         unsigned long add = PADDED_SIZE(additionalBytes);
-        void* result;
-#if GC_TYPE==GENERATIONAL
-        if (outsideNursery) {
-            result = (void*) heap->AllocateMatureObject(numBytes + add);
-        } else {
-            result = (void*) heap->AllocateNurseryObject(numBytes + add);
-        }
-#else
-        result = (void*) heap->AllocateObject(numBytes + add);
-#endif
+        void* result = (void*) heap->AllocateObject(numBytes + add, outsideNursery);
 
         assert(result != INVALID_VM_POINTER);
         return result;
@@ -0,0 +1,74 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include "InlineCache.h"
+#include "VMClass.h"
+#include "VMInvokable.h"
+
+#include <vm/Universe.h>
+
+long InlineCache::currentEpoch = 1;
+
+void InlineCache::Update(AbstractVMObject* holder, VMClass* receiverClass, VMInvokable* invokable) {
+    if (epoch != currentEpoch) {
+        Clear();
+        epoch = currentEpoch;
+    }
+
+    if (size == INLINE_CACHE_SIZE) {
+        megamorphic = true;
+        return;
+    }
+
+    receiverClasses[size] = _store_ptr(receiverClass);
+    write_barrier(holder, receiverClass);
+    invokables[size] = _store_ptr(invokable);
+    write_barrier(holder, invokable);
+    size++;
+}
+
+void InlineCache::Clear() {
+    epoch       = 0;
+    size        = 0;
+    megamorphic = false;
+}
+
+void InlineCache::WalkObjects(walk_heap_fn walk) {
+    if (epoch != currentEpoch) {
+        // stale entries might refer to objects that are gone already
+        Clear();
+        return;
+    }
+
+    for (long i = 0; i < size; ++i) {
+        receiverClasses[i] = static_cast<GCClass*>(walk(receiverClasses[i]));
+        invokables[i]      = static_cast<GCInvokable*>(walk(invokables[i]));
+    }
+}
+
+void InlineCache::InvalidateAll() {
+    currentEpoch++;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <misc/defs.h>
+#include <vmobjects/ObjectFormats.h>
+
+/*
+ * Number of (receiver class, invokable) pairs a send site remembers before it
+ * is considered megamorphic.
+ */
+#define INLINE_CACHE_SIZE 4
+
+/*
+ * Marks a bytecode index that has no inline cache assigned, either because it
+ * is not a send or because the method has more send sites than can be indexed.
+ */
+#define NO_INLINE_CACHE 0xFF
+
+/*
+ * Inline cache for a single send site. The caches of a method are stored
+ * behind its bytecodes (see VMMethod) and are filled by the interpreter.
+ *
+ * A site starts out empty, becomes monomorphic with the first receiver class,
+ * polymorphic with up to INLINE_CACHE_SIZE classes, and megamorphic once a
+ * further class shows up. Megamorphic sites keep their entries but are no
+ * longer updated, misses go to VMClass::LookupInvokable directly.
+ *
+ * Whenever a class changes its methods, the global epoch is incremented and
+ * all caches filled in an earlier epoch are treated as empty.
+ */
+class InlineCache {
+public:
+    enum State {
+        EMPTY, MONOMORPHIC, POLYMORPHIC, MEGAMORPHIC
+    };
+
+    inline VMInvokable* Lookup(VMClass* receiverClass) const;
+    inline VMInvokable* GetInvokable(long idx) const;
+    inline State GetState() const;
+    inline bool  IsValid() const;
+
+           void Update(AbstractVMObject* holder, VMClass* receiverClass, VMInvokable* invokable);
+           void Clear();
+           void WalkObjects(walk_heap_fn);
+
+    static void InvalidateAll();
+
+private:
+    long epoch;
+    long size;
+    bool megamorphic;
+    GCClass*     receiverClasses[INLINE_CACHE_SIZE];
+    GCInvokable* invokables[INLINE_CACHE_SIZE];
+
+    static long currentEpoch;
+};
+
+VMInvokable* InlineCache::Lookup(VMClass* receiverClass) const {
+    if (unlikely(epoch != currentEpoch))
+        return nullptr;
+
+    for (long i = 0; i < size; ++i) {
+        if (load_ptr(receiverClasses[i]) == receiverClass)
+            return load_ptr(invokables[i]);
+    }
+    return nullptr;
+}
+
+VMInvokable* InlineCache::GetInvokable(long idx) const {
+    return load_ptr(invokables[idx]);
+}
+
+bool InlineCache::IsValid() const {
+    return epoch == currentEpoch;
+}
+
+InlineCache::State InlineCache::GetState() const {
+    if (epoch != currentEpoch || size == 0)
+        return EMPTY;
+    if (megamorphic)
+        return MEGAMORPHIC;
+    return size == 1 ? MONOMORPHIC : POLYMORPHIC;
+}
@@ -1,8 +1,10 @@
 #include "IntegerBox.h"
 #include "VMInteger.h"
+#include "VMDouble.h"
 #include "../vm/Universe.h"
 
 GCInteger* GlobalBox::integerBox = nullptr;
+GCDouble*  GlobalBox::doubleBox  = nullptr;
 
 void GlobalBox::updateIntegerBox(VMInteger* newValue) {
 # warning Is this acceptable use of _store_ptr??
@@ -13,6 +15,19 @@ VMInteger* GlobalBox::IntegerBox() {
     return load_ptr(integerBox);
 }
 
+void GlobalBox::updateDoubleBox(VMDouble* newValue) {
+    doubleBox = _store_ptr(newValue);
+}
+
+VMDouble* GlobalBox::DoubleBox() {
+    return load_ptr(doubleBox);
+}
+
 void GlobalBox::WalkGlobals(walk_heap_fn walk) {
+#if USE_TAGGING
     integerBox = static_cast<GCInteger*>(walk(integerBox));
+#endif
+#if USE_DOUBLE_TAGGING
+    doubleBox = static_cast<GCDouble*>(walk(doubleBox));
+#endif
 }
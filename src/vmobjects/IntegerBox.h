@@ -5,11 +5,14 @@
 class GlobalBox {
 public:
     static VMInteger* IntegerBox();
+    static VMDouble*  DoubleBox();
     
     static void WalkGlobals(walk_heap_fn walk);
 
 private:
     static void updateIntegerBox(VMInteger*);
+    static void updateDoubleBox(VMDouble*);
     static GCInteger* integerBox;
+    static GCDouble*  doubleBox;
     friend class Universe;
 };
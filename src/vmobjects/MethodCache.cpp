@@ -0,0 +1,191 @@
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "MethodCache.h"
+#include "VMClass.h"
+#include "VMInvokable.h"
+#include "VMSymbol.h"
+
+#include <vm/Universe.h>
+
+// markers in the index of a definition slot without a class
+#define SLOT_FREE    -1
+#define SLOT_DELETED -2
+
+MethodCache::Definition* MethodCache::definitions = nullptr;
+size_t MethodCache::numberOfDefinitions = 0;
+size_t MethodCache::numberOfUsedSlots   = 0;
+size_t MethodCache::capacity            = 0;
+
+MethodCache::Entry MethodCache::entries[METHOD_CACHE_SIZE];
+
+size_t MethodCache::hash(const VMClass* cls, VMSymbol* selector) {
+    uint64_t h = ((uint64_t) cls->hash >> 3) ^ selector->selectorHash;
+    return (h * 0x9E3779B97F4A7C15ULL) >> 32;
+}
+
+static bool inheritsFrom(const VMClass* cls, const VMClass* superClass) {
+    vm_oop_t nil = load_ptr(nilObject);
+    while (cls != nullptr && cls != nil) {
+        if (cls == superClass)
+            return true;
+        cls = cls->GetSuperClass();
+    }
+    return false;
+}
+
+VMInvokable* MethodCache::Lookup(const VMClass* cls, VMSymbol* selector) {
+    Entry& entry = entries[hash(cls, selector) & (METHOD_CACHE_SIZE - 1)];
+    if (load_ptr(entry.cls) == cls && load_ptr(entry.selector) == selector)
+        return load_ptr(entry.invokable);
+
+    const VMClass* current = cls;
+    while (true) {
+        long index = IndexOf(current, selector);
+        if (index >= 0) {
+            VMInvokable* invokable = current->GetInstanceInvokable(index);
+            entry.cls       = _store_ptr(const_cast<VMClass*>(cls));
+            entry.selector  = _store_ptr(selector);
+            entry.invokable = _store_ptr(invokable);
+            return invokable;
+        }
+        if (!current->HasSuperClass())
+            return nullptr;
+        current = current->GetSuperClass();
+    }
+}
+
+MethodCache::Definition* MethodCache::find(const VMClass* cls, VMSymbol* selector) {
+    if (numberOfDefinitions == 0)
+        return nullptr;
+
+    size_t mask = capacity - 1;
+    for (size_t i = hash(cls, selector) & mask; ; i = (i + 1) & mask) {
+        Definition* definition = &definitions[i];
+        if (definition->cls == nullptr) {
+            if (definition->index == SLOT_FREE)
+                return nullptr;
+        } else if (load_ptr(definition->cls) == cls
+                && load_ptr(definition->selector) == selector)
+            return definition;
+    }
+}
+
+long MethodCache::IndexOf(const VMClass* cls, VMSymbol* selector) {
+    Definition* definition = find(cls, selector);
+    return definition == nullptr ? -1 : definition->index;
+}
+
+void MethodCache::Define(const VMClass* cls, VMSymbol* selector, long index) {
+    Definition* definition = find(cls, selector);
+    if (definition != nullptr) {
+        definition->index = index;
+        return;
+    }
+
+    // at most half of the slots are in use, deleted ones included
+    if (2 * (numberOfUsedSlots + 1) > capacity)
+        grow();
+
+    size_t mask = capacity - 1;
+    size_t i = hash(cls, selector) & mask;
+    while (definitions[i].cls != nullptr)
+        i = (i + 1) & mask;
+
+    if (definitions[i].index == SLOT_FREE)
+        numberOfUsedSlots++;
+    definitions[i].cls      = _store_ptr(const_cast<VMClass*>(cls));
+    definitions[i].selector = _store_ptr(selector);
+    definitions[i].index    = index;
+    numberOfDefinitions++;
+}
+
+void MethodCache::Undefine(const VMClass* cls, VMSymbol* selector) {
+    Definition* definition = find(cls, selector);
+    if (definition == nullptr)
+        return;
+
+    definition->cls      = nullptr;
+    definition->selector = nullptr;
+    definition->index    = SLOT_DELETED;
+    numberOfDefinitions--;
+}
+
+void MethodCache::grow() {
+    Definition* old = definitions;
+    size_t oldCapacity = capacity;
+
+    capacity = 256;
+    while (capacity < 4 * (numberOfDefinitions + 1))
+        capacity *= 2;
+    definitions = new Definition[capacity];
+    for (size_t i = 0; i < capacity; ++i) {
+        definitions[i].cls      = nullptr;
+        definitions[i].selector = nullptr;
+        definitions[i].index    = SLOT_FREE;
+    }
+
+    numberOfDefinitions = 0;
+    numberOfUsedSlots   = 0;
+    for (size_t i = 0; i < oldCapacity; ++i) {
+        if (old[i].cls != nullptr)
+            Define(load_ptr(old[i].cls), load_ptr(old[i].selector), old[i].index);
+    }
+    delete[] old;
+}
+
+void MethodCache::Invalidate(const VMClass* cls, VMSymbol* selector) {
+    for (size_t i = 0; i < METHOD_CACHE_SIZE; ++i) {
+        Entry& entry = entries[i];
+        if (entry.cls == nullptr)
+            continue;
+        if (selector != nullptr && load_ptr(entry.selector) != selector)
+            continue;
+        if (inheritsFrom(load_ptr(entry.cls), cls))
+            memset(&entry, 0, sizeof(Entry));
+    }
+}
+
+void MethodCache::WalkObjects(walk_heap_fn walk) {
+    for (size_t i = 0; i < capacity; ++i) {
+        Definition& definition = definitions[i];
+        if (definition.cls != nullptr) {
+            definition.cls      = static_cast<GCClass*>(walk(definition.cls));
+            definition.selector = static_cast<GCSymbol*>(walk(definition.selector));
+        }
+    }
+
+    for (size_t i = 0; i < METHOD_CACHE_SIZE; ++i) {
+        Entry& entry = entries[i];
+        if (entry.cls != nullptr) {
+            entry.cls       = static_cast<GCClass*>(walk(entry.cls));
+            entry.selector  = static_cast<GCSymbol*>(walk(entry.selector));
+            entry.invokable = static_cast<GCInvokable*>(walk(entry.invokable));
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+/*
+ *
+ *
+ Copyright (c) 2007 Michael Haupt, Tobias Pape, Arne Bergmann
+ Software Architecture Group, Hasso Plattner Institute, Potsdam, Germany
+ http://www.hpi.uni-potsdam.de/swa/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#include <misc/defs.h>
+#include <vmobjects/ObjectFormats.h>
+
+/*
+ * Number of entries of the lookup cache, has to be a power of two.
+ */
+#define METHOD_CACHE_SIZE 2048
+
+/*
+ * VM-wide hash tables for method lookup, both keyed by (class, selector).
+ *
+ * The method dictionaries map a class and a selector to the index of the
+ * invokable the class itself defines in its instanceInvokables array, which
+ * stays the representation seen from SOM. All classes share one table since
+ * VMClass cannot hold one of its own: everything behind its fields are the
+ * class-side fields of the SOM class.
+ *
+ * The lookup cache maps a receiver class and a selector to the result of the
+ * full lookup through the super classes. Entries are dropped precisely, for
+ * the changed class and its subclasses, and only for the affected selector
+ * if there is a single one.
+ *
+ * Classes are hashed by their hash field and symbols by their contents, both
+ * survive moving collections, so the tables only need their entries walked.
+ */
+class MethodCache {
+public:
+    static VMInvokable* Lookup(const VMClass* cls, VMSymbol* selector);
+
+    // index of the invokable cls defines for selector, or -1
+    static long IndexOf(const VMClass* cls, VMSymbol* selector);
+
+    static void Define(const VMClass* cls, VMSymbol* selector, long index);
+    static void Undefine(const VMClass* cls, VMSymbol* selector);
+
+    // drops the cached lookups of cls and its subclasses, for all selectors
+    // if selector is nullptr
+    static void Invalidate(const VMClass* cls, VMSymbol* selector);
+
+    static void WalkObjects(walk_heap_fn);
+
+private:
+    struct Definition {
+        GCClass*  cls;
+        GCSymbol* selector;
+        long      index;
+    };
+
+    struct Entry {
+        GCClass*     cls;
+        GCSymbol*    selector;
+        GCInvokable* invokable;
+    };
+
+    static size_t hash(const VMClass* cls, VMSymbol* selector);
+    static Definition* find(const VMClass* cls, VMSymbol* selector);
+    static void grow();
+
+    static Definition* definitions;
+    static size_t numberOfDefinitions;
+    static size_t numberOfUsedSlots;
+    static size_t capacity;
+
+    static Entry entries[METHOD_CACHE_SIZE];
+};
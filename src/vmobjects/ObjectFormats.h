@@ -25,6 +25,9 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
  */
+#include <cstdint>
+#include <cstring>
+
 //some MACROS for integer tagging
 /**
  * max value for tagged integers
@@ -45,21 +48,51 @@
 #define TAG_INTEGER(X) (((X) >= VMTAGGEDINTEGER_MIN && (X) <= VMTAGGEDINTEGER_MAX) ? ((vm_oop_t)(((X) << 1) | 1)) : (GetUniverse()->NewInteger(X)))
 #endif
 
+/**
+ * Doubles are tagged with 010 in the lowest three bits. The sign is rotated
+ * into the lowest bit of the payload and only eight of the eleven exponent
+ * bits are kept, so a double is immediate if it is +/-0.0 or its exponent
+ * lies in the range given below. All other doubles, including infinities,
+ * NaNs and denormals, remain boxed as VMDouble.
+ */
+#define DOUBLE_TAG                  2
+#define TAGGED_DOUBLE_EXPONENT_MIN  896
+#define TAGGED_DOUBLE_EXPONENT_MAX  1152
+
+#define TAG_DOUBLE(X) (canTagDouble(X) ? tagDouble(X) : (vm_oop_t) GetUniverse()->NewDouble(X))
+
 #if USE_TAGGING
   #define INT_VAL(X) (IS_TAGGED(X) ? ((int64_t)(X)>>1) : (((VMInteger*)(X))->GetEmbeddedInteger()))
   #define NEW_INT(X) (TAG_INTEGER((X)))
   #define IS_TAGGED(X) ((int64_t)X&1)
-  #define CLASS_OF(X) (IS_TAGGED(X)?load_ptr(integerClass):((AbstractVMObject*)(X))->GetClass())
-  #define AS_OBJ(X) (IS_TAGGED(X)?GlobalBox::IntegerBox():((AbstractVMObject*)(X)))
 #else
   #define INT_VAL(X) (static_cast<VMInteger*>(X)->GetEmbeddedInteger())
   #define NEW_INT(X) (GetUniverse()->NewInteger(X))
   #define IS_TAGGED(X) false
+#endif
+
+#if USE_DOUBLE_TAGGING
+  #define DOUBLE_VAL(X) (IS_TAGGED_DOUBLE(X) ? untagDouble((vm_oop_t)(X)) : (((VMDouble*)(X))->GetEmbeddedDouble()))
+  #define NEW_DOUBLE(X) (TAG_DOUBLE((X)))
+  #define IS_TAGGED_DOUBLE(X) (((int64_t)(X)&3) == DOUBLE_TAG)
+#else
+  #define DOUBLE_VAL(X) (static_cast<VMDouble*>(X)->GetEmbeddedDouble())
+  #define NEW_DOUBLE(X) (GetUniverse()->NewDouble(X))
+  #define IS_TAGGED_DOUBLE(X) false
+#endif
+
+// immediate values are not heap objects, they have no fields and nothing to
+// trace for the garbage collector
+#define IS_IMMEDIATE(X) (IS_TAGGED(X) || IS_TAGGED_DOUBLE(X))
+
+#if USE_TAGGING || USE_DOUBLE_TAGGING
+  #define CLASS_OF(X) (IS_TAGGED(X)?load_ptr(integerClass):IS_TAGGED_DOUBLE(X)?load_ptr(doubleClass):((AbstractVMObject*)(X))->GetClass())
+  #define AS_OBJ(X) (IS_TAGGED(X)?(AbstractVMObject*)GlobalBox::IntegerBox():IS_TAGGED_DOUBLE(X)?(AbstractVMObject*)GlobalBox::DoubleBox():((AbstractVMObject*)(X)))
+#else
   #define CLASS_OF(X) (AS_OBJ(X)->GetClass())
   #define AS_OBJ(X) ((AbstractVMObject*)(X))
 #endif
 
-
 // Forward definitions of VM object classes
 class AbstractVMObject;
 class VMArray;
@@ -97,6 +130,33 @@ class GCOop { public: typedef VMOop Loaded; };
 typedef VMOop* vm_oop_t;
 typedef GCOop* gc_oop_t;
 
+inline bool canTagDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t exponent = (bits >> 52) & 0x7FF;
+    return (exponent > TAGGED_DOUBLE_EXPONENT_MIN && exponent < TAGGED_DOUBLE_EXPONENT_MAX)
+        || (bits << 1) == 0;
+}
+
+inline vm_oop_t tagDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t rotated = (bits << 1) | (bits >> 63);
+    if (rotated > 1)
+        rotated -= (uint64_t) TAGGED_DOUBLE_EXPONENT_MIN << 53;
+    return (vm_oop_t) ((rotated << 3) | DOUBLE_TAG);
+}
+
+inline double untagDouble(vm_oop_t oop) {
+    uint64_t rotated = (uint64_t) oop >> 3;
+    if (rotated > 1)
+        rotated += (uint64_t) TAGGED_DOUBLE_EXPONENT_MIN << 53;
+    uint64_t bits = (rotated >> 1) | (rotated << 63);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 
 
 /**
@@ -29,15 +29,53 @@
 #include "VMObject.h"
 #include "VMFrame.h"
 
+/*
+ * Direct calling convention for primitives that only depend on their
+ * receiver and arguments: they are passed by value and the result is
+ * returned, nullptr signals that the primitive failed and has to go through
+ * the frame instead.
+ */
+typedef vm_oop_t (*UnaryPrimitive)(vm_oop_t self);
+typedef vm_oop_t (*BinaryPrimitive)(vm_oop_t self, vm_oop_t arg);
+typedef vm_oop_t (*TernaryPrimitive)(vm_oop_t self, vm_oop_t arg1, vm_oop_t arg2);
+
 // abstract base class
 class PrimitiveRoutine {
 public:
-    PrimitiveRoutine() {};
+    PrimitiveRoutine() : directArity(-1) {};
 
     virtual void operator()(VMObject*, VMFrame*) = 0;  // call using operator
     virtual bool isClassSide() = 0;
+
+    // number of arguments of the direct entry, -1 if there is none
+    inline long GetDirectArity() const { return directArity; }
+
+    // calls the direct entry with the receiver and arguments on top of the
+    // given stack
+    inline vm_oop_t InvokeDirect(gc_oop_t* sp) const;
+
+protected:
+    void SetDirect(UnaryPrimitive fn)   { directArity = 0; direct.unary   = fn; }
+    void SetDirect(BinaryPrimitive fn)  { directArity = 1; direct.binary  = fn; }
+    void SetDirect(TernaryPrimitive fn) { directArity = 2; direct.ternary = fn; }
+
+private:
+    long directArity;
+    union {
+        UnaryPrimitive   unary;
+        BinaryPrimitive  binary;
+        TernaryPrimitive ternary;
+    } direct;
 };
 
+vm_oop_t PrimitiveRoutine::InvokeDirect(gc_oop_t* sp) const {
+    switch (directArity) {
+        case 0:  return direct.unary(load_ptr(sp[0]));
+        case 1:  return direct.binary(load_ptr(sp[-1]), load_ptr(sp[0]));
+        default: return direct.ternary(load_ptr(sp[-2]), load_ptr(sp[-1]), load_ptr(sp[0]));
+    }
+}
+
 // Typedefs for Primitive loading
 typedef PrimitiveRoutine* CreatePrimitive(const std::string&,
         const std::string&, bool isPrimitive);
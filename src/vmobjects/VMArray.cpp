@@ -60,7 +60,11 @@ void VMArray::SetIndexableField(long idx, vm_oop_t value) {
         << endl;
         GetUniverse()->ErrorExit("Array index out of bounds");
     }
-    SetField(GetNumberOfFields() + idx, value);
+    assert(Universe::IsValidObject(value));
+    // only the card containing the field is remembered, not the whole array
+    gc_oop_t* field = &FIELDS[GetNumberOfFields() + idx];
+    *field = _store_ptr(value);
+    array_write_barrier(this, field, value);
 }
 
 VMArray* VMArray::CopyAndExtendWith(vm_oop_t item) const {
@@ -106,6 +110,24 @@ void VMArray::WalkObjects(walk_heap_fn walk) {
     }
 }
 
+void VMArray::WalkObjectsOnCard(walk_heap_fn walk, const char* start, const char* end) {
+    // stores into the class and the other fields mark the card of the header
+    long numFields = GetNumberOfFields();
+    if ((const char*) this >= start && (const char*) this < end) {
+        clazz = static_cast<GCClass*>(walk(clazz));
+        for (long i = 0; i < numFields; i++) {
+            FIELDS[i] = walk(FIELDS[i]);
+        }
+    }
+
+    gc_oop_t* fields = FIELDS + numFields;
+    gc_oop_t* first = max(fields, (gc_oop_t*) start);
+    gc_oop_t* last  = min(fields + GetNumberOfIndexableFields(), (gc_oop_t*) end);
+    for (gc_oop_t* field = first; field < last; field++) {
+        *field = walk(*field);
+    }
+}
+
 StdString VMArray::AsDebugString() const {
     return "Array(" + to_string(GetNumberOfIndexableFields()) + ")";
 }
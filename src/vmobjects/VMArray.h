@@ -36,6 +36,9 @@ public:
     VMArray(long size, long nof = 0);
 
     virtual void WalkObjects(walk_heap_fn);
+    // walks the indexable fields stored in [start, end), and the other
+    // fields if the header is, used to scan dirty cards
+    void WalkObjectsOnCard(walk_heap_fn, const char* start, const char* end);
 
     inline  long GetNumberOfIndexableFields() const;
     VMArray* CopyAndExtendWith(vm_oop_t) const;
@@ -52,13 +55,7 @@ private:
     static const long VMArrayNumberOfFields;
 };
 
+// not cached, the parallel markers walk several arrays at the same time
 long VMArray::GetNumberOfIndexableFields() const {
-    static const VMArray* cachedArray = nullptr;
-    static long numIndexableFields = -1;
-
-    if (this != cachedArray) {
-        numIndexableFields = GetAdditionalSpaceConsumption() / sizeof(VMObject*);
-        cachedArray = this;
-    }
-    return numIndexableFields;
+    return GetAdditionalSpaceConsumption() / sizeof(VMObject*);
 }
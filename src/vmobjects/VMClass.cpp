@@ -29,6 +29,8 @@
 #include "VMSymbol.h"
 #include "VMInvokable.h"
 #include "VMPrimitive.h"
+#include "InlineCache.h"
+#include "MethodCache.h"
 #include "PrimitiveRoutine.h"
 
 #include <fstream>
@@ -106,27 +108,37 @@ bool VMClass::AddInstanceInvokable(VMInvokable* ptr) {
         return false;
     }
     //Check whether an invokable with the same signature exists and replace it if that's the case
-    VMArray* instInvokables = load_ptr(instanceInvokables);
-    long numIndexableFields = instInvokables->GetNumberOfIndexableFields();
-    for (long i = 0; i < numIndexableFields; ++i) {
-        VMInvokable* inv = static_cast<VMInvokable*>(instInvokables->GetIndexableField(i));
-        if (inv != nullptr) {
-            if (ptr->GetSignature() == inv->GetSignature()) {
-                SetInstanceInvokable(i, ptr);
-                return false;
-            }
-        } else {
-            GetUniverse()->ErrorExit("Invokables array corrupted. "
-                                     "Either NULL pointer added or pointer to non-invokable.");
-            return false;
-        }
+    long index = MethodCache::IndexOf(this, ptr->GetSignature());
+    if (index >= 0) {
+        SetInstanceInvokable(index, ptr);
+        return false;
     }
     //it's a new invokable so we need to expand the invokables array.
-    store_ptr(instanceInvokables, instInvokables->CopyAndExtendWith((vm_oop_t) ptr));
-
+    vector<VMInvokable*> invokables(1, ptr);
+    AddInstanceInvokables(invokables);
     return true;
 }
 
+void VMClass::AddInstanceInvokables(const vector<VMInvokable*>& invokables) {
+    if (invokables.empty())
+        return;
+
+    // the array is extended once for all of them
+    VMArray* instInvokables = load_ptr(instanceInvokables);
+    long numInvokables = instInvokables->GetNumberOfIndexableFields();
+    VMArray* extended = GetUniverse()->NewArray(numInvokables + invokables.size());
+    instInvokables->CopyIndexableFieldsTo(extended);
+    for (size_t i = 0; i < invokables.size(); ++i) {
+        extended->SetIndexableField(numInvokables + i, invokables[i]);
+        MethodCache::Define(this, invokables[i]->GetSignature(), numInvokables + i);
+        MethodCache::Invalidate(this, invokables[i]->GetSignature());
+    }
+    store_ptr(instanceInvokables, extended);
+
+    //the new invokables might shadow ones of a super class that are cached
+    InlineCache::InvalidateAll();
+}
+
 void VMClass::AddInstancePrimitive(VMPrimitive* ptr) {
     if (AddInstanceInvokable(ptr)) {
         //cout << "Warn: Primitive "<<ptr->GetSignature<<" is not in class definition for class " << name->GetStdString() << endl;
@@ -143,9 +155,20 @@ VMSymbol* VMClass::GetInstanceFieldName(long index) const {
 }
 
 void VMClass::SetInstanceInvokables(VMArray* invokables) {
-    store_ptr(instanceInvokables, invokables);
     vm_oop_t nil = load_ptr(nilObject);
 
+    VMArray* oldInvokables = load_ptr(instanceInvokables);
+    if (oldInvokables != nullptr) {
+        long numOldInvokables = oldInvokables->GetNumberOfIndexableFields();
+        for (long i = 0; i < numOldInvokables; ++i) {
+            vm_oop_t invo = oldInvokables->GetIndexableField(i);
+            if (invo != nil)
+                MethodCache::Undefine(this, ((VMInvokable*) invo)->GetSignature());
+        }
+    }
+
+    store_ptr(instanceInvokables, invokables);
+
     long numInvokables = GetNumberOfInstanceInvokables();
     for (long i = 0; i < numInvokables; ++i) {
         vm_oop_t invo = load_ptr(instanceInvokables)->GetIndexableField(i);
@@ -154,8 +177,12 @@ void VMClass::SetInstanceInvokables(VMArray* invokables) {
             //not Nil, so this actually is an invokable
             VMInvokable* inv = (VMInvokable*) invo;
             inv->SetHolder(this);
+            //the first definition of a selector wins, as with a linear search
+            if (MethodCache::IndexOf(this, inv->GetSignature()) < 0)
+                MethodCache::Define(this, inv->GetSignature(), i);
         }
     }
+    MethodCache::Invalidate(this, nullptr);
 }
 
 long VMClass::GetNumberOfInstanceInvokables() const {
@@ -167,35 +194,29 @@ VMInvokable* VMClass::GetInstanceInvokable(long index) const {
 }
 
 void VMClass::SetInstanceInvokable(long index, VMInvokable* invokable) {
+    vm_oop_t nil = load_ptr(nilObject);
+    vm_oop_t old = load_ptr(instanceInvokables)->GetIndexableField(index);
+    if (old != nil) {
+        VMSymbol* signature = ((VMInvokable*) old)->GetSignature();
+        if (MethodCache::IndexOf(this, signature) == index)
+            MethodCache::Undefine(this, signature);
+        MethodCache::Invalidate(this, signature);
+    }
+
     load_ptr(instanceInvokables)->SetIndexableField(index, invokable);
-    if (invokable != reinterpret_cast<VMInvokable*>(load_ptr(nilObject))) {
+    if (invokable != reinterpret_cast<VMInvokable*>(nil)) {
         invokable->SetHolder(this);
+        if (MethodCache::IndexOf(this, invokable->GetSignature()) < 0)
+            MethodCache::Define(this, invokable->GetSignature(), index);
+        MethodCache::Invalidate(this, invokable->GetSignature());
     }
+    //send sites might still refer to the replaced invokable
+    InlineCache::InvalidateAll();
 }
 
 VMInvokable* VMClass::LookupInvokable(VMSymbol* name) const {
     assert(Universe::IsValidObject(const_cast<VMClass*>(this)));
-    
-    VMInvokable* invokable = name->GetCachedInvokable(this);
-    if (invokable != nullptr)
-        return invokable;
-
-    long numInvokables = GetNumberOfInstanceInvokables();
-    for (long i = 0; i < numInvokables; ++i) {
-        invokable = GetInstanceInvokable(i);
-        if (invokable->GetSignature() == name) {
-            name->UpdateCachedInvokable(this, invokable);
-            return invokable;
-        }
-    }
-
-    // look in super class
-    if (HasSuperClass()) {
-        return load_ptr(superClass)->LookupInvokable(name);
-    }
-    
-    // invokable not found
-    return nullptr;
+    return MethodCache::Lookup(this, name);
 }
 
 long VMClass::LookupFieldIndex(VMSymbol* name) const {
@@ -387,6 +408,9 @@ void VMClass::setPrimitives(void* dlhandle, const StdString& cname, bool classSi
 #endif
     
     VMClass* current = this;
+
+    // primitives for inherited methods, added together at the end
+    vector<VMInvokable*> inheritedPrimitives;
     
     // Try loading class-specific primitives for all super class' methods as well.
     while (current != load_ptr(nilObject)) {
@@ -412,7 +436,7 @@ void VMClass::setPrimitives(void* dlhandle, const StdString& cname, bool classSi
                     thePrimitive = static_cast<VMPrimitive*>(anInvokable);
                 } else {
                     thePrimitive = VMPrimitive::GetEmptyPrimitive(sig, classSide);
-                    AddInstancePrimitive(thePrimitive);
+                    addPrimitive(thePrimitive, inheritedPrimitives);
                 }
 
                 // set routine
@@ -430,6 +454,27 @@ void VMClass::setPrimitives(void* dlhandle, const StdString& cname, bool classSi
         }
         current = current->GetSuperClass();
     }
+    AddInstanceInvokables(inheritedPrimitives);
+}
+
+/*
+ * replaces an invokable with the primitive's signature, or remembers the
+ * primitive for being added, replacing one remembered earlier
+ */
+void VMClass::addPrimitive(VMPrimitive* primitive, vector<VMInvokable*>& pending) {
+    VMSymbol* sig = primitive->GetSignature();
+    long index = MethodCache::IndexOf(this, sig);
+    if (index >= 0) {
+        SetInstanceInvokable(index, primitive);
+        return;
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i]->GetSignature() == sig) {
+            pending[i] = primitive;
+            return;
+        }
+    }
+    pending.push_back(primitive);
 }
 
 StdString VMClass::AsDebugString() const {
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "VMObject.h"
+#include "MethodCache.h"
 
 #include <misc/defs.h>
 
@@ -40,6 +41,8 @@
 class ClassGenerationContext;
 
 class VMClass: public VMObject {
+    friend class MethodCache;
+
 public:
     typedef GCClass Stored;
     
@@ -61,6 +64,7 @@ public:
            VMInvokable* LookupInvokable(VMSymbol*) const;
            long         LookupFieldIndex(VMSymbol*) const;
            bool         AddInstanceInvokable(VMInvokable*);
+           void         AddInstanceInvokables(const vector<VMInvokable*>&);
            void         AddInstancePrimitive(VMPrimitive*);
            VMSymbol*    GetInstanceFieldName(long)const;
            long         GetNumberOfInstanceFields() const;
@@ -83,6 +87,7 @@ private:
     void* loadLib(const StdString& path) const;
     bool isResponsible(void* handle, const StdString& cl) const;
     void setPrimitives(void* handle, const StdString& cname, bool classSide);
+    void addPrimitive(VMPrimitive*, vector<VMInvokable*>&);
     long numberOfSuperInstanceFields() const;
 
     GCClass* superClass;
@@ -102,6 +107,7 @@ VMClass* VMClass::GetSuperClass() const {
 
 void VMClass::SetSuperClass(VMClass* sup) {
     store_ptr(superClass, sup);
+    MethodCache::Invalidate(this, nullptr);
 }
 
 VMSymbol* VMClass::GetName() const {
@@ -29,6 +29,8 @@
 #include "VMPrimitive.h"
 
 class VMEvaluationPrimitive: public VMPrimitive {
+    friend class Image;
+
 public:
     typedef GCEvaluationPrimitive Stored;
     
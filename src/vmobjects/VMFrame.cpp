@@ -47,6 +47,9 @@ VMFrame* VMFrame::EmergencyFrameFrom(VMFrame* from, long extraLength) {
 
     long additionalBytes = length * sizeof(VMObject*);
     VMFrame* result = new (GetHeap<HEAP_CLS>(), additionalBytes) VMFrame(length);
+    // the constructor is inlined here, and the compiler may drop the size
+    // that operator new stored before it ran
+    result->objectSize = sizeof(VMFrame) + PADDED_SIZE(additionalBytes);
 
     result->clazz = nullptr; // result->SetClass(from->GetClass());
 
@@ -95,6 +98,13 @@ VMFrame* VMFrame::Clone() const {
 
 const long VMFrame::VMFrameNumberOfFields = 0;
 
+void* VMFrame::operator new(size_t numBytes, FrameStack* stack, unsigned long additionalBytes) {
+    size_t size = numBytes + PADDED_SIZE(additionalBytes);
+    void* mem = stack->AllocateFrame(size);
+    ((VMFrame*) mem)->objectSize = size;
+    return mem;
+}
+
 VMFrame::VMFrame(long size, long nof) :
         VMObject(nof + VMFrameNumberOfFields), previousFrame(nullptr), context(
                 nullptr), method(nullptr) {
@@ -105,13 +115,12 @@ VMFrame::VMFrame(long size, long nof) :
     stack_ptr = locals;
 
     // initilize all other fields
-    // --> until end of Frame
-    gc_oop_t* end = (gc_oop_t*) SHIFTED_PTR(this, objectSize);
-    long i = 0;
-    while (arguments + i < end) {
+    // objectSize is set before the constructor runs, but the compiler is free
+    // to treat it as uninitialized here, so size is used instead. This matters
+    // for frames on the FrameStack, whose memory is not zeroed.
+    for (long i = 0; i < size; i++) {
 # warning is the direct use of gc_oop_t here safe for all GCs?
         arguments[i] = nilObject;
-        i++;
     }
 }
 
@@ -140,7 +149,8 @@ void VMFrame::WalkObjects(walk_heap_fn walk) {
     // VMFrame is not a proper SOM object any longer, we don't have a class for it.
     // clazz = (VMClass*) walk(clazz);
     
-    if (previousFrame) {
+    // frames on the frame stack are walked by the interpreter
+    if (previousFrame && !GetUniverse()->GetInterpreter()->IsStackFrame(load_ptr(previousFrame))) {
         previousFrame = static_cast<GCFrame*>(walk(previousFrame));
     }
     if (context) {
@@ -28,10 +28,14 @@
 
 #include "VMArray.h"
 
+#include <interpreter/FrameStack.h>
+
 class Universe;
 
 class VMFrame: public VMObject {
     friend class UniverseFactory;
+    friend class Interpreter;
+    friend class TemplateJIT;
 public:
     typedef GCFrame Stored;
     
@@ -73,6 +77,11 @@ public:
     long RemainingStackSize() const;
     
     virtual StdString AsDebugString() const;
+
+    using VMObject::operator new;
+
+    // frames that live on the interpreter's FrameStack instead of the heap
+    void* operator new(size_t numBytes, FrameStack* stack, unsigned long additionalBytes);
     
 private:
     GCFrame* previousFrame;
@@ -36,16 +36,30 @@
 #include <vm/Universe.h>
 
 #include <compiler/MethodGenerationContext.h>
+#include <interpreter/bytecodes.h>
 #include <vmobjects/IntegerBox.h>
 
 
 #ifdef UNSAFE_FRAME_OPTIMIZATION
-const long VMMethod::VMMethodNumberOfFields = 8;
+const long VMMethod::VMMethodNumberOfFields = 11;
 #else
-const long VMMethod::VMMethodNumberOfFields = 7;
+const long VMMethod::VMMethodNumberOfFields = 10;
 #endif
 
-VMMethod::VMMethod(long bcCount, long numberOfConstants, long nof) :
+/*
+ * Layout of the space behind the fields:
+ * constants | bytecodes | inline cache index per bytecode | padding | caches
+ * The index table and the caches are only present for methods with sends.
+ */
+size_t VMMethod::GetAdditionalSpace(long bcCount, long numberOfConstants, long numberOfInlineCaches) {
+    if (numberOfInlineCaches == 0)
+        return PADDED_SIZE(bcCount + numberOfConstants * sizeof(VMObject*));
+
+    return PADDED_SIZE(2 * bcCount + numberOfConstants * sizeof(VMObject*))
+           + numberOfInlineCaches * sizeof(InlineCache);
+}
+
+VMMethod::VMMethod(long bcCount, long numberOfConstants, long numberOfInlineCaches, long nof) :
         VMInvokable(nof + VMMethodNumberOfFields) {
 #ifdef UNSAFE_FRAME_OPTIMIZATION
     cachedFrame = nullptr;
@@ -57,12 +71,38 @@ VMMethod::VMMethod(long bcCount, long numberOfConstants, long nof) :
     maximumNumberOfStackElements = _store_ptr(NEW_INT(0));
     numberOfArguments            = _store_ptr(NEW_INT(0));
     this->numberOfConstants      = _store_ptr(NEW_INT(numberOfConstants));
-
-    indexableFields = (gc_oop_t*)(&indexableFields + 2);
+    this->numberOfInlineCaches   = numberOfInlineCaches;
+    trivialKind                  = NOT_TRIVIAL;
+    trivialIndex                 = 0;
+    threadedCode                 = nullptr;
+    threadedTargets              = nullptr;
+    compiledCode                 = nullptr;
+    hotness                      = 0;
+
+    setLayoutPointers();
     for (long i = 0; i < numberOfConstants; ++i) {
         indexableFields[i] = nilObject;
     }
+    if (numberOfInlineCaches > 0) {
+        memset(inlineCacheIndices, NO_INLINE_CACHE, bcCount);
+        for (long i = 0; i < numberOfInlineCaches; ++i)
+            inlineCaches[i].Clear();
+    }
+}
+
+void VMMethod::setLayoutPointers() {
+    indexableFields = (gc_oop_t*)(&indexableFields + 2);
     bytecodes = (uint8_t*)(&indexableFields + 2 + GetNumberOfIndexableFields());
+
+    if (numberOfInlineCaches > 0) {
+        long bcCount = GetNumberOfBytecodes();
+        inlineCacheIndices = bytecodes + bcCount;
+        inlineCaches = (InlineCache*) SHIFTED_PTR(indexableFields,
+                PADDED_SIZE(2 * bcCount + GetNumberOfIndexableFields() * sizeof(VMObject*)));
+    } else {
+        inlineCacheIndices = nullptr;
+        inlineCaches       = nullptr;
+    }
 }
 
 VMMethod* VMMethod::Clone() const {
@@ -70,11 +110,29 @@ VMMethod* VMMethod::Clone() const {
     memcpy(SHIFTED_PTR(clone, sizeof(VMObject)), SHIFTED_PTR(this,
                     sizeof(VMObject)), GetObjectSize() -
             sizeof(VMObject));
-    clone->indexableFields = (gc_oop_t*)(&(clone->indexableFields) + 2);
-    clone->bytecodes = (uint8_t*)(&(clone->indexableFields) + 2 + GetNumberOfIndexableFields());
+    clone->setLayoutPointers();
+    // the threaded code belongs to the interpreter, which only knows about
+    // the original
+    clone->threadedCode    = nullptr;
+    clone->threadedTargets = nullptr;
     return clone;
 }
 
+void VMMethod::InitializeInlineCaches() {
+    long bcCount = GetNumberOfBytecodes();
+    long site = 0;
+    for (long i = 0; i < bcCount && site < numberOfInlineCaches;
+         i += Bytecode::GetBytecodeLength(bytecodes[i])) {
+        if (bytecodes[i] == BC_SEND)
+            inlineCacheIndices[i] = site++;
+    }
+}
+
+void VMMethod::SetTrivial(TrivialKind kind, long index) {
+    trivialKind  = kind;
+    trivialIndex = index;
+}
+
 void VMMethod::SetSignature(VMSymbol* sig) {
     VMInvokable::SetSignature(sig);
     SetNumberOfArguments(Signature::GetNumberOfArguments(sig));
@@ -99,6 +157,9 @@ void VMMethod::WalkObjects(walk_heap_fn walk) {
 # warning not sure _store_ptr is the best way, perhaps we should access the array content directly
             indexableFields[i] = walk(_store_ptr(GetIndexableField(i)));
     }
+
+    for (long i = 0; i < numberOfInlineCaches; ++i)
+        inlineCaches[i].WalkObjects(walk);
 }
 
 #ifdef UNSAFE_FRAME_OPTIMIZATION
@@ -146,7 +207,7 @@ void VMMethod::SetHolderAll(VMClass* hld) {
     long numIndexableFields = GetNumberOfIndexableFields();
     for (long i = 0; i < numIndexableFields; ++i) {
         vm_oop_t o = GetIndexableField(i);
-        if (!IS_TAGGED(o)) {
+        if (!IS_IMMEDIATE(o)) {
             VMInvokable* vmi = dynamic_cast<VMInvokable*>(AS_OBJ(o));
             if (vmi != nullptr) {
                 vmi->SetHolder(hld);
@@ -30,17 +30,48 @@
 
 #include "VMInvokable.h"
 #include "VMInteger.h"
+#include "InlineCache.h"
 
 class MethodGenerationContext;
 class Interpreter;
 
+/*
+ * An entry of a method's threaded code, the interpreter's form of the
+ * bytecode at the same index: the address of its handler in the dispatch
+ * loop and its decoded operands. A literal, field or local index, or the
+ * target of a jump, and the context level for locals and arguments.
+ */
+struct ThreadedOp {
+    void*   handler;
+    int32_t operand;
+    int32_t contextLevel;
+};
+
 class VMMethod: public VMInvokable {
     friend class Interpreter;
+    friend class Image;
+    friend class BytecodeCache;
+    friend class TemplateJIT;
 
 public:
     typedef GCMethod Stored;
+
+    /*
+     * Methods that only return self, a field, a literal or an argument, or
+     * only set a field, are classified by the compiler and executed by the
+     * interpreter on the sender's stack, without activating a frame. The
+     * trivial index is the field, literal, or argument index respectively.
+     */
+    enum TrivialKind {
+        NOT_TRIVIAL, TRIVIAL_GETTER, TRIVIAL_SETTER, TRIVIAL_RETURN_SELF,
+        TRIVIAL_RETURN_LITERAL, TRIVIAL_RETURN_ARGUMENT
+    };
     
-    VMMethod(long bcCount, long numberOfConstants, long nof = 0);
+    VMMethod(long bcCount, long numberOfConstants, long numberOfInlineCaches = 0, long nof = 0);
+
+    // number of bytes needed behind the object for constants, bytecodes
+    // and inline caches
+    static size_t GetAdditionalSpace(long bcCount, long numberOfConstants, long numberOfInlineCaches);
 
     inline  long      GetNumberOfLocals() const;
             void      SetNumberOfLocals(long nol);
@@ -53,6 +84,12 @@ public:
             vm_oop_t GetConstant(long indx) const;
     inline  uint8_t   GetBytecode(long indx) const;
     inline  void      SetBytecode(long indx, uint8_t);
+            void      InitializeInlineCaches();
+    inline  long      GetNumberOfInlineCaches() const;
+    inline  InlineCache* GetInlineCache(long bytecodeIndex) const;
+    inline  TrivialKind GetTrivialKind() const;
+    inline  long      GetTrivialIndex() const;
+            void      SetTrivial(TrivialKind kind, long index);
 #ifdef UNSAFE_FRAME_OPTIMIZATION
     void SetCachedFrame(VMFrame* frame);
     VMFrame* GetCachedFrame() const;
@@ -74,6 +111,7 @@ public:
 private:
     inline uint8_t* GetBytecodes() const;
     inline vm_oop_t GetIndexableField(long idx) const;
+    void setLayoutPointers();
 
     gc_oop_t numberOfLocals;
     gc_oop_t maximumNumberOfStackElements;
@@ -83,6 +121,19 @@ private:
 #ifdef UNSAFE_FRAME_OPTIMIZATION
     GCFrame* cachedFrame;
 #endif
+    long         numberOfInlineCaches;
+    uint8_t      trivialKind;
+    uint8_t      trivialIndex;
+    // built by the interpreter on first execution, for the handlers of the
+    // dispatch loop it was built with
+    ThreadedOp*  threadedCode;
+    void* const* threadedTargets;
+    // machine code from the TemplateJIT, once invocations and back edges
+    // counted in hotness made the method hot
+    void*        compiledCode;
+    uint32_t     hotness;
+    uint8_t*     inlineCacheIndices;
+    InlineCache* inlineCaches;
     gc_oop_t* indexableFields;
     uint8_t* bytecodes;
     static const long VMMethodNumberOfFields;
@@ -121,3 +172,22 @@ uint8_t VMMethod::GetBytecode(long indx) const {
 void VMMethod::SetBytecode(long indx, uint8_t val) {
     bytecodes[indx] = val;
 }
+
+long VMMethod::GetNumberOfInlineCaches() const {
+    return numberOfInlineCaches;
+}
+
+InlineCache* VMMethod::GetInlineCache(long bytecodeIndex) const {
+    if (numberOfInlineCaches == 0)
+        return nullptr;
+    uint8_t idx = inlineCacheIndices[bytecodeIndex];
+    return idx == NO_INLINE_CACHE ? nullptr : &inlineCaches[idx];
+}
+
+VMMethod::TrivialKind VMMethod::GetTrivialKind() const {
+    return (TrivialKind) trivialKind;
+}
+
+long VMMethod::GetTrivialIndex() const {
+    return trivialIndex;
+}
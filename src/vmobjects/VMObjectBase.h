@@ -3,7 +3,13 @@
 #define MASK_OBJECT_IS_MARKED (1 << 0)
 #define MASK_OBJECT_IS_OLD (1 << 1)
 #define MASK_SEEN_BY_WRITE_BARRIER (1 << 2)
-#define MASK_BITS_ALL (MASK_OBJECT_IS_MARKED | MASK_OBJECT_IS_OLD | MASK_SEEN_BY_WRITE_BARRIER)
+
+// number of minor collections a young object has survived in survivor space
+#define OBJECT_AGE_SHIFT 3
+#define MAX_OBJECT_AGE 15
+#define MASK_OBJECT_AGE (MAX_OBJECT_AGE << OBJECT_AGE_SHIFT)
+
+#define MASK_BITS_ALL (MASK_OBJECT_IS_MARKED | MASK_OBJECT_IS_OLD | MASK_SEEN_BY_WRITE_BARRIER | MASK_OBJECT_AGE)
 
 #include <assert.h>
 
@@ -24,8 +30,6 @@ void VMObjectBase::SetGCField(size_t val) {
     // forwarding address needs to be maintained incase any object still points
     // to the garbage object.
     #define GCFIELD_IS_NOT_FORWARDING_POINTER (gcfield <= MASK_BITS_ALL)
-#if GC_TYPE != MARK_SWEEP
     assert(GCFIELD_IS_NOT_FORWARDING_POINTER || val > MASK_BITS_ALL);
-#endif
     gcfield = val;
 }
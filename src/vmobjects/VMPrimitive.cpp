@@ -35,6 +35,9 @@
 
 VMPrimitive* VMPrimitive::GetEmptyPrimitive(VMSymbol* sig, bool classSide) {
     VMPrimitive* prim = new (GetHeap<HEAP_CLS>()) VMPrimitive(sig);
+    // the size written by operator new does not reliably survive the
+    // constructor (see VMFrame), restore it like NewFrame does
+    prim->objectSize = sizeof(VMPrimitive);
     prim->empty = true;
     prim->SetRoutine(new Routine<VMPrimitive>(prim, &VMPrimitive::EmptyRoutine, classSide));
     return prim;
@@ -31,6 +31,8 @@
 #include "PrimitiveRoutine.h"
 
 class VMPrimitive: public VMInvokable {
+    friend class Image;
+
 public:
     typedef GCPrimitive Stored;
     
@@ -40,6 +42,7 @@ public:
 
     inline  bool IsEmpty() const;
     inline  void SetRoutine(PrimitiveRoutine* rtn);
+    inline  PrimitiveRoutine* GetRoutine() const;
     virtual void WalkObjects(walk_heap_fn);
             void SetEmpty(bool value) {empty = value;};
     virtual VMPrimitive* Clone() const;
@@ -69,3 +72,7 @@ bool VMPrimitive::IsEmpty() const {
 void VMPrimitive::SetRoutine(PrimitiveRoutine* rtn) {
     routine = rtn;
 }
+
+PrimitiveRoutine* VMPrimitive::GetRoutine() const {
+    return routine;
+}
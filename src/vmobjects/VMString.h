@@ -29,6 +29,8 @@
 #include "AbstractObject.h"
 
 class VMString: public AbstractVMObject {
+    friend class Image;
+
 public:
     typedef GCString Stored;
     
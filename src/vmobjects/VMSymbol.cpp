@@ -33,22 +33,31 @@
 
 extern GCClass* symbolClass;
 
+// FNV-1a
+size_t VMSymbol::HashChars(const char* str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (; *str != '\0'; ++str) {
+        hash ^= (uint8_t) *str;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 VMSymbol::VMSymbol(const char* str) :
-  numberOfArgumentsOfSignature(Signature::DetermineNumberOfArguments(str)) {
-    nextCachePos = 0;
+  numberOfArgumentsOfSignature(Signature::DetermineNumberOfArguments(str)),
+  globalCell(nullptr), selectorHash(HashChars(str)) {
     // set the chars-pointer to point at the position of the first character
-    chars = (char*) &cachedInvokable + +3 * sizeof(VMInvokable*);
+    chars = (char*) &selectorHash + sizeof(size_t);
     size_t i = 0;
     for (; i < strlen(str); ++i) {
         chars[i] = str[i];
     }
     chars[i] = '\0';
-    //clear caching fields
-    memset(&cachedClass_invokable, 0, 6 * sizeof(void*) + 1 * sizeof(long));
 }
 
 VMSymbol::VMSymbol(const StdString& s) :
-  numberOfArgumentsOfSignature(Signature::DetermineNumberOfArguments(s.c_str())) {
+  numberOfArgumentsOfSignature(Signature::DetermineNumberOfArguments(s.c_str())),
+  globalCell(nullptr), selectorHash(HashChars(s.c_str())) {
     VMSymbol(s.c_str());
 }
 
@@ -59,6 +68,7 @@ size_t VMSymbol::GetObjectSize() const {
 
 VMSymbol* VMSymbol::Clone() const {
     VMSymbol* result = new (GetHeap<HEAP_CLS>(), PADDED_SIZE(strlen(chars) + 1) ALLOC_MATURE) VMSymbol(chars);
+    result->globalCell = globalCell;
     return result;
 }
 
@@ -130,14 +140,6 @@ StdString VMSymbol::GetPlainString() const {
     return st;
 }
 
-void VMSymbol::WalkObjects(walk_heap_fn walk) {
-    for (long i = 0; i < nextCachePos; i++) {
-        cachedClass_invokable[i] = static_cast<GCClass*>(walk(
-                                        const_cast<GCClass*>(cachedClass_invokable[i])));
-        cachedInvokable[i] = static_cast<GCInvokable*>(walk(cachedInvokable[i]));
-    }
-}
-
 StdString VMSymbol::AsDebugString() const {
     return "Symbol(" + GetStdString() + ")";
 }
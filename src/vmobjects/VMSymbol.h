@@ -31,6 +31,16 @@
 #include "VMString.h"
 #include "VMObject.h"
 
+/*
+ * Binding of a global. Each global has a single cell that is reachable from
+ * its interned name, so a PUSH_GLOBAL finds it without a lookup and sees when
+ * the global is rebound. The cells are owned and walked by the Universe.
+ */
+struct GlobalCell {
+    GCSymbol* name;
+    gc_oop_t  value;
+};
+
 class VMSymbol: public VMString {
 
 public:
@@ -44,38 +54,25 @@ public:
     virtual VMClass* GetClass() const;
     
     virtual StdString AsDebugString() const;
+
+    inline  GlobalCell* GetGlobalCell() const;
+
+    // hash of a symbol's characters, stays the same when the symbol moves
+    static size_t HashChars(const char* str);
     
 private:
     const int numberOfArgumentsOfSignature;
-    const GCClass* cachedClass_invokable[3];
-    long nextCachePos;
-    GCInvokable* cachedInvokable[3];
-    inline VMInvokable* GetCachedInvokable(const VMClass*) const;
-    inline void UpdateCachedInvokable(const VMClass* cls, VMInvokable* invo);
-    
-    virtual void WalkObjects(walk_heap_fn);
+    GlobalCell* globalCell;
+    // hash of the characters, unlike the address it survives moving
+    const size_t selectorHash;
     
     friend class Signature;
-    friend class VMClass;
+    friend class MethodCache;
+    friend class SymbolTable;
+    friend class Universe;
+    friend class Image;
 };
 
-
-#include "VMClass.h"
-#include "VMInvokable.h"
-
-
-VMInvokable* VMSymbol::GetCachedInvokable(const VMClass* cls) const {
-    if (cls == load_ptr(cachedClass_invokable[0]))
-        return load_ptr(cachedInvokable[0]);
-    else if (cls == load_ptr(cachedClass_invokable[1]))
-        return load_ptr(cachedInvokable[1]);
-    else if (cls == load_ptr(cachedClass_invokable[2]))
-        return load_ptr(cachedInvokable[2]);
-    return nullptr;
-}
-
-void VMSymbol::UpdateCachedInvokable(const VMClass* cls, VMInvokable* invo) {
-    store_ptr(cachedInvokable[nextCachePos], invo);
-    store_ptr(cachedClass_invokable[nextCachePos], const_cast<VMClass*>(cls));
-    nextCachePos = (nextCachePos + 1) % 3;
+GlobalCell* VMSymbol::GetGlobalCell() const {
+    return globalCell;
 }